@@ -0,0 +1,45 @@
+import os
+import subprocess
+import sys
+
+# run every demo in headless mode with "--max-allocations 0", the demo fails if a frame after warmup allocates
+# usage: py CheckAllocations.py [Configuration] [Platform], the default is Release x64
+# the demos need a display adapter, but they do not need a window
+
+demos = ["TriangleDemo", "FlowersDemo", "EffectPassDemo", "ParticlesDemo"]
+
+configuration = sys.argv[1] if len(sys.argv) > 1 else "Release"
+platform = sys.argv[2] if len(sys.argv) > 2 else "x64"
+
+frames = "600"
+warmup = "60"
+
+demosDir = os.path.dirname(os.path.abspath(__file__))
+
+failedDemos = []
+
+for demo in demos:
+    binDir = os.path.join(demosDir, demo, "Bin", platform, configuration)
+    executable = os.path.join(binDir, demo + (".exe" if os.name == "nt" else ""))
+
+    if not os.path.isfile(executable):
+        print("[fail] " + demo + ": " + executable + " is not built")
+        failedDemos.append(demo)
+        continue
+
+    # the demos load the shaders from the output directory
+    result = subprocess.run(
+        [executable, "--headless", "--frames", frames, "--max-allocations", "0", "--warmup", warmup],
+        cwd = binDir, stdout = subprocess.PIPE, stderr = subprocess.STDOUT, universal_newlines = True)
+
+    if result.returncode == 0:
+        print("[pass] " + demo)
+    else:
+        print("[fail] " + demo + ":")
+        print(result.stdout)
+        failedDemos.append(demo)
+pass
+
+print(str(len(demos) - len(failedDemos)) + " passed, " + str(len(failedDemos)) + " failed")
+
+sys.exit(0 if len(failedDemos) == 0 else 1)
@@ -1,7 +1,19 @@
 #include "DemoApp.hpp"
 
+#ifdef _WIN32
 #include "ImGui/imgui_impl_win32.h"
+#endif
 
+#include "Profiling/AllocationCounter.hpp"
+#include "Profiling/BenchmarkReport.hpp"
+#include "Profiling/Profiler.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+#ifdef _WIN32
 extern LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 LRESULT DefaultWindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
@@ -20,10 +32,96 @@ LRESULT DefaultWindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
 	return DefWindowProc(hWnd, message, wParam, lParam);
 }
+#endif
+
+auto Demo::HeadlessInfo::fromCommandLine(int argc, char** argv) -> std::optional<HeadlessInfo>
+{
+	std::optional<HeadlessInfo> info;
+
+	for (auto index = 1; index < argc; index++) {
+		if (std::strcmp(argv[index], "--headless") == 0 ||
+			std::strcmp(argv[index], "--benchmark") == 0) info = info.value_or(HeadlessInfo());
+	}
+
+	if (!info.has_value()) return info;
+
+	for (auto index = 1; index + 1 < argc; index++) {
+		if (std::strcmp(argv[index], "--frames") == 0)
+			info->Frames = static_cast<size_t>(std::stoull(argv[index + 1]));
+
+		if (std::strcmp(argv[index], "--timestep") == 0)
+			info->TimeStep = std::stof(argv[index + 1]);
+
+		if (std::strcmp(argv[index], "--trace") == 0)
+			info->TraceFileName = argv[index + 1];
+
+		if (std::strcmp(argv[index], "--benchmark") == 0)
+			info->BenchmarkFileName = argv[index + 1];
+
+		if (std::strcmp(argv[index], "--baseline") == 0)
+			info->BaselineFileName = argv[index + 1];
+
+		if (std::strcmp(argv[index], "--tolerance") == 0)
+			info->Tolerance = std::stod(argv[index + 1]);
+
+		if (std::strcmp(argv[index], "--max-allocations") == 0)
+			info->MaxAllocations = static_cast<size_t>(std::stoull(argv[index + 1]));
+
+		if (std::strcmp(argv[index], "--warmup") == 0)
+			info->WarmupFrames = static_cast<size_t>(std::stoull(argv[index + 1]));
+	}
+
+	return info;
+}
+
+auto Demo::FrameStats::from(const std::vector<float>& times) -> FrameStats
+{
+	FrameStats stats;
+
+	if (times.empty()) return stats;
+
+	auto sorted = times;
+
+	std::sort(sorted.begin(), sorted.end());
+
+	//the nearest rank percentile
+	const auto percentile = [&](const double rank)
+	{
+		const auto index = static_cast<size_t>(rank * static_cast<double>(sorted.size() - 1) + 0.5);
+
+		return static_cast<double>(sorted[index]);
+	};
+
+	stats.Frames = sorted.size();
+
+	for (const auto time : sorted) stats.Total = stats.Total + time;
+
+	stats.Average = stats.Total / static_cast<double>(stats.Frames);
+	stats.Min = sorted.front();
+	stats.Max = sorted.back();
+	stats.P50 = percentile(0.50);
+	stats.P95 = percentile(0.95);
+	stats.P99 = percentile(0.99);
+
+	return stats;
+}
 
 Demo::DemoApp::DemoApp(const std::string& name, size_t width, size_t height)
-	: mName(name), mWidth(width), mHeight(height), mHwnd(nullptr), mExisted(false)
+	: mName(name), mWidth(width), mHeight(height), mHwnd(nullptr), mExisted(false),
+	mHeadless(headlessSetting())
 {
+	ImGui::CreateContext();
+
+	//without window, we set the size of display ourselves
+	if (isHeadless()) {
+		ImGui::GetIO().DisplaySize = ImVec2(static_cast<float>(mWidth), static_cast<float>(mHeight));
+
+		mExisted = true;
+
+		return;
+	}
+
+#ifdef _WIN32
 	const auto hInstance = GetModuleHandle(nullptr);
 	const auto class_name = this->name();
 
@@ -57,34 +155,82 @@ Demo::DemoApp::DemoApp(const std::string& name, size_t width, size_t height)
 
 	mExisted = true;
 
-	ImGui::CreateContext();
 	ImGui_ImplWin32_Init(mHwnd);
+#else
+	throw CodeRed::Exception(CodeRed::DebugReport::makeError("the window is only supported on windows, please run with --headless."));
+#endif
 }
 
 Demo::DemoApp::~DemoApp()
 {
-	ImGui_ImplWin32_Shutdown();
+	//the cache is written at shutdown, so the next run of the demo can load it
+	if (mPipelineCacheFile != nullptr && !mPipelineCacheFile->save())
+		std::cout << "save pipeline cache \"" << mPipelineCacheFile->fileName() << "\" failed." << std::endl;
+
+#ifdef _WIN32
+	if (!isHeadless()) ImGui_ImplWin32_Shutdown();
+#endif
+
 	ImGui::DestroyContext();
 }
 
+void Demo::DemoApp::loadPipelineCache(
+	const std::shared_ptr<CodeRed::GpuDisplayAdapter>& adapter,
+	const std::shared_ptr<CodeRed::GpuLogicalDevice>& device)
+{
+	mPipelineCacheFile = std::make_shared<CodeRed::PipelineCacheFile>(
+		"./" + mName + ".PipelineCache",
+		CodeRed::PipelineCacheIdentity::from(adapter, device->apiVersion()),
+		std::make_shared<CodeRed::DevicePipelineCacheBackend>(device));
+
+	//a missing or out of date file is not an error, the pipelines are created without it
+	mPipelineCacheFile->load();
+}
+
 void Demo::DemoApp::show() const
 {
-	ShowWindow(mHwnd, SW_SHOW);
+#ifdef _WIN32
+	if (!isHeadless()) ShowWindow(static_cast<HWND>(mHwnd), SW_SHOW);
+#endif
 }
 
 void Demo::DemoApp::hide() const
 {
-	ShowWindow(mHwnd, SW_HIDE);
+#ifdef _WIN32
+	if (!isHeadless()) ShowWindow(static_cast<HWND>(mHwnd), SW_HIDE);
+#endif
 }
 
 void Demo::DemoApp::runLoop()
 {
+	startPipeline();
+
+	try {
+		if (isHeadless()) runHeadlessLoop(); else runWindowLoop();
+	}
+	catch (...) {
+		stopPipeline();
+
+		throw;
+	}
+
+	stopPipeline();
+}
+
+void Demo::DemoApp::setHeadless(const std::optional<HeadlessInfo>& headless)
+{
+	headlessSetting() = headless;
+}
+
+void Demo::DemoApp::runWindowLoop()
+{
+#ifdef _WIN32
 	auto currentTime = Time::now();
 	
 	while (mExisted == true) {
 		MSG message;
 
-		message.hwnd = mHwnd;
+		message.hwnd = static_cast<HWND>(mHwnd);
 
 		while (PeekMessage(&message, 0, 0, 0, PM_REMOVE)) {
 			TranslateMessage(&message);
@@ -103,13 +249,320 @@ void Demo::DemoApp::runLoop()
 		currentTime = Time::now();
 
 		ImGui_ImplWin32_NewFrame();
-		
-		update(duration.count());
-		render(duration.count());
+
+		runFrame(duration.count());
+	}
+#endif
+}
+
+void Demo::DemoApp::runHeadlessLoop()
+{
+	const auto& headless = mHeadless.value();
+
+	mFrameRecords.clear();
+	mFrameRecords.reserve(headless.Frames);
+
+	//the demo is updated with the fixed time step, we only measure the time we spent
+	for (size_t frame = 0; frame < headless.Frames && mExisted; frame++) {
+		ImGui::GetIO().DeltaTime = headless.TimeStep;
+
+		mFrameRecords.push_back(runFrame(headless.TimeStep));
+	}
+
+	std::vector<float> frameTimes(mFrameRecords.size());
+
+	for (size_t index = 0; index < mFrameRecords.size(); index++) frameTimes[index] = mFrameRecords[index].Frame;
+
+	const auto stats = FrameStats::from(frameTimes);
+
+	std::cout << mName << " headless " << stats.Frames << " frames" << std::endl;
+	std::cout << "frame time(ms): average " << stats.Average
+		<< ", min " << stats.Min
+		<< ", p50 " << stats.P50
+		<< ", p95 " << stats.P95
+		<< ", p99 " << stats.P99
+		<< ", max " << stats.Max << std::endl;
+
+	reportBenchmark();
+
+	checkAllocations();
+
+#ifdef __PROFILING__MODE__
+	if (!headless.TraceFileName.empty()) CodeRed::Profiler::exportChromeTrace(headless.TraceFileName);
+#endif
+}
+
+auto Demo::DemoApp::runFrame(const float delta) -> FrameRecord
+{
+	using Milliseconds = std::chrono::duration<float, std::milli>;
+
+	FrameRecord record;
+
+	const auto beginAllocations = CodeRed::AllocationCounter::allocations();
+	const auto beginTime = Time::now();
+
+	{
+		CODE_RED_PROFILE_ALLOCATION_ZONE("DemoApp::runLoop");
+
+		if (mPipelined) {
+			CODE_RED_PROFILE_ZONE("DemoApp::wait");
+
+			//wait for the simulation thread to publish the state of this frame
+			mFrameSlot = mHandoff->acquireRead();
+
+			if (mFrameSlot == CodeRed::FrameHandoff::invalidSlot) std::rethrow_exception(mSimulationException);
+
+			record.Simulate = mSlotSimulateTimes[mFrameSlot];
+		}
+		else {
+			CODE_RED_PROFILE_ALLOCATION_ZONE("DemoApp::simulate");
+
+			runSimulation(delta);
+
+			mFrameSlot = 0;
+
+			publish(mFrameSlot);
+
+			record.Simulate = std::chrono::duration_cast<Milliseconds>(Time::now() - beginTime).count();
+		}
+
+		const auto waitTime = Time::now();
+
+		{
+			CODE_RED_PROFILE_ZONE("DemoApp::waitFrame");
+
+			waitFrame();
+		}
+
+		const auto updateTime = Time::now();
+
+		{
+			CODE_RED_PROFILE_ALLOCATION_ZONE("DemoApp::update");
+
+			update(delta);
+		}
+
+		const auto renderTime = Time::now();
+
+		{
+			CODE_RED_PROFILE_ALLOCATION_ZONE("DemoApp::render");
+
+			render(delta);
+		}
+
+		const auto endTime = Time::now();
+
+		record.Wait = std::chrono::duration_cast<Milliseconds>(updateTime - waitTime).count();
+		record.Update = std::chrono::duration_cast<Milliseconds>(renderTime - updateTime).count();
+		record.Render = std::chrono::duration_cast<Milliseconds>(endTime - renderTime).count();
+
+		//the slot can be written again after we record and submit the frame
+		//the gpu does not read it, update copies it to the frame resources
+		if (mPipelined) mHandoff->releaseRead(mFrameSlot);
+	}
+
+#ifdef __PROFILING__MODE__
+	//move the zones of this frame to profiler, the profiler view shows them in next frame
+	CodeRed::Profiler::collect();
+#endif
+
+	//the frame time and allocations include the profiler, because it runs in every frame
+	//in pipelined mode, the allocations of simulation thread are counted in the frame they happen
+	record.Frame = std::chrono::duration_cast<Milliseconds>(Time::now() - beginTime).count();
+	record.Allocations = CodeRed::AllocationCounter::allocations() - beginAllocations;
+
+	return record;
+}
+
+void Demo::DemoApp::runSimulation(const float delta)
+{
+	if (!mFixedStep.has_value()) {
+		simulate(delta);
+
+		mInterpolationFactor = 1.0f;
+
+		return;
+	}
+
+	const auto step = static_cast<double>(mFixedStep->TimeStep);
+
+	mAccumulator = mAccumulator + delta;
+
+	size_t substeps = 0;
+
+	while (mAccumulator >= step && substeps < mFixedStep->MaxSubsteps) {
+		simulate(mFixedStep->TimeStep);
+
+		mAccumulator = mAccumulator - step;
+		substeps++;
 	}
+
+	//we can not catch up, so we drop the time we can not simulate
+	//the remaining time is kept, so the interpolation factor is still right
+	if (mAccumulator >= step) {
+		const auto remaining = std::fmod(mAccumulator, step);
+
+		mDroppedTime = mDroppedTime + (mAccumulator - remaining);
+		mAccumulator = remaining;
+	}
+
+	mInterpolationFactor = static_cast<float>(mAccumulator / step);
+}
+
+void Demo::DemoApp::setFixedStep(const std::optional<FixedStepInfo>& fixedStep)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		fixedStep.has_value() && fixedStep->TimeStep <= 0.0f,
+		CodeRed::InvalidException<float>({ "fixedStep.TimeStep" })
+	);
+
+	CODE_RED_DEBUG_THROW_IF(
+		fixedStep.has_value() && fixedStep->MaxSubsteps == 0,
+		CodeRed::InvalidException<size_t>({ "fixedStep.MaxSubsteps" })
+	);
+
+	mFixedStep = fixedStep;
+	mAccumulator = 0;
+	mInterpolationFactor = fixedStep.has_value() ? 0.0f : 1.0f;
+}
+
+void Demo::DemoApp::setPipelined(const bool pipelined)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		mSimulationThread.joinable(),
+		CodeRed::Exception(CodeRed::DebugReport::makeError("we can not change the pipelined mode when the demo is running."))
+	);
+
+	mPipelined = pipelined;
+}
+
+void Demo::DemoApp::simulationLoop()
+{
+	auto currentTime = Time::now();
+
+	try {
+		while (true) {
+			const auto slot = mHandoff->acquireWrite();
+
+			if (slot == CodeRed::FrameHandoff::invalidSlot) break;
+
+			//the simulation thread measures its own time, because it runs one frame ahead of the render
+			//in headless mode, every frame uses the same time step
+			auto delta = std::chrono::duration_cast<
+				std::chrono::duration<float>>(Time::now() - currentTime).count();
+
+			currentTime = Time::now();
+
+			if (isHeadless()) delta = mHeadless->TimeStep;
+
+			const auto beginTime = Time::now();
+
+			{
+				CODE_RED_PROFILE_ALLOCATION_ZONE("DemoApp::simulate");
+
+				runSimulation(delta);
+
+				publish(slot);
+			}
+
+			mSlotSimulateTimes[slot] = std::chrono::duration_cast<
+				std::chrono::duration<float, std::milli>>(Time::now() - beginTime).count();
+
+			mHandoff->submitWrite(slot);
+		}
+	}
+	catch (...) {
+		mSimulationException = std::current_exception();
+
+		mHandoff->stop();
+	}
+}
+
+void Demo::DemoApp::startPipeline()
+{
+	if (mPipelined == false) return;
+
+	if (mHandoff == nullptr) mHandoff = std::make_unique<CodeRed::FrameHandoff>(maxFrameSlots);
+
+	mHandoff->reset();
+	mSimulationException = nullptr;
+	mSimulationThread = std::thread([this]() { simulationLoop(); });
+}
+
+void Demo::DemoApp::stopPipeline()
+{
+	if (mSimulationThread.joinable() == false) return;
+
+	mHandoff->stop();
+	mSimulationThread.join();
+}
+
+void Demo::DemoApp::reportBenchmark()
+{
+	const auto& headless = mHeadless.value();
+
+	if (headless.BenchmarkFileName.empty() && headless.BaselineFileName.empty()) return;
+
+	const auto report = BenchmarkReport::from(mName, mFrameRecords);
+
+	if (!headless.BenchmarkFileName.empty()) report.write(headless.BenchmarkFileName);
+
+	std::cout << "allocations per frame: average " << report.value("allocations.mean").value()
+		<< ", max " << report.value("allocations.max").value() << std::endl;
+
+	if (headless.BaselineFileName.empty()) return;
+
+	const auto regressions = report.compare(BenchmarkReport::read(headless.BaselineFileName), headless.Tolerance);
+
+	for (const auto& regression : regressions) {
+		std::cout << "regression " << regression.Name << ": baseline " << regression.Baseline
+			<< ", current " << regression.Current << std::endl;
+	}
+
+	std::cout << "benchmark " << (regressions.empty() ? "passed" : "failed") << " with tolerance "
+		<< headless.Tolerance << std::endl;
+
+	if (!regressions.empty()) mExitCode = 1;
+}
+
+void Demo::DemoApp::checkAllocations()
+{
+	const auto& headless = mHeadless.value();
+
+	if (!headless.MaxAllocations.has_value()) return;
+
+	size_t failedFrames = 0;
+	size_t maxAllocations = 0;
+
+	for (auto index = headless.WarmupFrames; index < mFrameRecords.size(); index++) {
+		const auto allocations = mFrameRecords[index].Allocations;
+
+		if (allocations > headless.MaxAllocations.value()) {
+			//only report the first frame, the others are usually the same
+			if (failedFrames == 0) std::cout << "frame " << index << " allocates " << allocations << " times" << std::endl;
+
+			failedFrames++;
+		}
+
+		maxAllocations = std::max(maxAllocations, allocations);
+	}
+
+	std::cout << "steady state allocations per frame: max " << maxAllocations << ", limit "
+		<< headless.MaxAllocations.value() << ", " << failedFrames << " frames over the limit" << std::endl;
+
+	if (failedFrames != 0) mExitCode = 1;
+}
+
+auto Demo::DemoApp::headlessSetting() -> std::optional<HeadlessInfo>&
+{
+	static std::optional<HeadlessInfo> setting;
+
+	return setting;
 }
 
+#ifdef _WIN32
 void Demo::DemoApp::processMessage(DemoApp* app, const MSG& message)
 {
 	
 }
+#endif
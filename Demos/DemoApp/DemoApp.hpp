@@ -2,15 +2,113 @@
 
 #include <CodeRed/Core/CodeRedGraphics.hpp>
 
+#include "Pipelines/PipelineCacheFile.hpp"
+#include "Threads/FrameHandoff.hpp"
+
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
+#include <exception>
+#include <optional>
 #include <string>
+#include <vector>
 #include <chrono>
+#include <memory>
+#include <thread>
 
 namespace Demo {
 
 	using Time = std::chrono::high_resolution_clock;
+
+	//the settings of headless mode, the demo runs without window and message loop
+	//every frame uses the same time step, so the result does not depend on the speed of machine
+	struct HeadlessInfo {
+		size_t Frames = 1000;
+
+		float TimeStep = 1.0f / 60.0f;
+
+		//export the chrome trace of profiler to this file when the demo exits, empty means no export
+		std::string TraceFileName;
+
+		//write the benchmark report to this file(".json" or ".csv"), empty means no report
+		std::string BenchmarkFileName;
+
+		//compare the benchmark report with this report, the demo fails if a metric regresses
+		std::string BaselineFileName;
+
+		//the relative tolerance of comparison, 0.1 means the metric can be 10% worse than baseline
+		double Tolerance = 0.1;
+
+		//the demo fails if a frame after the warmup frames allocates more than it, nullopt means no limit
+		//the warmup frames create the pipelines, caches and scratch memory, so they are not checked
+		std::optional<size_t> MaxAllocations;
+
+		size_t WarmupFrames = 10;
+
+		HeadlessInfo() = default;
+
+		HeadlessInfo(
+			const size_t frames,
+			const float timeStep) :
+			Frames(frames), TimeStep(timeStep) {}
+
+		//--headless [--frames count] [--timestep seconds] [--trace fileName]
+		//--benchmark fileName [--baseline fileName] [--tolerance value] runs in headless mode too
+		//[--max-allocations count] [--warmup frames] checks the heap allocations of steady state
+		//return nullopt if there is no "--headless" or "--benchmark"
+		static auto fromCommandLine(int argc, char** argv) -> std::optional<HeadlessInfo>;
+	};
+
+	//the settings of fixed time step, the simulation runs in steps with the same time
+	//so the result does not depend on the frame rate
+	struct FixedStepInfo {
+		float TimeStep = 1.0f / 60.0f;
+
+		//the max steps in one frame, the time over it is dropped
+		//so a slow frame does not cause more steps (and slower frames) later
+		size_t MaxSubsteps = 4;
+
+		FixedStepInfo() = default;
+
+		FixedStepInfo(
+			const float timeStep,
+			const size_t maxSubsteps) :
+			TimeStep(timeStep), MaxSubsteps(maxSubsteps) {}
+	};
+
+	//the statistics of frame times in milliseconds
+	struct FrameStats {
+		size_t Frames = 0;
+
+		double Total = 0;
+		double Average = 0;
+		double Min = 0;
+		double Max = 0;
+		double P50 = 0;
+		double P95 = 0;
+		double P99 = 0;
+
+		FrameStats() = default;
+
+		static auto from(const std::vector<float>& times) -> FrameStats;
+	};
 	
+	//the cpu time of the phases of a frame in milliseconds, and the heap allocations in the frame
+	//in pipelined mode, the time of simulate is measured on the simulation thread
+	//the wait is the time we wait for the frame slot that gpu is still using, it is not cpu work
+	struct FrameRecord {
+		float Wait = 0;
+		float Simulate = 0;
+		float Update = 0;
+		float Render = 0;
+		float Frame = 0;
+
+		size_t Allocations = 0;
+
+		FrameRecord() = default;
+	};
+
 	class DemoApp : public CodeRed::Noncopyable {
 	public:
 		explicit DemoApp(
@@ -33,19 +131,123 @@ namespace Demo {
 		auto name() const noexcept -> std::string { return mName; }
 
 		auto handle() const noexcept -> void* { return mHwnd; }
+
+		auto isHeadless() const noexcept -> bool { return mHeadless.has_value(); }
+
+		//the records of frames in headless mode
+		auto frameRecords() const noexcept -> const std::vector<FrameRecord>& { return mFrameRecords; }
+
+		//0 if the demo runs without error, 1 if the benchmark regresses against the baseline
+		auto exitCode() const noexcept -> int { return mExitCode; }
+
+		//the time between the last simulation step and the time of frame, divided by time step
+		//it is in [0, 1), the demos use it to interpolate the previous and current state when they render
+		//without fixed time step it is always 1
+		auto interpolationFactor() const noexcept -> float { return mInterpolationFactor; }
+
+		//the time dropped by the max substeps in seconds
+		auto droppedTime() const noexcept -> double { return mDroppedTime; }
+
+		auto isPipelined() const noexcept -> bool { return mPipelined; }
+
+		//the demos created after it run in headless mode, call it before we create the demo
+		static void setHeadless(const std::optional<HeadlessInfo>& headless);
+
+		//the number of frame slots, the simulation writes one slot while the render reads another
+		static constexpr size_t maxFrameSlots = 2;
 	protected:
+		//simulate runs before update, with fixed time step it runs zero or more times in a frame
+		//without fixed time step it runs once with the delta of frame
+		virtual void simulate(float step) {}
+
+		//publish copies the state that update and render need into the frame slot
+		//it runs after simulate on the same thread, the interpolation factor is valid in it
+		virtual void publish(size_t slot) {}
+
+		//waitFrame runs before update, the demos wait for the frame that used the slot they will write
+		//the time is recorded as the wait of frame, so the time of update and render is only cpu work
+		virtual void waitFrame() {}
+
 		virtual void update(float delta) {}
 		virtual void render(float delta) {}
+
+		void setFixedStep(const std::optional<FixedStepInfo>& fixedStep);
+
+		//in pipelined mode, simulate and publish run on the simulation thread
+		//update and render of frame N run on the thread of runLoop while frame N + 1 is simulated
+		//so simulate and publish should only touch the simulation state and the slot they publish
+		void setPipelined(const bool pipelined);
+
+		//the slot that update and render of current frame read
+		auto frameSlot() const noexcept -> size_t { return mFrameSlot; }
+
+		//load the pipeline cache of the adapter from "<name>.PipelineCache" into the native cache of device
+		//the cache is saved when the demo is destroyed, the file of other adapter or driver is ignored
+		void loadPipelineCache(
+			const std::shared_ptr<CodeRed::GpuDisplayAdapter>& adapter,
+			const std::shared_ptr<CodeRed::GpuLogicalDevice>& device);
+
+		auto pipelineCacheFile() const noexcept -> std::shared_ptr<CodeRed::PipelineCacheFile> { return mPipelineCacheFile; }
+	private:
+		void runWindowLoop();
+
+		void runHeadlessLoop();
+
+		auto runFrame(const float delta) -> FrameRecord;
+
+		void runSimulation(const float delta);
+
+		void reportBenchmark();
+
+		void checkAllocations();
+
+		void simulationLoop();
+
+		void startPipeline();
+
+		void stopPipeline();
 	private:
 		std::string mName;
 
 		size_t mWidth;
 		size_t mHeight;
-		HWND mHwnd;
+		void* mHwnd;
 
 		bool mExisted;
 
+		std::optional<HeadlessInfo> mHeadless;
+
+		std::vector<FrameRecord> mFrameRecords;
+
+		int mExitCode = 0;
+
+		std::optional<FixedStepInfo> mFixedStep;
+
+		//the accumulator is double, so the error of float does not grow in long runs
+		double mAccumulator = 0;
+		double mDroppedTime = 0;
+
+		float mInterpolationFactor = 1.0f;
+
+		bool mPipelined = false;
+
+		size_t mFrameSlot = 0;
+
+		//the time of simulate and publish of slots, it is handed off with the slot
+		float mSlotSimulateTimes[maxFrameSlots] = {};
+
+		std::shared_ptr<CodeRed::PipelineCacheFile> mPipelineCacheFile;
+
+		std::unique_ptr<CodeRed::FrameHandoff> mHandoff;
+		std::thread mSimulationThread;
+
+		//the exception thrown by the simulation thread, it is thrown again on the thread of runLoop
+		std::exception_ptr mSimulationException;
+
+		static auto headlessSetting() -> std::optional<HeadlessInfo>&;
+#ifdef _WIN32
 		static void processMessage(DemoApp* app, const MSG& message);
+#endif
 	};
 	
-}
\ No newline at end of file
+}
@@ -1,6 +1,63 @@
 #include "EffectPass.hpp"
 
 #include "../Resources/ResourceHelper.hpp"
+#include "../Shaders/ShaderReflection.hpp"
+
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+
+namespace CodeRed {
+
+	static std::vector<std::pair<std::string, ShaderOptimizeReport>> gShaderOptimizeReports;
+	static std::mutex gShaderOptimizeReportsMutex;
+
+	static std::atomic<size_t> gLayoutCreations = 0;
+
+	//the layouts of hlsl effect shaders, they are written by hand because we only reflect spir-v
+	static auto hlslReflection() -> ShaderReflection
+	{
+		ShaderReflection reflection;
+
+		reflection.Bindings = {
+			ShaderBinding(ShaderBindingType::Buffer, "lights", 0, 0, 0),
+			ShaderBinding(ShaderBindingType::GroupBuffer, "transforms", 1, 0, 0),
+			ShaderBinding(ShaderBindingType::GroupBuffer, "materials", 2, 0, 0),
+			ShaderBinding(ShaderBindingType::Texture, "texture3", 3, 0, 0),
+			ShaderBinding(ShaderBindingType::Texture, "texture4", 4, 0, 0),
+			ShaderBinding(ShaderBindingType::Texture, "texture5", 5, 0, 0),
+			ShaderBinding(ShaderBindingType::Texture, "texture6", 6, 0, 0),
+			ShaderBinding(ShaderBindingType::Texture, "texture7", 7, 0, 0),
+			ShaderBinding(ShaderBindingType::Sampler, "sampler", 8, 0, 0)
+		};
+
+		reflection.Inputs = {
+			ShaderInput("POSITION", PixelFormat::RedGreenBlue32BitFloat, 0),
+			ShaderInput("NORMAL", PixelFormat::RedGreenBlue32BitFloat, 1),
+			ShaderInput("TEXCOORD", PixelFormat::RedGreen32BitFloat, 2),
+			ShaderInput("TANGENT", PixelFormat::RedGreenBlue32BitFloat, 3)
+		};
+
+		//the ambient light, material type and start instance, they use the binding after the sampler(9)
+		reflection.Constant32Bits = 6;
+
+		return reflection;
+	}
+
+}
+
+//the resources shared by the effect passes of a device
+//the sampler is a part of resource layout, so sharing it lets the effect passes share the layouts too
+struct CodeRed::EffectPass::DeviceResources {
+	std::shared_ptr<GpuSampler> Sampler;
+	std::shared_ptr<ResourceLayoutCache> ResourceLayouts;
+	std::shared_ptr<PipelineStateCache> PipelineStates;
+
+	//the input assembly states keyed by their inputs
+	std::unordered_map<std::string, std::shared_ptr<GpuInputAssemblyState>> InputAssemblies;
+
+	std::mutex Mutex;
+};
 
 CodeRed::EffectPass::EffectPass(
 	const std::shared_ptr<GpuLogicalDevice>& device,
@@ -18,48 +75,35 @@ CodeRed::EffectPass::EffectPass(
 		InvalidException<GpuRenderPass>({ "render pass" })
 	);
 
-	mSampler = mDevice->createSampler(
-		SamplerInfo(16,
-			AddressMode::Repeat,
-			AddressMode::Repeat,
-			AddressMode::Repeat)
-	);
+	mDeviceResources = deviceResources(mDevice);
+
+	{
+		std::lock_guard<std::mutex> lock(mDeviceResources->Mutex);
+
+		if (mDeviceResources->Sampler == nullptr) {
+			mDeviceResources->Sampler = mDevice->createSampler(
+				SamplerInfo(16,
+					AddressMode::Repeat,
+					AddressMode::Repeat,
+					AddressMode::Repeat)
+			);
+		}
+
+		mSampler = mDeviceResources->Sampler;
+		mPipelineStates = mDeviceResources->PipelineStates;
+	}
 	
 	mPipelineInfo = std::make_shared<PipelineInfo>(mDevice);
 
-	auto pipelineFactory = mPipelineInfo->pipelineFactory();
-	
+	//the effect state may be changed back to the combination we used before
+	//so we cache the pipelines of this effect pass
+	mPipelineInfo->setPipelineCache(std::make_shared<PipelineCache>(mDevice));
+
 	mPipelineInfo->setRenderPass(renderPass);
-	mPipelineInfo->setInputAssemblyState(
-		pipelineFactory->createInputAssemblyState(
-			{
-				InputLayoutElement("POSITION", PixelFormat::RedGreenBlue32BitFloat),
-				InputLayoutElement("NORMAL", PixelFormat::RedGreenBlue32BitFloat),
-				InputLayoutElement("TEXCOORD", PixelFormat::RedGreen32BitFloat),
-				InputLayoutElement("TANGENT", PixelFormat::RedGreenBlue32BitFloat)
-			},
-			PrimitiveTopology::TriangleList
-		)
-	);
 
-	mPipelineInfo->setResourceLayout(
-		mDevice->createResourceLayout(
-			{
-				ResourceLayoutElement(ResourceType::Buffer, 0, 0),
-				ResourceLayoutElement(ResourceType::GroupBuffer, 1, 0),
-				ResourceLayoutElement(ResourceType::GroupBuffer, 2, 0),
-				ResourceLayoutElement(ResourceType::Texture, 3, 0),
-				ResourceLayoutElement(ResourceType::Texture, 4, 0),
-				ResourceLayoutElement(ResourceType::Texture, 5, 0),
-				ResourceLayoutElement(ResourceType::Texture, 6, 0),
-				ResourceLayoutElement(ResourceType::Texture, 7, 0)
-			},
-			{
-				SamplerLayoutElement(mSampler, 8, 0)
-			},
-			Constant32Bits(5, 9, 0)
-		)
-	);
+	//the vulkan effect passes reflect the layouts from their shaders(reflectLayouts)
+	//so only the hlsl effect passes use the layouts written by hand
+	if (mDevice->apiVersion() == APIVersion::DirectX12) setLayouts(hlslReflection());
 	
 	mLightsBuffer = mDevice->createBuffer(
 		ResourceInfo::ConstantBuffer(
@@ -132,19 +176,20 @@ void CodeRed::EffectPass::updateState(
 		mPipelineInfo->setRasterizationState(rasterization.value())
 	);
 
+	//the pipeline is created on a worker thread, we keep drawing with the old pipeline
+	//and swap the new pipeline in when we begin effect and it is ready
 	CODE_RED_TRY_EXECUTE(
 		blend.has_value() || depthStencil.has_value() || rasterization.has_value(),
-		mPipelineInfo->updateState()
+		mPipelineInfo->updateStateAsync()
 	);
 }
 
 void CodeRed::EffectPass::beginEffect(std::shared_ptr<GpuGraphicsCommandList>& commandList)
 {
 	mCommandList = commandList;
-	
-	mCommandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
-	mCommandList->setResourceLayout(mPipelineInfo->resourceLayout());
-	mCommandList->setDescriptorHeap(mDescriptorHeap);
+
+	prepareEffect();
+	bindEffect(mCommandList);
 }
 
 void CodeRed::EffectPass::endEffect()
@@ -164,21 +209,8 @@ void CodeRed::EffectPass::drawIndexed(
 		Exception(DebugReport::makeError("please begin effect before drawing."))
 	);
 
-	mCommandList->setConstant32Bits(
-		{
-			mAmbientLight.r,
-			mAmbientLight.g,
-			mAmbientLight.b,
-			mAmbientLight.a,
-			static_cast<UInt32>(MaterialType::Buffer)
-		});
-
-	mCommandList->drawIndexed(
-		indexCount,
-		instanceCount,
-		startIndexLocation,
-		baseVertexLocation,
-		startInstanceLocation);
+	drawIndexed(mCommandList, MaterialType::Buffer,
+		indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
 }
 
 void CodeRed::EffectPass::drawIndexedWithTextureMaterial(
@@ -193,16 +225,73 @@ void CodeRed::EffectPass::drawIndexedWithTextureMaterial(
 		Exception(DebugReport::makeError("please begin effect before drawing."))
 	);
 
-	mCommandList->setConstant32Bits(
-		{
-			mAmbientLight.r,
-			mAmbientLight.g,
-			mAmbientLight.b,
-			mAmbientLight.a,
-			static_cast<UInt32>(MaterialType::Texture)
-		});
+	drawIndexed(mCommandList, MaterialType::Texture,
+		indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+void CodeRed::EffectPass::prepareEffect()
+{
+	mPipelineInfo->updatePendingState();
+}
+
+void CodeRed::EffectPass::bindEffect(const std::shared_ptr<GpuGraphicsCommandList>& commandList) const
+{
+	commandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
+	commandList->setResourceLayout(mPipelineInfo->resourceLayout());
+	commandList->setDescriptorHeap(mDescriptorHeap);
+}
+
+void CodeRed::EffectPass::drawIndexed(
+	const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+	const size_t indexCount,
+	const size_t instanceCount,
+	const size_t startIndexLocation,
+	const size_t baseVertexLocation,
+	const size_t startInstanceLocation) const
+{
+	drawIndexed(commandList, MaterialType::Buffer,
+		indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+void CodeRed::EffectPass::drawIndexedWithTextureMaterial(
+	const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+	const size_t indexCount,
+	const size_t instanceCount,
+	const size_t startIndexLocation,
+	const size_t baseVertexLocation,
+	const size_t startInstanceLocation) const
+{
+	drawIndexed(commandList, MaterialType::Texture,
+		indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+void CodeRed::EffectPass::drawIndexed(
+	const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+	const MaterialType materialType,
+	const size_t indexCount,
+	const size_t instanceCount,
+	const size_t startIndexLocation,
+	const size_t baseVertexLocation,
+	const size_t startInstanceLocation) const
+{
+	//the draws may be recorded on more than one thread, so every thread has its own constants
+	//the vector keeps its capacity, so we do not allocate it in every draw
+	thread_local std::vector<Value32Bit> constants;
 
-	mCommandList->drawIndexed(
+	constants.clear();
+	constants.push_back(mAmbientLight.r);
+	constants.push_back(mAmbientLight.g);
+	constants.push_back(mAmbientLight.b);
+	constants.push_back(mAmbientLight.a);
+	constants.push_back(static_cast<UInt32>(materialType));
+
+	//SV_InstanceID does not include the start instance location, so the hlsl shaders add it themselves
+	if (mDevice->apiVersion() == APIVersion::DirectX12)
+		constants.push_back(static_cast<UInt32>(startInstanceLocation));
+
+	commandList->setConstant32Bits(constants);
+
+	commandList->drawIndexed(
 		indexCount,
 		instanceCount,
 		startIndexLocation,
@@ -219,3 +308,146 @@ auto CodeRed::EffectPass::light(const LightType type, const size_t index) const
 {
 	return mLights[static_cast<size_t>(type)* MAX_LIGHTS_PER_TYPE + index];
 }
+
+auto CodeRed::EffectPass::shaderOptimizeReports() -> std::vector<std::pair<std::string, ShaderOptimizeReport>>
+{
+	std::lock_guard<std::mutex> lock(gShaderOptimizeReportsMutex);
+
+	return gShaderOptimizeReports;
+}
+
+void CodeRed::EffectPass::saveShaderArchive()
+{
+	shaderArchive().flush();
+}
+
+auto CodeRed::EffectPass::effectShaderCode(
+	const std::string& name,
+	const ShaderType& type,
+	const std::string& dxSource,
+	const std::string& vkSource) const
+	-> std::vector<Byte>
+{
+	auto& archive = shaderArchive();
+
+	if (mDevice->apiVersion() == APIVersion::DirectX12) {
+#ifdef __ENABLE__DIRECTX12__
+		return archive.code(name, type, APIVersion::DirectX12, dxSource, [&]()
+			{
+				return ShaderCompiler::compileToCso(type, dxSource, "main");
+			});
+#endif
+	}
+
+	if (mDevice->apiVersion() == APIVersion::Vulkan) {
+#ifdef __ENABLE__VULKAN__
+		return archive.code(name, type, APIVersion::Vulkan, vkSource, [&]()
+			{
+				return compileToSpv(name, type, vkSource);
+			});
+#endif
+	}
+
+	return {};
+}
+
+#ifdef __ENABLE__VULKAN__
+auto CodeRed::EffectPass::compileToSpv(
+	const std::string& name,
+	const ShaderType& type,
+	const std::string& source)
+	-> std::vector<Byte>
+{
+	auto code = ShaderCompiler::compileToSpv(type, source);
+
+#ifndef _DEBUG
+	//in release, we optimize the shaders and strip the debug instructions
+	ShaderOptimizeReport report;
+
+	code = ShaderCompiler::optimizeSpv(code, report);
+
+	std::lock_guard<std::mutex> lock(gShaderOptimizeReportsMutex);
+
+	gShaderOptimizeReports.push_back({ name + (type == ShaderType::Vertex ? ".Vertex" : ".Pixel"), report });
+#endif
+
+	return code;
+}
+#endif
+
+auto CodeRed::EffectPass::layoutCreations() noexcept -> size_t
+{
+	return gLayoutCreations;
+}
+
+void CodeRed::EffectPass::reflectLayouts()
+{
+	setLayouts(ShaderReflection::merge(
+		ShaderReflection::reflect(mEffectVertexShaderCode),
+		ShaderReflection::reflect(mEffectPixelShaderCode)));
+}
+
+void CodeRed::EffectPass::setLayouts(const ShaderReflection& reflection)
+{
+	std::string key;
+
+	for (const auto& input : reflection.Inputs) {
+		key += input.Name + ":" +
+			std::to_string(static_cast<UInt32>(input.Format)) + ":" +
+			std::to_string(input.Location) + ";";
+	}
+
+	std::lock_guard<std::mutex> lock(mDeviceResources->Mutex);
+
+	auto& inputAssembly = mDeviceResources->InputAssemblies[key];
+
+	if (inputAssembly == nullptr) {
+		inputAssembly = mPipelineInfo->pipelineFactory()->createInputAssemblyState(
+			reflection.inputElements(),
+			PrimitiveTopology::TriangleList
+		);
+
+		gLayoutCreations++;
+	}
+
+	const auto layouts = mDeviceResources->ResourceLayouts->size();
+
+	mPipelineInfo->setInputAssemblyState(inputAssembly);
+	mPipelineInfo->setResourceLayout(mDeviceResources->ResourceLayouts->layout(reflection, { mSampler }));
+
+	gLayoutCreations += mDeviceResources->ResourceLayouts->size() - layouts;
+}
+
+auto CodeRed::EffectPass::deviceResources(const std::shared_ptr<GpuLogicalDevice>& device)
+	-> std::shared_ptr<DeviceResources>
+{
+	//we only hold weak pointers, so the resources are destroyed with the last effect pass of device
+	static std::unordered_map<GpuLogicalDevice*, std::weak_ptr<DeviceResources>> devices;
+	static std::mutex mutex;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto resources = devices[device.get()].lock();
+
+	if (resources == nullptr) {
+		resources = std::make_shared<DeviceResources>();
+		resources->ResourceLayouts = std::make_shared<ResourceLayoutCache>(device);
+		resources->PipelineStates = std::make_shared<PipelineStateCache>(device);
+
+		devices[device.get()] = resources;
+	}
+
+	return resources;
+}
+
+auto CodeRed::EffectPass::shaderArchive() -> ShaderArchiveCache&
+{
+	//the release shaders are optimized, so they can not share the archive with debug
+#ifdef _DEBUG
+	static ShaderArchiveCache archive("./EffectShaders.Debug.archive");
+#else
+	static ShaderArchiveCache archive("./EffectShaders.Release.archive");
+#endif
+
+	return archive;
+}
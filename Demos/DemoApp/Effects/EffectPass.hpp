@@ -1,6 +1,10 @@
 #pragma once
 
+#include "../Pipelines/ResourceLayoutCache.hpp"
+#include "../Pipelines/PipelineStateCache.hpp"
 #include "../Pipelines/PipelineInfo.hpp"
+#include "../Shaders/ShaderCompiler.hpp"
+#include "../Shaders/ShaderArchive.hpp"
 
 #include "EffectProperties.hpp"
 
@@ -27,6 +31,8 @@ namespace CodeRed {
 
 		virtual void setAmbientLight(const glm::vec4& light);
 
+		//create the states from pipelineStates(), so a state toggled back is the same object
+		//and the pipeline of it is found in the pipeline cache instead of created again
 		virtual void updateState(
 			const std::optional<std::shared_ptr<GpuBlendState>>& blend,
 			const std::optional<std::shared_ptr<GpuDepthStencilState>>& depthStencil,
@@ -50,6 +56,31 @@ namespace CodeRed {
 			const size_t startIndexLocation = 0,
 			const size_t baseVertexLocation = 0,
 			const size_t startInstanceLocation = 0);
+
+		//swap in the pipeline created asynchronously, call it before recording on more than one thread
+		virtual void prepareEffect();
+
+		//the functions with command list do not change the state of effect pass
+		//so more than one thread can record the effect pass into their own command lists
+		//the pipeline should be prepared before(prepareEffect)
+		virtual void bindEffect(
+			const std::shared_ptr<GpuGraphicsCommandList>& commandList) const;
+
+		void drawIndexed(
+			const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+			const size_t indexCount,
+			const size_t instanceCount,
+			const size_t startIndexLocation = 0,
+			const size_t baseVertexLocation = 0,
+			const size_t startInstanceLocation = 0) const;
+
+		void drawIndexedWithTextureMaterial(
+			const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+			const size_t indexCount,
+			const size_t instanceCount,
+			const size_t startIndexLocation = 0,
+			const size_t baseVertexLocation = 0,
+			const size_t startInstanceLocation = 0) const;
 		
 		virtual void updateToGpu(
 			const std::shared_ptr<GpuCommandAllocator>& allocator,
@@ -58,6 +89,64 @@ namespace CodeRed {
 		auto transform(const size_t index) const -> Transform3D;
 
 		auto light(const LightType type, const size_t index) const -> Light;
+
+		auto pipelineInfo() const noexcept -> std::shared_ptr<PipelineInfo> { return mPipelineInfo; }
+
+		//the interned states of device, they are shared by the effect passes of device
+		auto pipelineStates() const noexcept -> std::shared_ptr<PipelineStateCache> { return mPipelineStates; }
+
+		//the reports of effect shaders optimized in this process, the name is "<effect>.<type>"
+		//the shaders loaded from the shader archive are not optimized again, so they have no report
+		static auto shaderOptimizeReports() -> std::vector<std::pair<std::string, ShaderOptimizeReport>>;
+
+		//write the shaders compiled in this process to the shader archive
+		//call it at shutdown, so the next run loads them instead of compiling them
+		static void saveShaderArchive();
+
+		//the number of input assembly states and resource layouts the effect passes created in this process
+		static auto layoutCreations() noexcept -> size_t;
+	protected:
+		void drawIndexed(
+			const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+			const MaterialType materialType,
+			const size_t indexCount,
+			const size_t instanceCount,
+			const size_t startIndexLocation,
+			const size_t baseVertexLocation,
+			const size_t startInstanceLocation) const;
+
+		//find the compiled effect shader of the api of device in the shader archive
+		//if it is not found or out of date, we compile the source of the api
+		auto effectShaderCode(
+			const std::string& name,
+			const ShaderType& type,
+			const std::string& dxSource,
+			const std::string& vkSource) const
+			-> std::vector<Byte>;
+
+#ifdef __ENABLE__VULKAN__
+		//compile the glsl effect shader to spir-v, in release we optimize it and strip the debug instructions
+		static auto compileToSpv(
+			const std::string& name,
+			const ShaderType& type,
+			const std::string& source)
+			-> std::vector<Byte>;
+#endif
+
+		//build the input layout and resource layout of pipeline from the reflection of effect shaders
+		//the shaders should be spir-v, the layouts with same elements are shared by the effect passes
+		void reflectLayouts();
+
+		//use the layouts described by reflection, the layouts with same elements are shared by the effect passes of device
+		void setLayouts(const ShaderReflection& reflection);
+
+		//the compiled shaders of all effect passes, shared by all effect passes
+		static auto shaderArchive() -> ShaderArchiveCache&;
+	private:
+		struct DeviceResources;
+
+		static auto deviceResources(const std::shared_ptr<GpuLogicalDevice>& device)
+			-> std::shared_ptr<DeviceResources>;
 	protected:
 		std::shared_ptr<GpuLogicalDevice> mDevice;
 		std::shared_ptr<GpuGraphicsCommandList> mCommandList;
@@ -68,8 +157,10 @@ namespace CodeRed {
 		std::shared_ptr<GpuBuffer> mTransformsBuffer;
 
 		std::shared_ptr<GpuSampler> mSampler;
+		std::shared_ptr<PipelineStateCache> mPipelineStates;
 		
 		std::shared_ptr<PipelineInfo> mPipelineInfo;
+		std::shared_ptr<DeviceResources> mDeviceResources;
 
 		std::vector<Light> mLights;
 		std::vector<Transform3D> mTransforms;
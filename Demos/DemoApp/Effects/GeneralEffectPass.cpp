@@ -1,8 +1,8 @@
 #include "GeneralEffectPass.hpp"
 
 #include "../Resources/ResourceHelper.hpp"
+#include "../Profiling/Profiler.hpp"
 #include "../Shaders/ShaderResources.hpp"
-#include "../Shaders/ShaderCompiler.hpp"
 
 CodeRed::GeneralEffectPass::GeneralEffectPass(
 	const std::shared_ptr<GpuLogicalDevice>& device,
@@ -10,25 +10,12 @@ CodeRed::GeneralEffectPass::GeneralEffectPass(
 	const size_t maxInstance) : EffectPass(device, renderPass, maxInstance),
 	mMaterials(maxInstance)
 {
-	if (mDevice->apiVersion() == APIVersion::DirectX12) {
-#ifdef __ENABLE__DIRECTX12__
-		mEffectVertexShaderCode = ShaderCompiler::compileToCso(
-			ShaderType::Vertex, DxGeneralEffectPassVertexShaderCode, "main");
-		mEffectPixelShaderCode = ShaderCompiler::compileToCso(
-			ShaderType::Pixel, DxGeneralEffectPassPixelShaderCode, "main");
-#endif
-
-	}
-	else if (mDevice->apiVersion() == APIVersion::Vulkan) {
-#ifdef __ENABLE__VULKAN__
-		mEffectVertexShaderCode = ShaderCompiler::compileToSpv(
-			ShaderType::Vertex, VkGeneralEffectPassVertexShaderCode);
-
-		mEffectPixelShaderCode = ShaderCompiler::compileToSpv(
-			ShaderType::Pixel, VkGeneralEffectPassPixelShaderCode
-		);
-#endif
-	}
+	//the compiled shaders are cached in the archive, only the first run needs compiling
+	mEffectVertexShaderCode = effectShaderCode("GeneralEffectPass", ShaderType::Vertex,
+		DxGeneralEffectPassVertexShaderCode, VkGeneralEffectPassVertexShaderCode);
+
+	mEffectPixelShaderCode = effectShaderCode("GeneralEffectPass", ShaderType::Pixel,
+		DxGeneralEffectPassPixelShaderCode, VkGeneralEffectPassPixelShaderCode);
 
 	auto pipelineFactory = mPipelineInfo->pipelineFactory();
 	
@@ -40,6 +27,9 @@ CodeRed::GeneralEffectPass::GeneralEffectPass(
 			{ "compile effect pass shader failed." })
 	);
 
+	//the layouts are reflected from the spir-v, so they can not be different from the shaders
+	if (mDevice->apiVersion() == APIVersion::Vulkan) reflectLayouts();
+
 	mPipelineInfo->setVertexShaderState(
 		pipelineFactory->createShaderState(
 			ShaderType::Vertex,
@@ -94,6 +84,8 @@ void CodeRed::GeneralEffectPass::updateToGpu(
 	const std::shared_ptr<GpuCommandAllocator>& allocator,
 	const std::shared_ptr<GpuCommandQueue>& queue)
 {
+	CODE_RED_PROFILE_ZONE("GeneralEffectPass::updateToGpu");
+
 	ResourceHelper::updateBuffer(mLightsBuffer, mLights.data(), sizeof(Light) * mLights.size());
 	ResourceHelper::updateBuffer(mMaterialsBuffer, mMaterials.data(), sizeof(Material) * mMaterials.size());
 	ResourceHelper::updateBuffer(mTransformsBuffer, mTransforms.data(), sizeof(Transform3D) * mTransforms.size());
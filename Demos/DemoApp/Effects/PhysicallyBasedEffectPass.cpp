@@ -1,8 +1,8 @@
 #include "PhysicallyBasedEffectPass.hpp"
 
 #include "../Resources/ResourceHelper.hpp"
+#include "../Profiling/Profiler.hpp"
 #include "../Shaders/ShaderResources.hpp"
-#include "../Shaders/ShaderCompiler.hpp"
 
 CodeRed::PhysicallyBasedEffectPass::PhysicallyBasedEffectPass(
 	const std::shared_ptr<GpuLogicalDevice>& device,
@@ -10,26 +10,13 @@ CodeRed::PhysicallyBasedEffectPass::PhysicallyBasedEffectPass(
 	const size_t maxInstance) : EffectPass(device, renderPass, maxInstance),
 	mMaterials(maxInstance)
 {
-	if (mDevice->apiVersion() == APIVersion::DirectX12) {
-#ifdef __ENABLE__DIRECTX12__
-		mEffectVertexShaderCode = ShaderCompiler::compileToCso(
-			ShaderType::Vertex, DxPhysicallyBasedEffectPassVertexShaderCode, "main");
-		mEffectPixelShaderCode = ShaderCompiler::compileToCso(
-			ShaderType::Pixel, DxPhysicallyBasedEffectPassPixelShaderCode, "main");
-#endif
-
-	}
-	else if (mDevice->apiVersion() == APIVersion::Vulkan) {
-#ifdef __ENABLE__VULKAN__
-		mEffectVertexShaderCode = ShaderCompiler::compileToSpv(
-			ShaderType::Vertex, VkPhysicallyBasedEffectPassVertexShaderCode);
-
-		mEffectPixelShaderCode = ShaderCompiler::compileToSpv(
-			ShaderType::Pixel, VkPhysicallyBasedEffectPassPixelShaderCode
-		);
-#endif
-	}
-	
+	//the compiled shaders are cached in the archive, only the first run needs compiling
+	mEffectVertexShaderCode = effectShaderCode("PhysicallyBasedEffectPass", ShaderType::Vertex,
+		DxPhysicallyBasedEffectPassVertexShaderCode, VkPhysicallyBasedEffectPassVertexShaderCode);
+
+	mEffectPixelShaderCode = effectShaderCode("PhysicallyBasedEffectPass", ShaderType::Pixel,
+		DxPhysicallyBasedEffectPassPixelShaderCode, VkPhysicallyBasedEffectPassPixelShaderCode);
+
 	auto pipelineFactory = mPipelineInfo->pipelineFactory();
 
 	CODE_RED_DEBUG_THROW_IF(
@@ -40,6 +27,9 @@ CodeRed::PhysicallyBasedEffectPass::PhysicallyBasedEffectPass(
 			{ "compile effect pass shader failed." })
 	);
 
+	//the layouts are reflected from the spir-v, so they can not be different from the shaders
+	if (mDevice->apiVersion() == APIVersion::Vulkan) reflectLayouts();
+
 	mPipelineInfo->setVertexShaderState(
 		pipelineFactory->createShaderState(
 			ShaderType::Vertex,
@@ -82,6 +72,14 @@ void CodeRed::PhysicallyBasedEffectPass::setMaterial(const size_t index, const P
 
 void CodeRed::PhysicallyBasedEffectPass::setTextureMaterial(const PhysicallyBasedTextureMaterial& material)
 {
+	//the demos set the texture material in every frame, but it is rarely changed
+	//so we only bind the textures again when one of them is changed
+	if (mTextureMaterial.DiffuseAlbedo == material.DiffuseAlbedo &&
+		mTextureMaterial.Metallic == material.Metallic &&
+		mTextureMaterial.Normal == material.Normal &&
+		mTextureMaterial.Roughness == material.Roughness &&
+		mTextureMaterial.AmbientOcclusion == material.AmbientOcclusion) return;
+
 	mTextureMaterial = material;
 
 	mDescriptorHeap->bindTexture(material.DiffuseAlbedo, 3);
@@ -105,6 +103,8 @@ void CodeRed::PhysicallyBasedEffectPass::updateToGpu(
 	const std::shared_ptr<GpuCommandAllocator>& allocator,
 	const std::shared_ptr<GpuCommandQueue>& queue)
 {
+	CODE_RED_PROFILE_ZONE("PhysicallyBasedEffectPass::updateToGpu");
+
 	ResourceHelper::updateBuffer(mLightsBuffer, mLights.data(), sizeof(Light) * mLights.size());
 	ResourceHelper::updateBuffer(mMaterialsBuffer, mMaterials.data(), sizeof(PhysicallyBasedMaterial) * mMaterials.size());
 	ResourceHelper::updateBuffer(mTransformsBuffer, mTransforms.data(), sizeof(Transform3D) * mTransforms.size());
@@ -20,17 +20,32 @@ struct Output
 	uint   InstanceId : SV_INSTANCEID;
 };
 
+struct Index
+{
+	float ambientLightRed;
+	float ambientLightGreen;
+	float ambientLightBlue;
+	float ambientLightAlpha;
+	uint  materialType;
+	uint  startInstance;
+};
+
 StructuredBuffer<Transform3D> transforms : register(t2, space0);
 
+//SV_INSTANCEID does not include the start instance location, so the draw sets it in the root constants
+ConstantBuffer<Index> index : register(b9, space0);
+
 Output main(
     float3 position : POSITION,
     float3 normal : NORMAL,
 	float2 texcoord : TEXCOORD,
     float3 tangent : TANGENT,
-	uint   instanceId : SV_INSTANCEID)
+	uint   localInstanceId : SV_INSTANCEID)
 {
     Output result;
 
+	uint instanceId = localInstanceId + index.startInstance;
+
     result.Position = mul(float4(position, 1.0f), transforms[instanceId].Transform).xyz;
     result.ViewPosition = mul(float4(result.Position, 1.0f), transforms[instanceId].View).xyz;
     result.SVPosition = mul(float4(result.ViewPosition, 1.0f), transforms[instanceId].Projection);
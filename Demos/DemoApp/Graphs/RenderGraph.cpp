@@ -0,0 +1,324 @@
+#include "RenderGraph.hpp"
+
+#include <algorithm>
+
+auto CodeRed::RenderGraphTextureInfo::compatible(const RenderGraphTextureInfo& other) const noexcept -> bool
+{
+	return
+		Width == other.Width &&
+		Height == other.Height &&
+		Format == other.Format &&
+		Sample == other.Sample;
+}
+
+auto CodeRed::RenderGraphTextures::texture(const size_t resource) const -> std::shared_ptr<GpuTexture>
+{
+	return mGraph.texture(resource);
+}
+
+CodeRed::RenderGraph::RenderGraph(const std::shared_ptr<GpuLogicalDevice>& device) :
+	mDevice(device)
+{
+}
+
+void CodeRed::RenderGraph::reset()
+{
+	mResources.clear();
+	mPasses.clear();
+	mCompiled = RenderGraphCompiled();
+	mIsCompiled = false;
+}
+
+auto CodeRed::RenderGraph::importTexture(
+	const std::string& name,
+	const std::shared_ptr<GpuTexture>& texture,
+	const ResourceLayout initialLayout,
+	const ResourceLayout finalLayout) -> size_t
+{
+	Resource resource;
+
+	resource.Name = name;
+	resource.Imported = true;
+	resource.Texture = texture;
+	resource.InitialLayout = initialLayout;
+	resource.FinalLayout = finalLayout;
+
+	mResources.push_back(resource);
+	mIsCompiled = false;
+
+	return mResources.size() - 1;
+}
+
+auto CodeRed::RenderGraph::createTexture(
+	const std::string& name,
+	const RenderGraphTextureInfo& info) -> size_t
+{
+	Resource resource;
+
+	resource.Name = name;
+	resource.Imported = false;
+	resource.Info = info;
+
+	mResources.push_back(resource);
+	mIsCompiled = false;
+
+	return mResources.size() - 1;
+}
+
+void CodeRed::RenderGraph::setImportedTexture(
+	const size_t resource,
+	const std::shared_ptr<GpuTexture>& texture)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		resource >= mResources.size() || mResources[resource].Imported == false,
+		InvalidException<size_t>({ "resource" })
+	);
+
+	mResources[resource].Texture = texture;
+}
+
+auto CodeRed::RenderGraph::addPass(
+	const std::string& name,
+	const std::vector<RenderGraphAccess>& accesses,
+	const Execute& execute,
+	const bool sideEffect) -> size_t
+{
+	for (const auto& access : accesses) {
+		CODE_RED_DEBUG_THROW_IF(
+			access.Resource >= mResources.size(),
+			InvalidException<size_t>({ "resource of access" })
+		);
+	}
+
+	Pass pass;
+
+	pass.Name = name;
+	pass.Accesses = accesses;
+	pass.Function = execute;
+	pass.SideEffect = sideEffect;
+
+	mPasses.push_back(pass);
+	mIsCompiled = false;
+
+	return mPasses.size() - 1;
+}
+
+auto CodeRed::RenderGraph::compile() -> const RenderGraphCompiled&
+{
+	mCompiled = RenderGraphCompiled();
+
+	const auto alive = cull();
+
+	//the imported textures start in their initial layout
+	//the transient textures start in the layout their first pass needs
+	//because they have no content before the first pass writes them
+	std::vector<ResourceLayout> layouts(mResources.size());
+	std::vector<bool> touched(mResources.size(), false);
+
+	for (size_t index = 0; index < mResources.size(); index++)
+		layouts[index] = mResources[index].InitialLayout;
+
+	for (size_t index = 0; index < mPasses.size(); index++) {
+		if (alive[index] == false) { mCompiled.CulledPasses.push_back(index); continue; }
+
+		RenderGraphStep step;
+
+		step.Pass = index;
+
+		for (const auto& access : mPasses[index].Accesses) {
+			auto& layout = layouts[access.Resource];
+
+			if (!mResources[access.Resource].Imported && touched[access.Resource] == false)
+				layout = access.Before;
+
+			touched[access.Resource] = true;
+
+			//if the resource is in the layout we need, we do not need transition
+			if (layout != access.Before)
+				step.Barriers.push_back(RenderGraphBarrier(access.Resource, layout, access.Before));
+
+			layout = access.After;
+		}
+
+		mCompiled.Steps.push_back(step);
+	}
+
+	for (size_t index = 0; index < mResources.size(); index++) {
+		const auto& resource = mResources[index];
+
+		if (resource.Imported && layouts[index] != resource.FinalLayout)
+			mCompiled.FinalBarriers.push_back(RenderGraphBarrier(index, layouts[index], resource.FinalLayout));
+	}
+
+	alias(alive);
+
+	mIsCompiled = true;
+
+	return mCompiled;
+}
+
+void CodeRed::RenderGraph::execute(const std::shared_ptr<GpuGraphicsCommandList>& commandList)
+{
+	if (mIsCompiled == false) compile();
+
+	createTransientTextures();
+
+	const RenderGraphTextures textures(*this);
+
+	mTouched.assign(mResources.size(), false);
+
+	for (const auto& step : mCompiled.Steps) {
+		const auto& pass = mPasses[step.Pass];
+
+		//the aliased texture is left in the layout of the last resource that used it
+		//so we transition it to the layout the first pass of the resource needs
+		for (const auto& access : pass.Accesses) {
+			if (mResources[access.Resource].Imported || mTouched[access.Resource]) continue;
+
+			const auto texture = this->texture(access.Resource);
+
+			if (texture->layout() != access.Before) commandList->layoutTransition(texture, access.Before);
+
+			mTouched[access.Resource] = true;
+		}
+
+		for (const auto& barrier : step.Barriers)
+			commandList->layoutTransition(texture(barrier.Resource), barrier.After);
+
+		if (pass.Function) pass.Function(commandList, textures);
+	}
+
+	for (const auto& barrier : mCompiled.FinalBarriers)
+		commandList->layoutTransition(texture(barrier.Resource), barrier.After);
+}
+
+auto CodeRed::RenderGraph::texture(const size_t resource) const -> std::shared_ptr<GpuTexture>
+{
+	if (mResources[resource].Imported) return mResources[resource].Texture;
+
+	const auto slot = mCompiled.Slots.empty() ? RenderGraphCompiled::invalidSlot : mCompiled.Slots[resource];
+
+	//the resource is only used by culled passes, so it has no texture
+	if (slot == RenderGraphCompiled::invalidSlot || slot >= mTransientTextures.size()) return nullptr;
+
+	return mTransientTextures[slot].Texture;
+}
+
+auto CodeRed::RenderGraph::cull() const -> std::vector<bool>
+{
+	std::vector<bool> alive(mPasses.size(), false);
+	std::vector<bool> needed(mResources.size(), false);
+
+	//the content of imported textures is used after the graph
+	for (size_t index = 0; index < mResources.size(); index++)
+		needed[index] = mResources[index].Imported;
+
+	//walk the passes backward, a pass is alive if it writes a resource that is needed
+	//the resources that an alive pass reads are needed by the passes before it
+	for (size_t index = mPasses.size(); index > 0; index--) {
+		const auto& pass = mPasses[index - 1];
+
+		auto isAlive = pass.SideEffect;
+
+		for (const auto& access : pass.Accesses) {
+			if (access.Type == RenderGraphAccessType::Write && needed[access.Resource])
+				isAlive = true;
+		}
+
+		if (isAlive == false) continue;
+
+		alive[index - 1] = true;
+
+		for (const auto& access : pass.Accesses) {
+			if (access.Type == RenderGraphAccessType::Read) needed[access.Resource] = true;
+		}
+	}
+
+	return alive;
+}
+
+void CodeRed::RenderGraph::alias(const std::vector<bool>& alive)
+{
+	constexpr auto invalid = RenderGraphCompiled::invalidSlot;
+
+	//the lifetime of transient resource is [first alive pass, last alive pass]
+	std::vector<std::pair<size_t, size_t>> lifetimes(mResources.size(), { invalid, invalid });
+
+	for (size_t index = 0; index < mPasses.size(); index++) {
+		if (alive[index] == false) continue;
+
+		for (const auto& access : mPasses[index].Accesses) {
+			auto& lifetime = lifetimes[access.Resource];
+
+			if (lifetime.first == invalid) lifetime.first = index;
+
+			lifetime.second = index;
+		}
+	}
+
+	std::vector<size_t> transients;
+
+	for (size_t index = 0; index < mResources.size(); index++) {
+		if (!mResources[index].Imported && lifetimes[index].first != invalid)
+			transients.push_back(index);
+	}
+
+	std::sort(transients.begin(), transients.end(), [&](const size_t left, const size_t right)
+		{
+			return lifetimes[left].first < lifetimes[right].first;
+		});
+
+	//greedy interval coloring, a slot is reused when its last user ends before the resource begins
+	std::vector<size_t> slotEnds;
+
+	mCompiled.Slots = std::vector<size_t>(mResources.size(), invalid);
+
+	for (const auto resource : transients) {
+		const auto& info = mResources[resource].Info;
+		const auto& lifetime = lifetimes[resource];
+
+		auto slot = invalid;
+
+		for (size_t index = 0; index < slotEnds.size(); index++) {
+			if (slotEnds[index] < lifetime.first && mCompiled.SlotInfos[index].compatible(info)) {
+				slot = index; break;
+			}
+		}
+
+		if (slot == invalid) {
+			slot = slotEnds.size();
+
+			slotEnds.push_back(0);
+			mCompiled.SlotInfos.push_back(info);
+		}
+
+		slotEnds[slot] = lifetime.second;
+		mCompiled.Slots[resource] = slot;
+	}
+}
+
+void CodeRed::RenderGraph::createTransientTextures()
+{
+	if (mTransientTextures.size() < mCompiled.SlotInfos.size())
+		mTransientTextures.resize(mCompiled.SlotInfos.size());
+
+	//the textures are kept between frames, we only create them when the description is changed
+	for (size_t index = 0; index < mCompiled.SlotInfos.size(); index++) {
+		auto& transient = mTransientTextures[index];
+		const auto& info = mCompiled.SlotInfos[index];
+
+		if (transient.Texture != nullptr && transient.Info.compatible(info)) continue;
+
+		CODE_RED_DEBUG_THROW_IF(
+			mDevice == nullptr,
+			InvalidException<GpuLogicalDevice>({ "device" })
+		);
+
+		transient.Info = info;
+		transient.Texture = mDevice->createTexture(
+			info.Sample == MultiSample::Count1 ?
+			ResourceInfo::Texture2D(info.Width, info.Height, info.Format, 1, ResourceUsage::RenderTarget) :
+			ResourceInfo::RenderTargetMultiSample(info.Width, info.Height, info.Format, info.Sample, info.Clear)
+		);
+	}
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace CodeRed {
+
+	//the description of transient texture, the transient textures with same description
+	//and not overlapped lifetime share the same texture
+	struct RenderGraphTextureInfo {
+		size_t Width = 0;
+		size_t Height = 0;
+
+		PixelFormat Format = PixelFormat::RedGreenBlueAlpha8BitUnknown;
+		MultiSample Sample = MultiSample::Count1;
+
+		//the clear value is only an optimization hint, so it is not compared when we alias textures
+		ClearValue Clear = ClearValue(0, 0, 0, 0);
+
+		RenderGraphTextureInfo() = default;
+
+		RenderGraphTextureInfo(
+			const size_t width,
+			const size_t height,
+			const PixelFormat format,
+			const MultiSample sample = MultiSample::Count1,
+			const ClearValue& clear = ClearValue(0, 0, 0, 0)) :
+			Width(width), Height(height), Format(format), Sample(sample), Clear(clear) {}
+
+		auto compatible(const RenderGraphTextureInfo& other) const noexcept -> bool;
+	};
+
+	enum class RenderGraphAccessType : UInt32 {
+		Read = 0,
+		Write = 1
+	};
+
+	//the pass needs the resource in "Before" layout, and leaves it in "After" layout
+	//for example, a render pass with attachment(RenderTarget, Present) is Before = RenderTarget, After = Present
+	struct RenderGraphAccess {
+		RenderGraphAccessType Type = RenderGraphAccessType::Read;
+
+		size_t Resource = 0;
+
+		ResourceLayout Before = ResourceLayout::GeneralRead;
+		ResourceLayout After = ResourceLayout::GeneralRead;
+
+		RenderGraphAccess() = default;
+
+		RenderGraphAccess(
+			const RenderGraphAccessType type,
+			const size_t resource,
+			const ResourceLayout before,
+			const ResourceLayout after) :
+			Type(type), Resource(resource), Before(before), After(after) {}
+
+		static auto read(const size_t resource, const ResourceLayout layout) -> RenderGraphAccess
+		{
+			return RenderGraphAccess(RenderGraphAccessType::Read, resource, layout, layout);
+		}
+
+		static auto write(const size_t resource, const ResourceLayout before, const ResourceLayout after)
+			-> RenderGraphAccess
+		{
+			return RenderGraphAccess(RenderGraphAccessType::Write, resource, before, after);
+		}
+	};
+
+	struct RenderGraphBarrier {
+		size_t Resource = 0;
+
+		ResourceLayout Before = ResourceLayout::GeneralRead;
+		ResourceLayout After = ResourceLayout::GeneralRead;
+
+		RenderGraphBarrier() = default;
+
+		RenderGraphBarrier(
+			const size_t resource,
+			const ResourceLayout before,
+			const ResourceLayout after) :
+			Resource(resource), Before(before), After(after) {}
+	};
+
+	struct RenderGraphStep {
+		size_t Pass = 0;
+
+		//the layout transitions before we execute the pass
+		std::vector<RenderGraphBarrier> Barriers;
+
+		RenderGraphStep() = default;
+	};
+
+	struct RenderGraphCompiled {
+		std::vector<RenderGraphStep> Steps;
+
+		//the layout transitions of imported textures to their final layout
+		std::vector<RenderGraphBarrier> FinalBarriers;
+
+		std::vector<size_t> CulledPasses;
+
+		//the texture slot of every resource, the imported resources are invalidSlot
+		//the transient resources with same slot are aliased
+		std::vector<size_t> Slots;
+
+		std::vector<RenderGraphTextureInfo> SlotInfos;
+
+		static constexpr size_t invalidSlot = static_cast<size_t>(-1);
+
+		RenderGraphCompiled() = default;
+	};
+
+	class RenderGraph;
+
+	class RenderGraphTextures {
+	public:
+		explicit RenderGraphTextures(const RenderGraph& graph) : mGraph(graph) {}
+
+		auto texture(const size_t resource) const -> std::shared_ptr<GpuTexture>;
+	private:
+		const RenderGraph& mGraph;
+	};
+
+	/*
+	 * the render graph is built again only when the passes are changed(for example, we toggle msaa):
+	 * 1. reset() and declare the textures and passes in the order of execution
+	 * 2. compile() culls the passes that do not contribute to imported textures,
+	 *    finds the layout transitions and aliases the transient textures
+	 * 3. execute() records the transitions and the passes to command list in every frame
+	 *    the back buffer of the frame is replaced with setImportedTexture(), it does not compile again
+	 * compile() does not use the device, so it can be tested without GPU
+	 */
+	class RenderGraph final : public Noncopyable {
+	public:
+		using Execute = std::function<void(
+			const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+			const RenderGraphTextures& textures)>;
+
+		//without device, we can only compile the graph
+		explicit RenderGraph(
+			const std::shared_ptr<GpuLogicalDevice>& device = nullptr);
+
+		void reset();
+
+		auto importTexture(
+			const std::string& name,
+			const std::shared_ptr<GpuTexture>& texture,
+			const ResourceLayout initialLayout,
+			const ResourceLayout finalLayout) -> size_t;
+
+		auto createTexture(
+			const std::string& name,
+			const RenderGraphTextureInfo& info) -> size_t;
+
+		//replace the texture of imported resource, for example, the back buffer of this frame
+		//the compiled graph does not depend on the textures, so we do not need to compile it again
+		void setImportedTexture(
+			const size_t resource,
+			const std::shared_ptr<GpuTexture>& texture);
+
+		//the pass with side effect is never culled
+		auto addPass(
+			const std::string& name,
+			const std::vector<RenderGraphAccess>& accesses,
+			const Execute& execute,
+			const bool sideEffect = false) -> size_t;
+
+		auto compile() -> const RenderGraphCompiled&;
+
+		void execute(const std::shared_ptr<GpuGraphicsCommandList>& commandList);
+
+		auto texture(const size_t resource) const -> std::shared_ptr<GpuTexture>;
+
+		auto compiled() const noexcept -> const RenderGraphCompiled& { return mCompiled; }
+
+		auto passName(const size_t pass) const -> const std::string& { return mPasses[pass].Name; }
+
+		auto resourceName(const size_t resource) const -> const std::string& { return mResources[resource].Name; }
+
+		//the number of textures created for transient resources
+		auto transientTextures() const noexcept -> size_t { return mTransientTextures.size(); }
+	private:
+		struct Resource {
+			std::string Name;
+
+			bool Imported = false;
+
+			std::shared_ptr<GpuTexture> Texture;
+
+			ResourceLayout InitialLayout = ResourceLayout::Undefined;
+			ResourceLayout FinalLayout = ResourceLayout::Undefined;
+
+			RenderGraphTextureInfo Info;
+		};
+
+		struct Pass {
+			std::string Name;
+
+			std::vector<RenderGraphAccess> Accesses;
+
+			Execute Function;
+
+			bool SideEffect = false;
+		};
+
+		struct TransientTexture {
+			RenderGraphTextureInfo Info;
+
+			std::shared_ptr<GpuTexture> Texture;
+		};
+
+		auto cull() const -> std::vector<bool>;
+
+		void alias(const std::vector<bool>& alive);
+
+		void createTransientTextures();
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+
+		std::vector<Resource> mResources;
+		std::vector<Pass> mPasses;
+
+		RenderGraphCompiled mCompiled;
+
+		//the textures of slots, they are kept between frames
+		std::vector<TransientTexture> mTransientTextures;
+
+		//the resources that execute() transitioned, it is kept to avoid allocating in every execute()
+		std::vector<bool> mTouched;
+
+		bool mIsCompiled = false;
+	};
+
+}
@@ -0,0 +1,127 @@
+#include "PipelineCache.hpp"
+
+CodeRed::PipelineCache::PipelineCache(
+	const std::shared_ptr<GpuLogicalDevice>& device,
+	const size_t capacity) :
+	mDevice(device), mCapacity(capacity)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	CODE_RED_DEBUG_THROW_IF(
+		capacity == 0,
+		InvalidException<size_t>({ "capacity" })
+	);
+}
+
+auto CodeRed::PipelineCache::pipeline(
+	const std::shared_ptr<GpuRenderPass>& renderPass,
+	const std::shared_ptr<GpuResourceLayout>& resourceLayout,
+	const std::shared_ptr<GpuInputAssemblyState>& inputAssembly,
+	const std::shared_ptr<GpuShaderState>& vertexShader,
+	const std::shared_ptr<GpuShaderState>& pixelShader,
+	const std::shared_ptr<GpuDepthStencilState>& depthStencil,
+	const std::shared_ptr<GpuBlendState>& blend,
+	const std::shared_ptr<GpuRasterizationState>& rasterization)
+	-> std::shared_ptr<GpuGraphicsPipeline>
+{
+	const StateKey key = {
+		renderPass.get(),
+		resourceLayout.get(),
+		inputAssembly.get(),
+		vertexShader.get(),
+		pixelShader.get(),
+		depthStencil.get(),
+		blend.get(),
+		rasterization.get()
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		const auto it = mIndices.find(key);
+
+		if (it != mIndices.end()) {
+			//move the entry to the front, it is the most recently used one now
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			mHits++;
+
+			return it->second->Pipeline;
+		}
+
+		mMisses++;
+	}
+
+	Entry entry;
+
+	entry.Key = key;
+	entry.States = {
+		renderPass,
+		resourceLayout,
+		inputAssembly,
+		vertexShader,
+		pixelShader,
+		depthStencil,
+		blend,
+		rasterization
+	};
+
+	//creating pipeline is slow, so we do not hold the lock
+	entry.Pipeline = mDevice->createGraphicsPipeline(
+		renderPass,
+		resourceLayout,
+		inputAssembly,
+		vertexShader,
+		pixelShader,
+		depthStencil,
+		blend,
+		rasterization
+	);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	//other thread may create the pipeline with same states when we were creating it
+	//we use the one in cache, so all users share the same pipeline
+	const auto it = mIndices.find(key);
+
+	if (it != mIndices.end()) return it->second->Pipeline;
+
+	//the pipeline of evicted entry may still be used by pipeline info or command list
+	//they hold the shared pointer, so it is safe to remove it from cache
+	if (mEntries.size() >= mCapacity) {
+		mIndices.erase(mEntries.back().Key);
+		mEntries.pop_back();
+	}
+
+	mEntries.push_front(std::move(entry));
+	mIndices[key] = mEntries.begin();
+
+	return mEntries.front().Pipeline;
+}
+
+void CodeRed::PipelineCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mIndices.clear();
+	mEntries.clear();
+}
+
+auto CodeRed::PipelineCache::size() const -> size_t
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	return mEntries.size();
+}
+
+auto CodeRed::PipelineCache::KeyHasher::operator()(const StateKey& key) const noexcept -> size_t
+{
+	size_t value = 0;
+
+	for (const auto state : key)
+		value ^= std::hash<const void*>()(state) + 0x9e3779b9 + (value << 6) + (value >> 2);
+
+	return value;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include <unordered_map>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <list>
+
+namespace CodeRed {
+
+	//cache the graphics pipelines by the states they are created from
+	//the states are keyed by object identity, so reuse the state objects to hit the cache
+	//the states that are created again(for example, toggled back) should come from PipelineStateCache
+	//the cache can be used by more than one thread, the pipeline is created without holding the lock
+	class PipelineCache final : public Noncopyable {
+	public:
+		explicit PipelineCache(
+			const std::shared_ptr<GpuLogicalDevice>& device,
+			const size_t capacity = 32);
+
+		//return the pipeline created from the same states
+		//if there is not, create it and evict the least recently used pipeline when the cache is full
+		auto pipeline(
+			const std::shared_ptr<GpuRenderPass>& renderPass,
+			const std::shared_ptr<GpuResourceLayout>& resourceLayout,
+			const std::shared_ptr<GpuInputAssemblyState>& inputAssembly,
+			const std::shared_ptr<GpuShaderState>& vertexShader,
+			const std::shared_ptr<GpuShaderState>& pixelShader,
+			const std::shared_ptr<GpuDepthStencilState>& depthStencil,
+			const std::shared_ptr<GpuBlendState>& blend,
+			const std::shared_ptr<GpuRasterizationState>& rasterization)
+			-> std::shared_ptr<GpuGraphicsPipeline>;
+
+		void clear();
+
+		auto size() const -> size_t;
+
+		auto capacity() const noexcept -> size_t { return mCapacity; }
+
+		auto hits() const noexcept -> size_t { return mHits; }
+
+		auto misses() const noexcept -> size_t { return mMisses; }
+	private:
+		using StateKey = std::array<const void*, 8>;
+
+		struct KeyHasher {
+			auto operator()(const StateKey& key) const noexcept -> size_t;
+		};
+
+		struct Entry {
+			StateKey Key = {};
+
+			//keep the states alive, so their address will not be reused by other states
+			std::array<std::shared_ptr<void>, 8> States;
+
+			std::shared_ptr<GpuGraphicsPipeline> Pipeline;
+		};
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+
+		//the front of list is the most recently used entry
+		std::list<Entry> mEntries;
+		std::unordered_map<StateKey, std::list<Entry>::iterator, KeyHasher> mIndices;
+
+		size_t mCapacity = 0;
+
+		//the counters are read without the lock, so they are atomic
+		std::atomic<size_t> mHits = 0;
+		std::atomic<size_t> mMisses = 0;
+
+		mutable std::mutex mMutex;
+	};
+
+}
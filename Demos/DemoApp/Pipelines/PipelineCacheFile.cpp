@@ -0,0 +1,260 @@
+#include "PipelineCacheFile.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+auto CodeRed::PipelineCacheIdentity::from(
+	const std::shared_ptr<GpuDisplayAdapter>& adapter,
+	const APIVersion api) -> PipelineCacheIdentity
+{
+	CODE_RED_DEBUG_THROW_IF(
+		adapter == nullptr,
+		InvalidException<GpuDisplayAdapter>({ "adapter" })
+	);
+
+	return PipelineCacheIdentity(
+		api,
+		adapter->name(),
+		adapter->vendorId(),
+		adapter->deviceId()
+	);
+}
+
+auto CodeRed::MemoryPipelineCacheBackend::deserialize(const std::vector<Byte>& data) -> bool
+{
+	mData = data;
+
+	return true;
+}
+
+auto CodeRed::MemoryPipelineCacheBackend::serialize() const -> std::vector<Byte>
+{
+	return mData;
+}
+
+CodeRed::DevicePipelineCacheBackend::DevicePipelineCacheBackend(const std::shared_ptr<GpuLogicalDevice>& device) :
+	mDevice(device)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	//the empty native cache, it is replaced if we load a file
+	create({});
+}
+
+CodeRed::DevicePipelineCacheBackend::~DevicePipelineCacheBackend()
+{
+	destroy();
+}
+
+auto CodeRed::DevicePipelineCacheBackend::deserialize(const std::vector<Byte>& data) -> bool
+{
+	destroy();
+
+	if (create(data)) return true;
+
+	//the driver rejected the data, so we start with an empty native cache
+	create({});
+
+	return false;
+}
+
+auto CodeRed::DevicePipelineCacheBackend::serialize() const -> std::vector<Byte>
+{
+#ifdef __ENABLE__DIRECTX12__
+	if (mDirectX12Library != nullptr) {
+		std::vector<Byte> data(mDirectX12Library->GetSerializedSize());
+
+		if (FAILED(mDirectX12Library->Serialize(data.data(), data.size()))) return {};
+
+		return data;
+	}
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mVulkanCache) {
+		const auto vkDevice = std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device();
+		const auto data = vkDevice.getPipelineCacheData(mVulkanCache);
+
+		return std::vector<Byte>(data.begin(), data.end());
+	}
+#endif
+
+	//there is no native cache, so we keep the bytes like the memory backend
+	return mData;
+}
+
+auto CodeRed::DevicePipelineCacheBackend::create(const std::vector<Byte>& data) -> bool
+{
+	mData = data;
+
+#ifdef __ENABLE__DIRECTX12__
+	if (mDevice->apiVersion() == APIVersion::DirectX12) {
+		const auto dxDevice = std::static_pointer_cast<DirectX12LogicalDevice>(mDevice)->device();
+
+		Microsoft::WRL::ComPtr<ID3D12Device1> dxDevice1;
+
+		//the pipeline library needs ID3D12Device1, the old runtime only keeps the bytes
+		if (FAILED(dxDevice->QueryInterface(IID_PPV_ARGS(&dxDevice1)))) return true;
+
+		//the driver returns an error if the data is created by other adapter or driver
+		if (SUCCEEDED(dxDevice1->CreatePipelineLibrary(mData.data(), mData.size(), IID_PPV_ARGS(&mDirectX12Library))))
+			return true;
+
+		mDirectX12Library.Reset();
+		mData.clear();
+
+		if (data.empty()) throw FailedException(DebugType::Create, { "ID3D12PipelineLibrary" });
+
+		return false;
+	}
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mDevice->apiVersion() == APIVersion::Vulkan) {
+		const auto vkDevice = std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device();
+
+		//vulkan ignores the data it can not use, but a broken header may still fail the creation
+		try {
+			mVulkanCache = vkDevice.createPipelineCache(
+				vk::PipelineCacheCreateInfo({}, mData.size(), mData.data()));
+		}
+		catch (const vk::SystemError&) {
+			mData.clear();
+
+			if (data.empty()) throw FailedException(DebugType::Create, { "VkPipelineCache" });
+
+			return false;
+		}
+
+		//vulkan copies the data, so we do not need to keep it
+		mData.clear();
+
+		return true;
+	}
+#endif
+
+	throw NotSupportException(NotSupportType::Enum);
+}
+
+void CodeRed::DevicePipelineCacheBackend::destroy()
+{
+#ifdef __ENABLE__DIRECTX12__
+	mDirectX12Library.Reset();
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mVulkanCache) {
+		std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device().destroyPipelineCache(mVulkanCache);
+
+		mVulkanCache = nullptr;
+	}
+#endif
+
+	mData.clear();
+}
+
+CodeRed::PipelineCacheFile::PipelineCacheFile(
+	const std::string& fileName,
+	const PipelineCacheIdentity& identity,
+	const std::shared_ptr<PipelineCacheBackend>& backend) :
+	mBackend(backend), mIdentity(identity), mFileName(fileName)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		backend == nullptr,
+		InvalidException<PipelineCacheBackend>({ "backend" })
+	);
+}
+
+auto CodeRed::PipelineCacheFile::load() -> bool
+{
+	std::ifstream file(mFileName, std::ios::binary | std::ios::ate);
+
+	if (!file.is_open()) return false;
+
+	const auto size = static_cast<size_t>(file.tellg());
+
+	Header header;
+
+	if (size < sizeof(Header)) return false;
+
+	file.seekg(0, std::ios::beg);
+	file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+	//the data size is checked before we allocate memory for it
+	if (header.DataSize != size - sizeof(Header)) return false;
+
+	std::vector<Byte> data(static_cast<size_t>(header.DataSize));
+
+	file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+	if (!file.good()) return false;
+
+	//the header we expect, if any value is different, the cache is out of date
+	const auto expected = this->header(data);
+
+	if (std::memcmp(&header, &expected, sizeof(Header)) != 0) return false;
+
+	return mBackend->deserialize(data);
+}
+
+auto CodeRed::PipelineCacheFile::save() const -> bool
+{
+	const auto data = mBackend->serialize();
+	const auto header = this->header(data);
+	const auto temporary = mFileName + ".tmp";
+
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open()) return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+		if (!file.good()) return false;
+	}
+
+	//replace the old file after the new one is written
+	//so a crash when saving will not leave a broken cache
+	std::error_code error;
+
+	std::filesystem::rename(temporary, mFileName, error);
+
+	return !error;
+}
+
+auto CodeRed::PipelineCacheFile::header(const std::vector<Byte>& data) const -> Header
+{
+	Header header;
+
+	header.Magic = magic;
+	header.Version = version;
+	header.API = static_cast<UInt32>(mIdentity.API);
+	header.VendorId = mIdentity.VendorId;
+	header.DeviceId = mIdentity.DeviceId;
+	header.DriverVersion = mIdentity.DriverVersion;
+	header.AdapterHash = hash(
+		reinterpret_cast<const Byte*>(mIdentity.AdapterName.data()),
+		mIdentity.AdapterName.size());
+	header.DataSize = data.size();
+	header.DataHash = hash(data.data(), data.size());
+
+	return header;
+}
+
+auto CodeRed::PipelineCacheFile::hash(const Byte* data, const size_t size) noexcept -> UInt64
+{
+	//fnv-1a, the value is stored in file, so it must be same between runs
+	UInt64 value = 14695981039346656037ull;
+
+	for (size_t index = 0; index < size; index++) {
+		value = value ^ data[index];
+		value = value * 1099511628211ull;
+	}
+
+	return value;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#ifdef __ENABLE__DIRECTX12__
+#include <d3d12.h>
+#include <wrl/client.h>
+#endif
+
+#ifdef __ENABLE__VULKAN__
+#include <vulkan/vulkan.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+namespace CodeRed {
+
+	//the driver pipeline cache is only valid for the adapter and driver that created it
+	struct PipelineCacheIdentity {
+		APIVersion API = APIVersion::DirectX12;
+
+		std::string AdapterName;
+
+		size_t VendorId = 0;
+		size_t DeviceId = 0;
+		size_t DriverVersion = 0;
+
+		PipelineCacheIdentity() = default;
+
+		PipelineCacheIdentity(
+			const APIVersion api,
+			const std::string& adapterName,
+			const size_t vendorId,
+			const size_t deviceId,
+			const size_t driverVersion = 0) :
+			API(api), AdapterName(adapterName), VendorId(vendorId),
+			DeviceId(deviceId), DriverVersion(driverVersion) {}
+
+		//code red does not report the driver version, so it is 0 if we get identity from adapter
+		static auto from(
+			const std::shared_ptr<GpuDisplayAdapter>& adapter,
+			const APIVersion api) -> PipelineCacheIdentity;
+	};
+
+	//the backend owns the native pipeline cache(ID3D12PipelineLibrary, VkPipelineCache)
+	//the file only sees the opaque bytes of it
+	class PipelineCacheBackend {
+	public:
+		PipelineCacheBackend() = default;
+
+		virtual ~PipelineCacheBackend() = default;
+
+		//the data is validated by file, but it may still be rejected by driver
+		//return false if the backend can not use the data
+		virtual auto deserialize(const std::vector<Byte>& data) -> bool = 0;
+
+		virtual auto serialize() const -> std::vector<Byte> = 0;
+	};
+
+	//the backend that only keeps the bytes, it is used when the native cache is not available
+	//and it is used to test the file without a device
+	class MemoryPipelineCacheBackend final : public PipelineCacheBackend {
+	public:
+		MemoryPipelineCacheBackend() = default;
+
+		auto deserialize(const std::vector<Byte>& data) -> bool override;
+
+		auto serialize() const -> std::vector<Byte> override;
+
+		void setData(const std::vector<Byte>& data) { mData = data; }
+
+		auto data() const noexcept -> const std::vector<Byte>& { return mData; }
+	private:
+		std::vector<Byte> mData;
+	};
+
+	//the backend that feeds the data to the native pipeline cache of device
+	//the driver checks the data again, if it rejects the data we start with an empty native cache
+	//code red creates the native pipelines itself and does not accept a native cache yet
+	//so the pipelines created by code red do not use it, the native pipelines we create can use nativeXXX()
+	class DevicePipelineCacheBackend final : public PipelineCacheBackend {
+	public:
+		explicit DevicePipelineCacheBackend(
+			const std::shared_ptr<GpuLogicalDevice>& device);
+
+		~DevicePipelineCacheBackend();
+
+		auto deserialize(const std::vector<Byte>& data) -> bool override;
+
+		auto serialize() const -> std::vector<Byte> override;
+
+#ifdef __ENABLE__DIRECTX12__
+		auto nativeDirectX12() const noexcept -> ID3D12PipelineLibrary* { return mDirectX12Library.Get(); }
+#endif
+
+#ifdef __ENABLE__VULKAN__
+		auto nativeVulkan() const noexcept -> vk::PipelineCache { return mVulkanCache; }
+#endif
+	private:
+		//return false if the driver rejects the data
+		auto create(const std::vector<Byte>& data) -> bool;
+
+		void destroy();
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+
+		//the pipeline library reads the data it is created from, so we keep it alive with the library
+		std::vector<Byte> mData;
+
+#ifdef __ENABLE__DIRECTX12__
+		Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> mDirectX12Library;
+#endif
+
+#ifdef __ENABLE__VULKAN__
+		vk::PipelineCache mVulkanCache;
+#endif
+	};
+
+	/*
+	 * the layout of pipeline cache file:
+	 * [magic][version][api][vendor id][device id][driver version][adapter hash][data size][data hash][data]
+	 * if any value of header is not matched with the identity, the file is ignored
+	 */
+	class PipelineCacheFile final : public Noncopyable {
+	public:
+		explicit PipelineCacheFile(
+			const std::string& fileName,
+			const PipelineCacheIdentity& identity,
+			const std::shared_ptr<PipelineCacheBackend>& backend);
+
+		//load the file into backend, call it after the device is created
+		//return false if the file is not existed, out of date or broken
+		auto load() -> bool;
+
+		//write the data of backend to file, call it on shutdown
+		auto save() const -> bool;
+
+		auto backend() const noexcept -> std::shared_ptr<PipelineCacheBackend> { return mBackend; }
+
+		auto identity() const noexcept -> const PipelineCacheIdentity& { return mIdentity; }
+
+		auto fileName() const noexcept -> const std::string& { return mFileName; }
+
+		static constexpr UInt32 magic = 0x43505243; //"CRPC"
+		static constexpr UInt32 version = 1;
+	private:
+		struct Header {
+			UInt32 Magic = 0;
+			UInt32 Version = 0;
+			UInt32 API = 0;
+			UInt32 Reserved = 0;
+
+			UInt64 VendorId = 0;
+			UInt64 DeviceId = 0;
+			UInt64 DriverVersion = 0;
+			UInt64 AdapterHash = 0;
+
+			UInt64 DataSize = 0;
+			UInt64 DataHash = 0;
+		};
+
+		auto header(const std::vector<Byte>& data) const -> Header;
+
+		static auto hash(const Byte* data, const size_t size) noexcept -> UInt64;
+	private:
+		std::shared_ptr<PipelineCacheBackend> mBackend;
+
+		PipelineCacheIdentity mIdentity;
+
+		std::string mFileName;
+	};
+
+}
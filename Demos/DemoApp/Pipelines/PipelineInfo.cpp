@@ -1,16 +1,38 @@
 #include "PipelineInfo.hpp"
 
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace CodeRed {
+
+	std::atomic<size_t> gDefaultStateCreations = 0;
+	
+}
+
+//the default states of a device, they are shared by all pipeline infos of the device
+//every state is created only when the first pipeline info without it updates state
+struct CodeRed::PipelineInfo::DefaultStates {
+	std::shared_ptr<GpuRasterizationState> RasterizationState;
+	std::shared_ptr<GpuInputAssemblyState> InputAssemblyState;
+	std::shared_ptr<GpuDepthStencilState> DepthStencilState;
+	std::shared_ptr<GpuBlendState> BlendState;
+	std::shared_ptr<GpuResourceLayout> ResourceLayout;
+	std::shared_ptr<GpuRenderPass> RenderPass;
+
+	std::mutex Mutex;
+};
+
 CodeRed::PipelineInfo::PipelineInfo(const std::shared_ptr<GpuLogicalDevice>& device)
 	: mDevice(device)
 {
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+	
 	mPipelineFactory = mDevice->createPipelineFactory();
-
-	mRasterizationState = mPipelineFactory->createRasterizationState();
-	mInputAssemblyState = mPipelineFactory->createInputAssemblyState({});
-	mDepthStencilState = mPipelineFactory->createDetphStencilState();
-	mBlendState = mPipelineFactory->createBlendState();
-	mResourceLayout = mDevice->createResourceLayout({}, {});
-	mRenderPass = mDevice->createRenderPass({ Attachment::RenderTarget(PixelFormat::BlueGreenRedAlpha8BitUnknown) });
 }
 
 void CodeRed::PipelineInfo::setRasterizationState(const std::shared_ptr<GpuRasterizationState>& state)
@@ -52,9 +74,39 @@ void CodeRed::PipelineInfo::setRenderPass(const std::shared_ptr<GpuRenderPass>&
 	mRenderPass = render_pass;
 }
 
+void CodeRed::PipelineInfo::setPipelineCache(const std::shared_ptr<PipelineCache>& cache)
+{
+	mPipelineCache = cache;
+}
+
+void CodeRed::PipelineInfo::setFramePacer(const std::shared_ptr<FramePacer>& pacer)
+{
+	mFramePacer = pacer;
+}
+
 void CodeRed::PipelineInfo::updateState()
 {
-	mGraphicsPipeline = mDevice->createGraphicsPipeline(
+	resolveDefaultStates();
+
+	//the pipeline we are creating asynchronously is out of date now
+	if (mPendingPipeline.valid()) mDiscardedPipelines.push_back(std::move(mPendingPipeline));
+	
+	if (mPipelineCache != nullptr) {
+		setGraphicsPipeline(mPipelineCache->pipeline(
+			mRenderPass,
+			mResourceLayout,
+			mInputAssemblyState,
+			mVertexShaderState,
+			mPixelShaderState,
+			mDepthStencilState,
+			mBlendState,
+			mRasterizationState
+		));
+
+		return;
+	}
+	
+	setGraphicsPipeline(mDevice->createGraphicsPipeline(
 		mRenderPass,
 		mResourceLayout,
 		mInputAssemblyState,
@@ -63,7 +115,87 @@ void CodeRed::PipelineInfo::updateState()
 		mDepthStencilState,
 		mBlendState,
 		mRasterizationState
-	);
+	));
+}
+
+void CodeRed::PipelineInfo::updateStateAsync()
+{
+	//the default states are resolved in this thread, so the worker only reads its copies
+	resolveDefaultStates();
+
+	//the older pipeline is out of date, the newest request wins
+	if (mPendingPipeline.valid()) mDiscardedPipelines.push_back(std::move(mPendingPipeline));
+
+	mPendingPipeline = std::async(std::launch::async,
+		[device = mDevice, cache = mPipelineCache,
+		renderPass = mRenderPass,
+		resourceLayout = mResourceLayout,
+		inputAssembly = mInputAssemblyState,
+		vertexShader = mVertexShaderState,
+		pixelShader = mPixelShaderState,
+		depthStencil = mDepthStencilState,
+		blend = mBlendState,
+		rasterization = mRasterizationState]()
+		{
+			if (cache != nullptr) {
+				return cache->pipeline(renderPass, resourceLayout, inputAssembly,
+					vertexShader, pixelShader, depthStencil, blend, rasterization);
+			}
+
+			return device->createGraphicsPipeline(renderPass, resourceLayout, inputAssembly,
+				vertexShader, pixelShader, depthStencil, blend, rasterization);
+		});
+}
+
+auto CodeRed::PipelineInfo::updatePendingState() -> bool
+{
+	const auto isReady = [](const PipelineFuture& future)
+	{
+		return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	};
+
+	//destroying a future of std::async waits the task, so we only remove the finished ones
+	mDiscardedPipelines.erase(
+		std::remove_if(mDiscardedPipelines.begin(), mDiscardedPipelines.end(), isReady),
+		mDiscardedPipelines.end());
+
+	releaseRetiredPipelines();
+
+	if (!mPendingPipeline.valid() || !isReady(mPendingPipeline)) return false;
+
+	setGraphicsPipeline(mPendingPipeline.get());
+
+	return true;
+}
+
+void CodeRed::PipelineInfo::setGraphicsPipeline(const std::shared_ptr<GpuGraphicsPipeline>& pipeline)
+{
+	//the frame we are recording signals frameCount() + 1 when it ends
+	//so the old pipeline is not used after the fence completes this value
+	if (mGraphicsPipeline != nullptr && mGraphicsPipeline != pipeline) {
+		mRetiredPipelines.push_back({ mGraphicsPipeline,
+			mFramePacer == nullptr ? 0 : mFramePacer->frameCount() + 1 });
+	}
+
+	mGraphicsPipeline = pipeline;
+
+	releaseRetiredPipelines();
+}
+
+void CodeRed::PipelineInfo::releaseRetiredPipelines()
+{
+	//without frame pacer we do not know which frames are finished
+	//we assume the pipeline is replaced at most once a frame
+	if (mFramePacer == nullptr) {
+		while (mRetiredPipelines.size() > FramePacer::maxFramesInFlight) mRetiredPipelines.pop_front();
+
+		return;
+	}
+
+	const auto completedValue = mFramePacer->fence()->completedValue();
+
+	while (!mRetiredPipelines.empty() && mRetiredPipelines.front().second <= completedValue)
+		mRetiredPipelines.pop_front();
 }
 
 auto CodeRed::PipelineInfo::rasterizationState() const noexcept
@@ -113,3 +245,69 @@ auto CodeRed::PipelineInfo::renderPass() const noexcept
 {
 	return mRenderPass;
 }
+
+auto CodeRed::PipelineInfo::defaultStateCreations() noexcept -> size_t
+{
+	return gDefaultStateCreations;
+}
+
+auto CodeRed::PipelineInfo::defaultStates(const std::shared_ptr<GpuLogicalDevice>& device)
+	-> std::shared_ptr<DefaultStates>
+{
+	//we only hold weak pointers, so the default states are destroyed with the last pipeline info
+	//that used them, and never outlive their device
+	static std::unordered_map<GpuLogicalDevice*, std::weak_ptr<DefaultStates>> devices;
+	static std::mutex mutex;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto states = devices[device.get()].lock();
+
+	if (states == nullptr) {
+		states = std::make_shared<DefaultStates>();
+
+		devices[device.get()] = states;
+	}
+
+	return states;
+}
+
+void CodeRed::PipelineInfo::resolveDefaultStates()
+{
+	if (mRasterizationState != nullptr && mInputAssemblyState != nullptr &&
+		mDepthStencilState != nullptr && mBlendState != nullptr &&
+		mResourceLayout != nullptr && mRenderPass != nullptr)
+		return;
+
+	if (mDefaultStates == nullptr) mDefaultStates = defaultStates(mDevice);
+
+	auto& defaults = *mDefaultStates;
+
+	std::lock_guard<std::mutex> lock(defaults.Mutex);
+
+	const auto resolve = [](auto& state, auto& defaultState, const auto& create)
+	{
+		if (state != nullptr) return;
+
+		if (defaultState == nullptr) {
+			defaultState = create();
+
+			++gDefaultStateCreations;
+		}
+
+		state = defaultState;
+	};
+
+	resolve(mRasterizationState, defaults.RasterizationState,
+		[&]() { return mPipelineFactory->createRasterizationState(); });
+	resolve(mInputAssemblyState, defaults.InputAssemblyState,
+		[&]() { return mPipelineFactory->createInputAssemblyState({}); });
+	resolve(mDepthStencilState, defaults.DepthStencilState,
+		[&]() { return mPipelineFactory->createDetphStencilState(); });
+	resolve(mBlendState, defaults.BlendState,
+		[&]() { return mPipelineFactory->createBlendState(); });
+	resolve(mResourceLayout, defaults.ResourceLayout,
+		[&]() { return mDevice->createResourceLayout({}, {}); });
+	resolve(mRenderPass, defaults.RenderPass,
+		[&]() { return mDevice->createRenderPass({ Attachment::RenderTarget(PixelFormat::BlueGreenRedAlpha8BitUnknown) }); });
+}
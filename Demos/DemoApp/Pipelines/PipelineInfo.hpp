@@ -1,11 +1,18 @@
 #pragma once
 
-#include <CodeRed/Core/CodeRedGraphics.hpp>
+#include "PipelineCache.hpp"
+
+#include "../Resources/FramePacer.hpp"
+
+#include <future>
+#include <deque>
 
 namespace CodeRed {
 
 	class PipelineInfo final : Noncopyable {
 	public:
+		//the states are not created when we create pipeline info
+		//if a state is not set when we update state, we will use the default state of device
 		explicit PipelineInfo(
 			const std::shared_ptr<GpuLogicalDevice>& device);
 
@@ -33,8 +40,29 @@ namespace CodeRed {
 		void setRenderPass(
 			const std::shared_ptr<GpuRenderPass>& render_pass);
 		
+		//if the pipeline info has a pipeline cache, the pipeline is got from cache
+		//so the combination of states we used before will not create pipeline again
+		void setPipelineCache(
+			const std::shared_ptr<PipelineCache>& cache);
+
+		//the replaced pipelines are kept until the frames in flight that may use them are finished
+		//without frame pacer, we keep the last FramePacer::maxFramesInFlight replaced pipelines
+		void setFramePacer(
+			const std::shared_ptr<FramePacer>& pacer);
+		
 		void updateState();
 
+		//create the pipeline on a worker thread, graphicsPipeline() keeps the old pipeline
+		//until updatePendingState() finds the new one is ready
+		//if there is no old pipeline, graphicsPipeline() is nullptr before the new one is ready
+		void updateStateAsync();
+
+		//swap the pipeline created by updateStateAsync() in if it is ready
+		//call it at a frame boundary, return true if the pipeline is changed
+		auto updatePendingState() -> bool;
+
+		auto isPending() const noexcept -> bool { return mPendingPipeline.valid(); }
+
 		auto rasterizationState() const noexcept -> std::shared_ptr<GpuRasterizationState>;
 
 		auto inputAssemblyState() const noexcept -> std::shared_ptr<GpuInputAssemblyState>;
@@ -54,6 +82,29 @@ namespace CodeRed {
 		auto graphicsPipeline() const noexcept -> std::shared_ptr<GpuGraphicsPipeline> { return mGraphicsPipeline; }
 
 		auto pipelineFactory() const noexcept -> std::shared_ptr<GpuPipelineFactory> { return mPipelineFactory; }
+
+		auto pipelineCache() const noexcept -> std::shared_ptr<PipelineCache> { return mPipelineCache; }
+
+		auto framePacer() const noexcept -> std::shared_ptr<FramePacer> { return mFramePacer; }
+
+		//the replaced pipelines that frames in flight may still use
+		auto retiredPipelines() const noexcept -> size_t { return mRetiredPipelines.size(); }
+
+		//the number of default states we created in this process
+		static auto defaultStateCreations() noexcept -> size_t;
+	private:
+		struct DefaultStates;
+
+		static auto defaultStates(const std::shared_ptr<GpuLogicalDevice>& device)
+			-> std::shared_ptr<DefaultStates>;
+
+		void resolveDefaultStates();
+
+		void setGraphicsPipeline(const std::shared_ptr<GpuGraphicsPipeline>& pipeline);
+
+		void releaseRetiredPipelines();
+
+		using PipelineFuture = std::future<std::shared_ptr<GpuGraphicsPipeline>>;
 	private:
 		std::shared_ptr<GpuRasterizationState> mRasterizationState;
 		std::shared_ptr<GpuInputAssemblyState> mInputAssemblyState;
@@ -65,7 +116,19 @@ namespace CodeRed {
 		std::shared_ptr<GpuRenderPass> mRenderPass;
 		
 		std::shared_ptr<GpuGraphicsPipeline> mGraphicsPipeline;
+
+		//the frames in flight may still use the old pipelines, so we keep them with the fence value
+		//of the last frame that may use them, they are released when the fence completes the value
+		std::deque<std::pair<std::shared_ptr<GpuGraphicsPipeline>, UInt64>> mRetiredPipelines;
 		std::shared_ptr<GpuPipelineFactory> mPipelineFactory;
+		std::shared_ptr<PipelineCache> mPipelineCache;
+		std::shared_ptr<FramePacer> mFramePacer;
+		std::shared_ptr<DefaultStates> mDefaultStates;
+
+		//the newest pipeline that is creating and the older ones that we do not need
+		//we can not cancel them, so we keep them until they are finished
+		PipelineFuture mPendingPipeline;
+		std::vector<PipelineFuture> mDiscardedPipelines;
 
 		std::shared_ptr<GpuLogicalDevice> mDevice;
 	};
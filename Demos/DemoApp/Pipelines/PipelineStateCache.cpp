@@ -0,0 +1,19 @@
+#include "PipelineStateCache.hpp"
+
+CodeRed::PipelineStateCache::PipelineStateCache(const std::shared_ptr<GpuLogicalDevice>& device) :
+	mDevice(device)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	mPipelineFactory = mDevice->createPipelineFactory();
+}
+
+auto CodeRed::PipelineStateCache::size() const noexcept -> size_t
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	return mRasterizationStates.size() + mDepthStencilStates.size() + mBlendStates.size();
+}
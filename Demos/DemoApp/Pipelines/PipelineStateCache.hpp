@@ -0,0 +1,114 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include <unordered_map>
+#include <type_traits>
+#include <cstring>
+#include <mutex>
+
+namespace CodeRed {
+
+	//intern the pipeline states by the arguments we create them with
+	//the pipeline cache keys the pipelines by the identity of states, so a state that is created again
+	//with the same arguments(for example, a rasterization state toggled back) would always miss it
+	//the states from here are the same object for the same arguments, so toggling back hits the pipeline cache
+	//the arguments should be enums, bools or numbers, the states with other arguments can not be described
+	//the default arguments are not a part of key, so always create a state with the same form of arguments
+	class PipelineStateCache final : public Noncopyable {
+	public:
+		explicit PipelineStateCache(
+			const std::shared_ptr<GpuLogicalDevice>& device);
+
+		template<typename... Arguments>
+		auto rasterizationState(const Arguments&... arguments) -> std::shared_ptr<GpuRasterizationState>;
+
+		template<typename... Arguments>
+		auto depthStencilState(const Arguments&... arguments) -> std::shared_ptr<GpuDepthStencilState>;
+
+		template<typename... Arguments>
+		auto blendState(const Arguments&... arguments) -> std::shared_ptr<GpuBlendState>;
+
+		auto size() const noexcept -> size_t;
+	private:
+		template<typename State, typename Create, typename... Arguments>
+		auto state(
+			std::unordered_map<std::string, std::shared_ptr<State>>& states,
+			const Create& create,
+			const Arguments&... arguments)
+			-> std::shared_ptr<State>;
+
+		template<typename T>
+		static void describe(std::string& key, const T& value);
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+		std::shared_ptr<GpuPipelineFactory> mPipelineFactory;
+
+		std::unordered_map<std::string, std::shared_ptr<GpuRasterizationState>> mRasterizationStates;
+		std::unordered_map<std::string, std::shared_ptr<GpuDepthStencilState>> mDepthStencilStates;
+		std::unordered_map<std::string, std::shared_ptr<GpuBlendState>> mBlendStates;
+
+		mutable std::mutex mMutex;
+	};
+
+	template <typename ... Arguments>
+	auto PipelineStateCache::rasterizationState(const Arguments&... arguments) -> std::shared_ptr<GpuRasterizationState>
+	{
+		return state(mRasterizationStates,
+			[&]() { return mPipelineFactory->createRasterizationState(arguments...); }, arguments...);
+	}
+
+	template <typename ... Arguments>
+	auto PipelineStateCache::depthStencilState(const Arguments&... arguments) -> std::shared_ptr<GpuDepthStencilState>
+	{
+		return state(mDepthStencilStates,
+			[&]() { return mPipelineFactory->createDetphStencilState(arguments...); }, arguments...);
+	}
+
+	template <typename ... Arguments>
+	auto PipelineStateCache::blendState(const Arguments&... arguments) -> std::shared_ptr<GpuBlendState>
+	{
+		return state(mBlendStates,
+			[&]() { return mPipelineFactory->createBlendState(arguments...); }, arguments...);
+	}
+
+	template <typename State, typename Create, typename ... Arguments>
+	auto PipelineStateCache::state(
+		std::unordered_map<std::string, std::shared_ptr<State>>& states,
+		const Create& create,
+		const Arguments&... arguments)
+		-> std::shared_ptr<State>
+	{
+		std::string key;
+
+		(describe(key, arguments), ...);
+
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		auto& cached = states[key];
+
+		if (cached == nullptr) cached = create();
+
+		return cached;
+	}
+
+	template <typename T>
+	void PipelineStateCache::describe(std::string& key, const T& value)
+	{
+		static_assert(std::is_enum_v<T> || std::is_arithmetic_v<T>,
+			"the pipeline state cache only describes the states created with enums, bools and numbers.");
+
+		if constexpr (std::is_floating_point_v<T>) {
+			//the float is described by its bits, so the equal values always have the same key
+			const auto number = static_cast<double>(value);
+
+			UInt64 bits = 0;
+
+			std::memcpy(&bits, &number, sizeof(bits));
+
+			key += std::to_string(bits) + ";";
+		}
+		else key += std::to_string(static_cast<long long>(value)) + ";";
+	}
+
+}
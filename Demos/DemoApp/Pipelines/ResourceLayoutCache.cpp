@@ -0,0 +1,79 @@
+#include "ResourceLayoutCache.hpp"
+
+#include <algorithm>
+
+CodeRed::ResourceLayoutCache::ResourceLayoutCache(const std::shared_ptr<GpuLogicalDevice>& device) :
+	mDevice(device)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+}
+
+auto CodeRed::ResourceLayoutCache::layout(
+	const ShaderReflection& reflection,
+	const std::vector<std::shared_ptr<GpuSampler>>& samplers)
+	-> std::shared_ptr<GpuResourceLayout>
+{
+	const auto samplerBindings = reflection.samplerBindings();
+
+	CODE_RED_DEBUG_THROW_IF(
+		samplers.size() < samplerBindings.size(),
+		InvalidException<size_t>({ "size of samplers" })
+	);
+
+	//the key of layout is the elements, samplers and constant 32bits
+	//the samplers are different objects, so we use their address
+	std::string key;
+
+	for (const auto& binding : reflection.Bindings) {
+		key += std::to_string(static_cast<UInt32>(binding.Type)) + ":" +
+			std::to_string(binding.Binding) + ":" +
+			std::to_string(binding.Space) + ";";
+	}
+
+	for (size_t index = 0; index < samplerBindings.size(); index++)
+		key += std::to_string(reinterpret_cast<size_t>(samplers[index].get())) + ";";
+
+	key += std::to_string(reflection.Constant32Bits);
+
+	const auto it = mLayouts.find(key);
+
+	if (it != mLayouts.end()) return it->second;
+
+	std::vector<SamplerLayoutElement> samplerElements;
+
+	for (size_t index = 0; index < samplerBindings.size(); index++) {
+		samplerElements.push_back(SamplerLayoutElement(
+			samplers[index],
+			samplerBindings[index].Binding,
+			samplerBindings[index].Space));
+	}
+
+	std::shared_ptr<GpuResourceLayout> resourceLayout;
+
+	if (reflection.Constant32Bits != 0) {
+		//the constant 32bits use the binding after the last binding in space 0
+		size_t binding = 0;
+
+		for (const auto& element : reflection.Bindings)
+			if (element.Space == 0) binding = std::max(binding, element.Binding + 1);
+
+		resourceLayout = mDevice->createResourceLayout(
+			reflection.resourceElements(),
+			samplerElements,
+			Constant32Bits(reflection.Constant32Bits, binding, 0)
+		);
+	}
+	else {
+		resourceLayout = mDevice->createResourceLayout(
+			reflection.resourceElements(),
+			samplerElements
+		);
+	}
+
+	mLayouts.insert({ key, resourceLayout });
+
+	return resourceLayout;
+}
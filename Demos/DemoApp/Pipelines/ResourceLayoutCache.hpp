@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../Shaders/ShaderReflection.hpp"
+
+#include <unordered_map>
+
+namespace CodeRed {
+
+	class ResourceLayoutCache final : public Noncopyable {
+	public:
+		explicit ResourceLayoutCache(
+			const std::shared_ptr<GpuLogicalDevice>& device);
+
+		//build the resource layout from the reflection of shaders
+		//the samplers are bound to the sampler bindings in order of binding
+		//if there is a layout with same elements, we return it instead of creating a new one
+		auto layout(
+			const ShaderReflection& reflection,
+			const std::vector<std::shared_ptr<GpuSampler>>& samplers = {})
+			-> std::shared_ptr<GpuResourceLayout>;
+
+		auto size() const noexcept -> size_t { return mLayouts.size(); }
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+
+		std::unordered_map<std::string, std::shared_ptr<GpuResourceLayout>> mLayouts;
+	};
+	
+}
@@ -0,0 +1,123 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+//the counters are constant initialized, so they are ready before any static object allocates
+static std::atomic<size_t> allocationCount = 0;
+static std::atomic<size_t> allocationBytes = 0;
+
+void CodeRed::AllocationCounter::countAllocation(const size_t size) noexcept
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+	mThreadAllocations++;
+	mThreadBytes = mThreadBytes + size;
+}
+
+auto CodeRed::AllocationCounter::allocations() noexcept -> size_t
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+auto CodeRed::AllocationCounter::bytes() noexcept -> size_t
+{
+	return allocationBytes.load(std::memory_order_relaxed);
+}
+
+static auto allocate(const size_t size) noexcept -> void*
+{
+	CodeRed::AllocationCounter::countAllocation(size);
+
+	//malloc(0) may return nullptr, but operator new should return a unique pointer
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+static auto allocateAligned(const size_t size, const std::align_val_t alignment) noexcept -> void*
+{
+	CodeRed::AllocationCounter::countAllocation(size);
+
+	const auto align = static_cast<size_t>(alignment);
+
+#ifdef _WIN32
+	return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+	//the size of aligned_alloc should be a multiple of alignment
+	return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+#endif
+}
+
+static void deallocateAligned(void* memory) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+
+//the default versions of them call each other in the standard library
+//but we replace all of them, so the memory is never freed by an allocator that did not allocate it
+void* operator new(const size_t size)
+{
+	if (const auto memory = allocate(size)) return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size)
+{
+	if (const auto memory = allocate(size)) return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment)
+{
+	if (const auto memory = allocateAligned(size, alignment)) return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size, const std::align_val_t alignment)
+{
+	if (const auto memory = allocateAligned(size, alignment)) return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, const size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, const size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+void operator delete(void* memory, const std::align_val_t) noexcept { deallocateAligned(memory); }
+void operator delete[](void* memory, const std::align_val_t) noexcept { deallocateAligned(memory); }
+void operator delete(void* memory, const size_t, const std::align_val_t) noexcept { deallocateAligned(memory); }
+void operator delete[](void* memory, const size_t, const std::align_val_t) noexcept { deallocateAligned(memory); }
+void operator delete(void* memory, const std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(memory); }
+void operator delete[](void* memory, const std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(memory); }
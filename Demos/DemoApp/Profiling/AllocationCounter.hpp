@@ -0,0 +1,35 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+namespace CodeRed {
+
+	/*
+	 * count the heap allocations of program
+	 * AllocationCounter.cpp replaces the global operator new and operator delete
+	 * the counters only increase, so we use the difference of them to find the allocations of a frame
+	 * the profile zones use the counter of their thread to find the allocations in the zone
+	 */
+	class AllocationCounter final {
+	public:
+		AllocationCounter() = delete;
+
+		static auto allocations() noexcept -> size_t;
+
+		static auto bytes() noexcept -> size_t;
+
+		//the allocations of the calling thread, they are inline so a profile zone only reads a thread local
+		static auto threadAllocations() noexcept -> size_t { return mThreadAllocations; }
+
+		static auto threadBytes() noexcept -> size_t { return mThreadBytes; }
+
+		//count an allocation of the calling thread, the replaced operator new calls it
+		static void countAllocation(const size_t size) noexcept;
+	private:
+		//the counters of thread are constant initialized, so reading them does not need a guard
+		//and they are ready before we allocate in the thread
+		inline static thread_local size_t mThreadAllocations = 0;
+		inline static thread_local size_t mThreadBytes = 0;
+	};
+	
+}
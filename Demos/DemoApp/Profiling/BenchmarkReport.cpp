@@ -0,0 +1,269 @@
+#include "BenchmarkReport.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <fstream>
+#include <limits>
+#include <iterator>
+#include <cstdlib>
+
+static auto endsWith(const std::string& text, const std::string& suffix) -> bool
+{
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static auto escapeJson(const std::string& text) -> std::string
+{
+	std::string result;
+
+	for (const auto character : text) {
+		if (character == '"' || character == '\\') result.push_back('\\');
+
+		result.push_back(character);
+	}
+
+	return result;
+}
+
+//find the quote that ends the string, the escaped quotes are skipped
+static auto findQuote(const std::string& text, size_t position) -> size_t
+{
+	while (position < text.size() && text[position] != '"')
+		position = position + (text[position] == '\\' ? 2 : 1);
+
+	return position < text.size() ? position : std::string::npos;
+}
+
+static auto unescapeJson(const std::string& text) -> std::string
+{
+	std::string result;
+
+	for (size_t index = 0; index < text.size(); index++) {
+		if (text[index] == '\\' && index + 1 < text.size()) index++;
+
+		result.push_back(text[index]);
+	}
+
+	return result;
+}
+
+auto Demo::BenchmarkReport::from(const std::string& name, const std::vector<FrameRecord>& records) -> BenchmarkReport
+{
+	BenchmarkReport report(name, records.size());
+
+	const auto addStats = [&](const std::string& phase, const std::vector<float>& values)
+	{
+		const auto stats = FrameStats::from(values);
+
+		report.add(phase + ".mean", stats.Average);
+		report.add(phase + ".p50", stats.P50);
+		report.add(phase + ".p95", stats.P95);
+		report.add(phase + ".p99", stats.P99);
+		report.add(phase + ".max", stats.Max);
+	};
+
+	std::vector<float> values(records.size());
+
+	const auto phase = [&](const std::string& phaseName, float FrameRecord::* member)
+	{
+		for (size_t index = 0; index < records.size(); index++) values[index] = records[index].*member;
+
+		addStats(phaseName, values);
+	};
+
+	phase("wait", &FrameRecord::Wait);
+	phase("simulate", &FrameRecord::Simulate);
+	phase("update", &FrameRecord::Update);
+	phase("render", &FrameRecord::Render);
+	phase("frame", &FrameRecord::Frame);
+
+	for (size_t index = 0; index < records.size(); index++)
+		values[index] = static_cast<float>(records[index].Allocations);
+
+	const auto allocations = FrameStats::from(values);
+
+	report.add("allocations.mean", allocations.Average);
+	report.add("allocations.max", allocations.Max);
+
+	return report;
+}
+
+auto Demo::BenchmarkReport::read(const std::string& fileName) -> BenchmarkReport
+{
+	std::ifstream stream(fileName);
+
+	CODE_RED_DEBUG_THROW_IF(
+		stream.is_open() == false,
+		CodeRed::Exception(CodeRed::DebugReport::makeError("can not open the file of benchmark baseline."))
+	);
+
+	return endsWith(fileName, ".csv") ? readCsv(stream) : readJson(stream);
+}
+
+void Demo::BenchmarkReport::write(const std::string& fileName) const
+{
+	std::ofstream stream(fileName);
+
+	CODE_RED_DEBUG_THROW_IF(
+		stream.is_open() == false,
+		CodeRed::Exception(CodeRed::DebugReport::makeError("can not open the file to write benchmark."))
+	);
+
+	//the baseline is read from the file we write, so we write the values without losing precision
+	stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+	if (endsWith(fileName, ".csv")) writeCsv(stream); else writeJson(stream);
+}
+
+void Demo::BenchmarkReport::add(const std::string& name, const double value)
+{
+	const auto metric = std::find_if(mMetrics.begin(), mMetrics.end(),
+		[&](const BenchmarkMetric& metric) { return metric.Name == name; });
+
+	if (metric != mMetrics.end()) metric->Value = value;
+	else mMetrics.push_back(BenchmarkMetric(name, value));
+}
+
+auto Demo::BenchmarkReport::value(const std::string& name) const -> std::optional<double>
+{
+	for (const auto& metric : mMetrics) {
+		if (metric.Name == name) return metric.Value;
+	}
+
+	return std::nullopt;
+}
+
+auto Demo::BenchmarkReport::compare(const BenchmarkReport& baseline, const double tolerance) const
+	-> std::vector<BenchmarkRegression>
+{
+	std::vector<BenchmarkRegression> regressions;
+
+	//the metrics that are not in the baseline are new, so they can not regress
+	for (const auto& metric : baseline.metrics()) {
+		const auto isTime = metric.Name.compare(0, 12, "allocations.") != 0;
+
+		if (isTime && endsWith(metric.Name, ".max")) continue;
+
+		//the wait depends on the gpu, it is only reported
+		if (metric.Name.compare(0, 5, "wait.") == 0) continue;
+
+		const auto current = value(metric.Name);
+
+		//a phase that takes a few microseconds doubles with noise, so the times also need to be
+		//worse than the baseline by an absolute floor
+		const auto limit = isTime ?
+			std::max(metric.Value * (1.0 + tolerance), metric.Value + timeFloor) :
+			metric.Value * (1.0 + tolerance);
+
+		if (current.has_value() && current.value() > limit)
+			regressions.push_back(BenchmarkRegression(metric.Name, metric.Value, current.value()));
+	}
+
+	return regressions;
+}
+
+void Demo::BenchmarkReport::writeJson(std::ostream& stream) const
+{
+	stream << "{\n";
+	stream << "\t\"name\": \"" << escapeJson(mName) << "\",\n";
+	stream << "\t\"frames\": " << mFrames << ",\n";
+	stream << "\t\"metrics\": {";
+
+	for (size_t index = 0; index < mMetrics.size(); index++) {
+		stream << (index == 0 ? "\n" : ",\n");
+		stream << "\t\t\"" << escapeJson(mMetrics[index].Name) << "\": " << mMetrics[index].Value;
+	}
+
+	stream << "\n\t}\n}\n";
+}
+
+void Demo::BenchmarkReport::writeCsv(std::ostream& stream) const
+{
+	//the name and frames are written as metrics, so the file is still two columns
+	stream << "metric,value\n";
+	stream << "name," << mName << "\n";
+	stream << "frames," << mFrames << "\n";
+
+	for (const auto& metric : mMetrics) stream << metric.Name << "," << metric.Value << "\n";
+}
+
+auto Demo::BenchmarkReport::readJson(std::istream& stream) -> BenchmarkReport
+{
+	const auto text = std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+	BenchmarkReport report;
+
+	//we only read the files we write, so we find the pairs of "key": value and do not parse the structure
+	size_t position = 0;
+
+	while ((position = text.find('"', position)) != std::string::npos) {
+		const auto end = findQuote(text, position + 1);
+
+		if (end == std::string::npos) break;
+
+		const auto key = unescapeJson(text.substr(position + 1, end - position - 1));
+
+		position = text.find_first_not_of(" \t\r\n", end + 1);
+
+		if (position == std::string::npos || text[position] != ':') { position = end + 1; continue; }
+
+		position = text.find_first_not_of(" \t\r\n", position + 1);
+
+		if (position == std::string::npos) break;
+
+		if (text[position] == '"') {
+			const auto valueEnd = findQuote(text, position + 1);
+
+			if (key == "name") report.mName = unescapeJson(text.substr(position + 1, valueEnd - position - 1));
+
+			position = valueEnd == std::string::npos ? valueEnd : valueEnd + 1;
+
+			if (position == std::string::npos) break;
+
+			continue;
+		}
+
+		char* valueEnd = nullptr;
+
+		const auto value = std::strtod(text.c_str() + position, &valueEnd);
+
+		if (valueEnd != text.c_str() + position) {
+			if (key == "frames") report.mFrames = static_cast<size_t>(value);
+			else report.add(key, value);
+		}
+
+		position = static_cast<size_t>(valueEnd - text.c_str()) + (valueEnd == text.c_str() + position ? 1 : 0);
+	}
+
+	return report;
+}
+
+auto Demo::BenchmarkReport::readCsv(std::istream& stream) -> BenchmarkReport
+{
+	BenchmarkReport report;
+
+	std::string line;
+
+	while (std::getline(stream, line)) {
+		const auto comma = line.find(',');
+
+		if (comma == std::string::npos) continue;
+
+		const auto key = line.substr(0, comma);
+		const auto text = line.substr(comma + 1);
+
+		if (key == "metric") continue;
+		if (key == "name") { report.mName = text; continue; }
+
+		char* valueEnd = nullptr;
+
+		const auto value = std::strtod(text.c_str(), &valueEnd);
+
+		if (valueEnd == text.c_str()) continue;
+
+		if (key == "frames") report.mFrames = static_cast<size_t>(value);
+		else report.add(key, value);
+	}
+
+	return report;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../DemoApp.hpp"
+
+#include <optional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Demo {
+
+	struct BenchmarkMetric {
+		std::string Name;
+
+		double Value = 0;
+
+		BenchmarkMetric() = default;
+
+		BenchmarkMetric(
+			const std::string& name,
+			const double value) :
+			Name(name), Value(value) {}
+	};
+
+	//the metric is worse than the baseline more than the tolerance
+	struct BenchmarkRegression {
+		std::string Name;
+
+		double Baseline = 0;
+		double Current = 0;
+
+		BenchmarkRegression() = default;
+
+		BenchmarkRegression(
+			const std::string& name,
+			const double baseline,
+			const double current) :
+			Name(name), Baseline(baseline), Current(current) {}
+	};
+
+	/*
+	 * the machine-readable result of benchmark, the metrics are flat names like "update.p99"
+	 * the times are in milliseconds and the allocations are the heap allocations per frame
+	 * the report is written to ".json" or ".csv" file, and both of them can be read as baseline
+	 * all metrics are lower-is-better, so the comparison only needs the tolerance
+	 */
+	class BenchmarkReport {
+	public:
+		BenchmarkReport() = default;
+
+		BenchmarkReport(
+			const std::string& name,
+			const size_t frames) :
+			mName(name), mFrames(frames) {}
+
+		static auto from(const std::string& name, const std::vector<FrameRecord>& records) -> BenchmarkReport;
+
+		static auto read(const std::string& fileName) -> BenchmarkReport;
+
+		void write(const std::string& fileName) const;
+
+		void add(const std::string& name, const double value);
+
+		auto value(const std::string& name) const -> std::optional<double>;
+
+		//the metric regresses if current > baseline * (1 + tolerance)
+		//the times also need current > baseline + timeFloor, so the tiny phases do not fail with noise
+		//the max of times and the wait for gpu are too noisy to gate, so they are only reported
+		auto compare(const BenchmarkReport& baseline, const double tolerance) const
+			-> std::vector<BenchmarkRegression>;
+
+		auto name() const noexcept -> const std::string& { return mName; }
+
+		auto frames() const noexcept -> size_t { return mFrames; }
+
+		auto metrics() const noexcept -> const std::vector<BenchmarkMetric>& { return mMetrics; }
+
+		//the absolute change of time in milliseconds that we treat as noise
+		static constexpr double timeFloor = 0.05;
+	private:
+		void writeJson(std::ostream& stream) const;
+
+		void writeCsv(std::ostream& stream) const;
+
+		static auto readJson(std::istream& stream) -> BenchmarkReport;
+
+		static auto readCsv(std::istream& stream) -> BenchmarkReport;
+	private:
+		std::string mName;
+
+		size_t mFrames = 0;
+
+		std::vector<BenchmarkMetric> mMetrics;
+	};
+	
+}
@@ -0,0 +1,407 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <array>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define __PROFILER__TIME__STAMP__COUNTER__
+#endif
+
+namespace CodeRed {
+
+	struct ProfileThreadEvents {
+		std::array<ProfileEvent, Profiler::threadCapacity> Events;
+
+		std::atomic<size_t> Write = 0;
+		std::atomic<size_t> Read = 0;
+		std::atomic<size_t> Dropped = 0;
+
+		//the thread exited, the buffer is released after its events are collected
+		std::atomic<bool> Exited = false;
+
+		UInt32 Thread = 0;
+	};
+
+	struct ProfileZone {
+		std::string Name;
+
+		//the recent durations in milliseconds and allocations, they are ring buffers
+		//only the events that track allocations have allocation samples
+		std::vector<float> Samples;
+		std::vector<UInt64> AllocationSamples;
+
+		size_t Count = 0;
+		size_t AllocationCount = 0;
+	};
+
+	struct ProfilerContext {
+		//the threads and zones are only registered once, so we can lock them
+		std::mutex Mutex;
+
+		std::vector<std::shared_ptr<ProfileThreadEvents>> Threads;
+		std::vector<std::string> ZoneNames;
+
+		//the ids of threads are not reused, so the events of an exited thread are not mixed with a new one
+		UInt32 NextThread = 0;
+
+		//the dropped events of the threads that are released
+		size_t ReleasedDropped = 0;
+
+		//the collected data, they are only used by the thread that collects
+		std::vector<ProfileZone> Zones;
+		std::vector<ProfileEvent> Trace;
+
+		size_t TraceStart = 0;
+
+		//the temporary data of collect() and stats(), they are kept so we do not allocate in every frame
+		std::vector<std::shared_ptr<ProfileThreadEvents>> CollectThreads;
+		std::vector<size_t> CollectWrites;
+		std::vector<char> CollectExited;
+		std::vector<float> SortedSamples;
+
+		//the ticks and time when the profiler started, they convert the ticks to nanoseconds
+		UInt64 EpochTicks = Profiler::ticks();
+
+		std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+	};
+
+	static auto profilerContext() -> ProfilerContext&
+	{
+		static ProfilerContext context;
+
+		return context;
+	}
+
+	//the buffer of thread, it is constant initialized, so reading it in record() does not need a guard
+	static thread_local ProfileThreadEvents* gThreadEvents = nullptr;
+	static thread_local bool gThreadExited = false;
+
+	//the object of thread that marks its buffer exited when the thread exits
+	struct ProfileThreadExit {
+		std::shared_ptr<ProfileThreadEvents> Events;
+
+		~ProfileThreadExit()
+		{
+			Events->Exited.store(true, std::memory_order_release);
+
+			//the thread local objects destroyed after it do not record again
+			gThreadEvents = nullptr;
+			gThreadExited = true;
+		}
+	};
+
+	//the slow path of the first event of thread, the buffer is owned by profiler
+	//so the events are kept after the thread exits until we collect them
+	static auto registerThreadEvents() -> ProfileThreadEvents*
+	{
+		thread_local ProfileThreadExit exit;
+
+		auto& context = profilerContext();
+
+		std::lock_guard<std::mutex> lock(context.Mutex);
+
+		exit.Events = std::make_shared<ProfileThreadEvents>();
+		exit.Events->Thread = context.NextThread++;
+
+		context.Threads.push_back(exit.Events);
+
+		return gThreadEvents = exit.Events.get();
+	}
+	
+}
+
+auto CodeRed::Profiler::zone(const std::string& name) -> UInt32
+{
+	auto& context = profilerContext();
+
+	std::lock_guard<std::mutex> lock(context.Mutex);
+
+	const auto it = std::find(context.ZoneNames.begin(), context.ZoneNames.end(), name);
+
+	if (it != context.ZoneNames.end()) return static_cast<UInt32>(it - context.ZoneNames.begin());
+
+	context.ZoneNames.push_back(name);
+
+	return static_cast<UInt32>(context.ZoneNames.size() - 1);
+}
+
+void CodeRed::Profiler::registerThread()
+{
+	if (gThreadEvents == nullptr && !gThreadExited) registerThreadEvents();
+}
+
+auto CodeRed::Profiler::ticks() noexcept -> UInt64
+{
+#ifdef __PROFILER__TIME__STAMP__COUNTER__
+	return static_cast<UInt64>(__rdtsc());
+#else
+	return static_cast<UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void CodeRed::Profiler::record(const UInt32 zone, const UInt64 begin, const UInt64 end, const UInt64 allocations) noexcept
+{
+	auto eventsPointer = gThreadEvents;
+
+	if (eventsPointer == nullptr) {
+		if (gThreadExited) return;
+
+		eventsPointer = registerThreadEvents();
+	}
+
+	auto& events = *eventsPointer;
+
+	const auto write = events.Write.load(std::memory_order_relaxed);
+	const auto read = events.Read.load(std::memory_order_acquire);
+
+	//we do not overwrite the events that are not collected, the collecting thread may read them
+	if (write - read >= threadCapacity) {
+		events.Dropped.fetch_add(1, std::memory_order_relaxed);
+
+		return;
+	}
+
+	auto& event = events.Events[write & (threadCapacity - 1)];
+
+	event.Zone = zone;
+	event.Thread = events.Thread;
+	event.Begin = begin;
+	event.End = end;
+	event.Allocations = allocations;
+
+	events.Write.store(write + 1, std::memory_order_release);
+}
+
+void CodeRed::Profiler::collect()
+{
+	auto& context = profilerContext();
+	auto& threads = context.CollectThreads;
+	auto& writes = context.CollectWrites;
+	auto& exited = context.CollectExited;
+
+	{
+		std::lock_guard<std::mutex> lock(context.Mutex);
+
+		//the vectors keep their capacity, they only allocate when a new thread is registered
+		threads.assign(context.Threads.begin(), context.Threads.end());
+	}
+
+	//the zones of events we read are registered before the events are written
+	//so we read the write positions first, then the zones
+	//if a thread exited before we read its write position, we will read all its events
+	writes.clear();
+	exited.clear();
+
+	for (const auto& events : threads) {
+		exited.push_back(events->Exited.load(std::memory_order_acquire));
+		writes.push_back(events->Write.load(std::memory_order_acquire));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(context.Mutex);
+
+		while (context.Zones.size() < context.ZoneNames.size()) {
+			context.Zones.push_back(ProfileZone());
+			context.Zones.back().Name = context.ZoneNames[context.Zones.size() - 1];
+			context.Zones.back().Samples.reserve(zoneSamples);
+			context.Zones.back().AllocationSamples.reserve(zoneSamples);
+		}
+	}
+
+	if (context.Trace.capacity() < traceCapacity) context.Trace.reserve(traceCapacity);
+
+	//the ticks per nanosecond since the profiler started, the time stamp counter is invariant on modern CPUs
+	const auto elapsedTicks = static_cast<double>(ticks() - context.EpochTicks);
+	const auto elapsedTime = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - context.Epoch).count());
+	const auto ticksPerNanosecond = elapsedTime > 0 && elapsedTicks > 0 ? elapsedTicks / elapsedTime : 1.0;
+
+	const auto toNanoseconds = [&](const UInt64 value)
+	{
+		return value > context.EpochTicks ?
+			static_cast<UInt64>(static_cast<double>(value - context.EpochTicks) / ticksPerNanosecond) : 0;
+	};
+
+	for (size_t thread = 0; thread < threads.size(); thread++) {
+		const auto& events = threads[thread];
+		const auto read = events->Read.load(std::memory_order_relaxed);
+		const auto write = writes[thread];
+
+		for (auto index = read; index < write; index++) {
+			auto event = events->Events[index & (threadCapacity - 1)];
+
+			event.Begin = toNanoseconds(event.Begin);
+			event.End = toNanoseconds(event.End);
+			
+			auto& zone = context.Zones[event.Zone];
+
+			if (zone.Samples.size() < zoneSamples) zone.Samples.push_back(0);
+
+			zone.Samples[zone.Count % zoneSamples] = static_cast<float>(event.End - event.Begin) / 1000000.0f;
+			zone.Count++;
+
+			if (event.Allocations != untrackedAllocations) {
+				if (zone.AllocationSamples.size() < zoneSamples) zone.AllocationSamples.push_back(0);
+
+				zone.AllocationSamples[zone.AllocationCount % zoneSamples] = event.Allocations;
+				zone.AllocationCount++;
+			}
+
+			//the trace is a ring buffer too, we only export the recent events
+			if (context.Trace.size() < traceCapacity)
+				context.Trace.push_back(event);
+			else {
+				context.Trace[context.TraceStart] = event;
+				context.TraceStart = (context.TraceStart + 1) % traceCapacity;
+			}
+		}
+
+		events->Read.store(write, std::memory_order_release);
+	}
+
+	//the exited threads are drained, so we release their buffers
+	//the new threads are appended, so the threads we collected are still the first ones
+	{
+		std::lock_guard<std::mutex> lock(context.Mutex);
+
+		size_t alive = 0;
+
+		for (size_t index = 0; index < context.Threads.size(); index++) {
+			const auto& events = context.Threads[index];
+
+			if (index < threads.size() && exited[index]) {
+				context.ReleasedDropped = context.ReleasedDropped + events->Dropped.load(std::memory_order_relaxed);
+
+				continue;
+			}
+
+			context.Threads[alive++] = events;
+		}
+
+		context.Threads.resize(alive);
+	}
+
+	//the threads are not kept between collect(), so the buffers we released are freed now
+	threads.clear();
+}
+
+void CodeRed::Profiler::clear()
+{
+	auto& context = profilerContext();
+
+	collect();
+
+	context.Zones.clear();
+	context.Trace.clear();
+	context.TraceStart = 0;
+}
+
+auto CodeRed::Profiler::stats() -> std::vector<ProfileZoneStats>
+{
+	std::vector<ProfileZoneStats> zoneStats;
+
+	stats(zoneStats);
+
+	return zoneStats;
+}
+
+void CodeRed::Profiler::stats(std::vector<ProfileZoneStats>& stats)
+{
+	auto& context = profilerContext();
+	auto& samples = context.SortedSamples;
+
+	size_t count = 0;
+
+	//assign only reserves the size it needs, so the samples would grow in many small steps
+	if (samples.capacity() < zoneSamples) samples.reserve(zoneSamples);
+
+	for (const auto& zone : context.Zones) {
+		if (zone.Count == 0) continue;
+
+		samples.assign(zone.Samples.begin(), zone.Samples.end());
+
+		std::sort(samples.begin(), samples.end());
+
+		const auto percentile = [&](const double rank)
+		{
+			return static_cast<double>(samples[static_cast<size_t>(rank * static_cast<double>(samples.size() - 1) + 0.5)]);
+		};
+
+		UInt64 allocations = 0;
+
+		for (const auto sample : zone.AllocationSamples) allocations = allocations + sample;
+
+		//we reuse the stats in the vector, so the names do not allocate again
+		if (count == stats.size()) stats.push_back(ProfileZoneStats());
+
+		auto& zoneStats = stats[count++];
+
+		zoneStats.Name = zone.Name;
+		zoneStats.Count = zone.Count;
+		zoneStats.P50 = percentile(0.50);
+		zoneStats.P99 = percentile(0.99);
+		zoneStats.Max = samples.back();
+		zoneStats.TracksAllocations = !zone.AllocationSamples.empty();
+		zoneStats.Allocations = zoneStats.TracksAllocations ?
+			static_cast<double>(allocations) / static_cast<double>(zone.AllocationSamples.size()) : 0;
+	}
+
+	stats.resize(count);
+}
+
+void CodeRed::Profiler::exportChromeTrace(const std::string& fileName)
+{
+	auto& context = profilerContext();
+
+	std::ofstream stream(fileName);
+
+	CODE_RED_DEBUG_THROW_IF(
+		stream.is_open() == false,
+		Exception(DebugReport::makeError("can not open the file to export profile."))
+	);
+
+	stream << "{\"traceEvents\":[";
+
+	//the time of chrome trace is in microseconds
+	for (size_t index = 0; index < context.Trace.size(); index++) {
+		const auto& event = context.Trace[(context.TraceStart + index) % context.Trace.size()];
+
+		if (index != 0) stream << ",";
+
+		stream << "\n{\"name\":\"" << context.Zones[event.Zone].Name
+			<< "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.Thread
+			<< ",\"ts\":" << static_cast<double>(event.Begin) / 1000.0
+			<< ",\"dur\":" << static_cast<double>(event.End - event.Begin) / 1000.0;
+
+		if (event.Allocations != untrackedAllocations)
+			stream << ",\"args\":{\"allocations\":" << event.Allocations << "}";
+
+		stream << "}";
+	}
+
+	stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+auto CodeRed::Profiler::dropped() -> size_t
+{
+	auto& context = profilerContext();
+
+	std::lock_guard<std::mutex> lock(context.Mutex);
+
+	auto dropped = context.ReleasedDropped;
+
+	for (const auto& events : context.Threads) dropped = dropped + events->Dropped.load(std::memory_order_relaxed);
+
+	return dropped;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include "AllocationCounter.hpp"
+
+#include <string>
+#include <vector>
+
+//comment it to compile the profile zones out, the zones cost nothing without it
+#define __PROFILING__MODE__
+
+namespace CodeRed {
+
+	//the time is in ticks of Profiler::ticks() when it is recorded
+	//and in nanoseconds since the profiler started when it is collected
+	struct ProfileEvent {
+		UInt32 Zone = 0;
+		UInt32 Thread = 0;
+
+		UInt64 Begin = 0;
+		UInt64 End = 0;
+
+		//the heap allocations of the thread in the zone, the allocations of nested zones are included
+		//it is Profiler::untrackedAllocations if the zone does not track allocations
+		UInt64 Allocations = 0;
+
+		ProfileEvent() = default;
+	};
+
+	//the times are in milliseconds, the percentiles are computed from the recent samples of zone
+	struct ProfileZoneStats {
+		std::string Name;
+
+		size_t Count = 0;
+
+		double P50 = 0;
+		double P99 = 0;
+		double Max = 0;
+
+		//the average heap allocations per call of the recent samples
+		//only the zones of CODE_RED_PROFILE_ALLOCATION_ZONE track them
+		double Allocations = 0;
+
+		bool TracksAllocations = false;
+
+		ProfileZoneStats() = default;
+	};
+
+	/*
+	 * the profiler records the zones into the ring buffer of thread that runs them
+	 * the ring buffers are single producer and single consumer, so the zones do not lock
+	 * collect() moves the events of all threads to the profiler, call it once per frame
+	 * collect(), stats() and exportChromeTrace() should be called by the same thread
+	 */
+	class Profiler final {
+	public:
+		//return the id of zone, the zones with same name have same id
+		static auto zone(const std::string& name) -> UInt32;
+
+		//the first event of thread allocates its ring buffer, a thread that is started before the frame loop
+		//can call it at start, so its first zone does not allocate in the steady state
+		static void registerThread();
+
+		//the cheapest clock we have, the time stamp counter on x86 and steady clock on others
+		//the ticks are converted to nanoseconds when we collect the events
+		static auto ticks() noexcept -> UInt64;
+
+		static void record(const UInt32 zone, const UInt64 begin, const UInt64 end, const UInt64 allocations = untrackedAllocations) noexcept;
+
+		static void collect();
+
+		static void clear();
+
+		static auto stats() -> std::vector<ProfileZoneStats>;
+
+		//write the stats to the vector, the vector keeps its capacity, so we can call it in every frame without allocating
+		static void stats(std::vector<ProfileZoneStats>& stats);
+
+		//the events are written as complete events("ph" : "X") of chrome://tracing
+		static void exportChromeTrace(const std::string& fileName);
+
+		//the events that are dropped because the ring buffer of thread is full
+		static auto dropped() -> size_t;
+
+		//the events of a thread that can be recorded between two collect()
+		static constexpr size_t threadCapacity = 1 << 14;
+
+		//the samples of a zone that percentiles are computed from
+		static constexpr size_t zoneSamples = 512;
+
+		//the events that are kept for exporting
+		static constexpr size_t traceCapacity = 1 << 18;
+
+		//the allocations of the event whose zone does not track allocations
+		static constexpr UInt64 untrackedAllocations = ~static_cast<UInt64>(0);
+	};
+
+	class ProfileScope final {
+	public:
+		explicit ProfileScope(const UInt32 zone) noexcept :
+			mZone(zone), mBegin(Profiler::ticks()) {}
+
+		~ProfileScope()
+		{
+			Profiler::record(mZone, mBegin, Profiler::ticks());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+
+		auto operator=(const ProfileScope&) -> ProfileScope& = delete;
+	private:
+		UInt32 mZone;
+		UInt64 mBegin;
+	};
+
+	//the scope that records the heap allocations of thread in the zone as well
+	//it reads the thread local counter twice more, so it is used for the coarse zones(for example, the phases of frame)
+	class ProfileAllocationScope final {
+	public:
+		explicit ProfileAllocationScope(const UInt32 zone) noexcept :
+			mZone(zone), mBegin(Profiler::ticks()), mAllocations(AllocationCounter::threadAllocations()) {}
+
+		~ProfileAllocationScope()
+		{
+			Profiler::record(mZone, mBegin, Profiler::ticks(), AllocationCounter::threadAllocations() - mAllocations);
+		}
+
+		ProfileAllocationScope(const ProfileAllocationScope&) = delete;
+
+		auto operator=(const ProfileAllocationScope&) -> ProfileAllocationScope& = delete;
+	private:
+		UInt32 mZone;
+		UInt64 mBegin;
+		size_t mAllocations;
+	};
+
+}
+
+#define CODE_RED_PROFILE_CONCAT_IMPL(left, right) left##right
+#define CODE_RED_PROFILE_CONCAT(left, right) CODE_RED_PROFILE_CONCAT_IMPL(left, right)
+
+#ifdef __PROFILING__MODE__
+//the name of zone is interned once, the scope only reads the ticks twice and writes an event
+#define CODE_RED_PROFILE_ZONE(name) \
+	static const auto CODE_RED_PROFILE_CONCAT(profileZone, __LINE__) = CodeRed::Profiler::zone(name); \
+	const CodeRed::ProfileScope CODE_RED_PROFILE_CONCAT(profileScope, __LINE__)(CODE_RED_PROFILE_CONCAT(profileZone, __LINE__))
+
+//the zone that tracks the heap allocations of thread in it, the zone stats have the allocations per call
+#define CODE_RED_PROFILE_ALLOCATION_ZONE(name) \
+	static const auto CODE_RED_PROFILE_CONCAT(profileZone, __LINE__) = CodeRed::Profiler::zone(name); \
+	const CodeRed::ProfileAllocationScope CODE_RED_PROFILE_CONCAT(profileScope, __LINE__)(CODE_RED_PROFILE_CONCAT(profileZone, __LINE__))
+#else
+#define CODE_RED_PROFILE_ZONE(name)
+#define CODE_RED_PROFILE_ALLOCATION_ZONE(name)
+#endif
@@ -0,0 +1,46 @@
+#include "ProfilerView.hpp"
+
+auto CodeRed::ProfilerView::create(const std::string& traceFileName) -> std::shared_ptr<ImGuiView>
+{
+	//the stats are kept by the view, so the view does not allocate in every frame
+	const auto zoneStats = std::make_shared<std::vector<ProfileZoneStats>>();
+
+	return std::make_shared<ImGuiView>([traceFileName, zoneStats]
+		{
+#ifdef __PROFILING__MODE__
+			Profiler::stats(*zoneStats);
+
+			const auto& stats = *zoneStats;
+
+			ImGui::Columns(5, "Zones");
+
+			ImGui::Text("Zone"); ImGui::NextColumn();
+			ImGui::Text("Count"); ImGui::NextColumn();
+			ImGui::Text("p50(ms)"); ImGui::NextColumn();
+			ImGui::Text("p99(ms)"); ImGui::NextColumn();
+			ImGui::Text("Allocations"); ImGui::NextColumn();
+
+			ImGui::Separator();
+
+			for (const auto& zone : stats) {
+				ImGui::Text("%s", zone.Name.c_str()); ImGui::NextColumn();
+				ImGui::Text("%zu", zone.Count); ImGui::NextColumn();
+				ImGui::Text("%.3f", zone.P50); ImGui::NextColumn();
+				ImGui::Text("%.3f", zone.P99); ImGui::NextColumn();
+				//the zone does not track allocations, so we do not know them
+				if (zone.TracksAllocations)
+					ImGui::Text("%.1f", zone.Allocations);
+				else
+					ImGui::Text("-");
+
+				ImGui::NextColumn();
+			}
+
+			ImGui::Columns(1);
+
+			if (ImGui::Button("Export Chrome Trace")) Profiler::exportChromeTrace(traceFileName);
+#else
+			ImGui::Text("The profiler is compiled out, please define __PROFILING__MODE__.");
+#endif
+		});
+}
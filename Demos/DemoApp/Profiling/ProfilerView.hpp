@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Extensions/ImGui/ImGuiWindows.hpp>
+
+#include "Profiler.hpp"
+
+namespace CodeRed {
+
+	//the ImGui view that shows the percentiles of zones and exports the chrome trace
+	class ProfilerView final {
+	public:
+		static auto create(const std::string& traceFileName = "./Profile.json") -> std::shared_ptr<ImGuiView>;
+	};
+	
+}
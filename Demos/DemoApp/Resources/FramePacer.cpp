@@ -0,0 +1,280 @@
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+CodeRed::QueueFrameFence::QueueFrameFence(
+	const std::shared_ptr<GpuLogicalDevice>& device,
+	const std::shared_ptr<GpuCommandQueue>& queue) :
+	mDevice(device), mQueue(queue)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	CODE_RED_DEBUG_THROW_IF(
+		queue == nullptr,
+		InvalidException<GpuCommandQueue>({ "queue" })
+	);
+
+#ifdef __ENABLE__DIRECTX12__
+	if (mDevice->apiVersion() == APIVersion::DirectX12) {
+		const auto dxDevice = std::static_pointer_cast<DirectX12LogicalDevice>(mDevice)->device();
+
+		if (FAILED(dxDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mDirectX12Fence))))
+			throw FailedException(DebugType::Create, { "ID3D12Fence" });
+
+		mDirectX12Event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+		if (mDirectX12Event == nullptr)
+			throw FailedException(DebugType::Create, { "Event of ID3D12Fence" });
+
+		return;
+	}
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mDevice->apiVersion() == APIVersion::Vulkan) return;
+#endif
+
+	throw NotSupportException(NotSupportType::Enum);
+}
+
+CodeRed::QueueFrameFence::~QueueFrameFence()
+{
+#ifdef __ENABLE__DIRECTX12__
+	if (mDirectX12Event != nullptr) CloseHandle(mDirectX12Event);
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mDevice->apiVersion() != APIVersion::Vulkan) return;
+
+	const auto vkDevice = std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device();
+
+	//the fences may still be used by the queue, so we wait them before destroying
+	for (const auto& pending : mVulkanPendingFences) {
+		vkDevice.waitForFences(pending.second, true, std::numeric_limits<UInt64>::max());
+		vkDevice.destroyFence(pending.second);
+	}
+
+	for (const auto& fence : mVulkanFreeFences) vkDevice.destroyFence(fence);
+#endif
+}
+
+auto CodeRed::QueueFrameFence::signal() -> UInt64
+{
+	const auto value = ++mSignaledValue;
+
+#ifdef __ENABLE__DIRECTX12__
+	if (mDevice->apiVersion() == APIVersion::DirectX12) {
+		std::static_pointer_cast<DirectX12CommandQueue>(mQueue)->queue()->Signal(mDirectX12Fence.Get(), value);
+
+		return value;
+	}
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mDevice->apiVersion() == APIVersion::Vulkan) {
+		const auto vkDevice = std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device();
+		const auto vkQueue = std::static_pointer_cast<VulkanCommandQueue>(mQueue)->queue();
+
+		vk::Fence fence;
+
+		if (mVulkanFreeFences.empty()) fence = vkDevice.createFence(vk::FenceCreateInfo());
+		else {
+			fence = mVulkanFreeFences.back();
+			mVulkanFreeFences.pop_back();
+		}
+
+		//the empty submission signals the fence after all work submitted before it
+		vkQueue.submit({}, fence);
+
+		mVulkanPendingFences.push_back({ value, fence });
+	}
+#endif
+
+	return value;
+}
+
+auto CodeRed::QueueFrameFence::completedValue() -> UInt64
+{
+#ifdef __ENABLE__DIRECTX12__
+	if (mDevice->apiVersion() == APIVersion::DirectX12)
+		return mCompletedValue = std::max(mCompletedValue, mDirectX12Fence->GetCompletedValue());
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mDevice->apiVersion() == APIVersion::Vulkan) {
+		const auto vkDevice = std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device();
+
+		while (!mVulkanPendingFences.empty() &&
+			vkDevice.getFenceStatus(mVulkanPendingFences.front().second) == vk::Result::eSuccess) {
+			const auto pending = mVulkanPendingFences.front();
+
+			vkDevice.resetFences(pending.second);
+
+			mVulkanFreeFences.push_back(pending.second);
+			mVulkanPendingFences.erase(mVulkanPendingFences.begin());
+			mCompletedValue = pending.first;
+		}
+	}
+#endif
+
+	return mCompletedValue;
+}
+
+void CodeRed::QueueFrameFence::wait(const UInt64 value)
+{
+	if (completedValue() >= value) return;
+
+#ifdef __ENABLE__DIRECTX12__
+	if (mDevice->apiVersion() == APIVersion::DirectX12) {
+		mDirectX12Fence->SetEventOnCompletion(value, mDirectX12Event);
+
+		WaitForSingleObject(mDirectX12Event, INFINITE);
+
+		mCompletedValue = value;
+	}
+#endif
+
+#ifdef __ENABLE__VULKAN__
+	if (mDevice->apiVersion() == APIVersion::Vulkan) {
+		const auto vkDevice = std::static_pointer_cast<VulkanLogicalDevice>(mDevice)->device();
+
+		//only wait the fences of values <= value, the frames after it keep executing
+		while (!mVulkanPendingFences.empty() && mVulkanPendingFences.front().first <= value) {
+			const auto pending = mVulkanPendingFences.front();
+
+			vkDevice.waitForFences(pending.second, true, std::numeric_limits<UInt64>::max());
+			vkDevice.resetFences(pending.second);
+
+			mVulkanFreeFences.push_back(pending.second);
+			mVulkanPendingFences.erase(mVulkanPendingFences.begin());
+			mCompletedValue = pending.first;
+		}
+	}
+#endif
+}
+
+CodeRed::SimulatedFrameFence::SimulatedFrameFence(const std::chrono::microseconds& delay) :
+	mDelay(delay)
+{
+}
+
+auto CodeRed::SimulatedFrameFence::signal() -> UInt64
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	//the simulated GPU executes the work in order
+	//so the work can not finish before the work submitted before it
+	auto finish = Clock::now() + mDelay;
+
+	if (!mPending.empty()) finish = std::max(finish, mPending.back().second + mDelay);
+
+	mPending.push_back({ ++mSignaledValue, finish });
+
+	return mSignaledValue;
+}
+
+auto CodeRed::SimulatedFrameFence::completedValue() -> UInt64
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const auto now = Clock::now();
+
+	while (!mPending.empty() && mPending.front().second <= now) {
+		mCompletedValue = mPending.front().first;
+		mPending.erase(mPending.begin());
+	}
+
+	return mCompletedValue;
+}
+
+void CodeRed::SimulatedFrameFence::wait(const UInt64 value)
+{
+	if (completedValue() >= value) return;
+
+	Clock::time_point finish;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (const auto& pending : mPending) {
+			finish = pending.second;
+
+			if (pending.first >= value) break;
+		}
+
+		mBlockedWaits++;
+	}
+
+	std::this_thread::sleep_until(finish);
+
+	completedValue();
+}
+
+CodeRed::FramePacer::FramePacer(
+	const std::shared_ptr<GpuLogicalDevice>& device,
+	const std::shared_ptr<FrameFence>& fence,
+	const size_t framesInFlight) :
+	mDevice(device), mFence(fence), mFrames(framesInFlight)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		fence == nullptr,
+		InvalidException<FrameFence>({ "fence" })
+	);
+
+	CODE_RED_DEBUG_THROW_IF(
+		framesInFlight < minFramesInFlight || framesInFlight > maxFramesInFlight,
+		InvalidException<size_t>({ "frames in flight" })
+	);
+
+	//without device, the pacer only paces the frames(for example, with simulated fence)
+	if (mDevice == nullptr) return;
+
+	for (auto& frame : mFrames) {
+		frame.Allocator = mDevice->createCommandAllocator();
+		frame.CommandList = mDevice->createGraphicsCommandList(frame.Allocator);
+		frame.CommandLists = { frame.CommandList };
+	}
+}
+
+auto CodeRed::FramePacer::beginFrame() -> size_t
+{
+	CODE_RED_DEBUG_THROW_IF(
+		mRecording == true,
+		Exception(DebugReport::makeError("please end frame before beginning a new frame."))
+	);
+
+	mFrameIndex = static_cast<size_t>(mFrameCount % mFrames.size());
+	mRecording = true;
+
+	auto& frame = mFrames[mFrameIndex];
+
+	//only the frame that used this slot must be finished
+	//the frames after it may still be executing
+	mFence->wait(frame.FenceValue);
+
+	if (frame.Allocator != nullptr) frame.Allocator->reset();
+
+	return mFrameIndex;
+}
+
+void CodeRed::FramePacer::endFrame()
+{
+	CODE_RED_DEBUG_THROW_IF(
+		mRecording == false,
+		Exception(DebugReport::makeError("please begin frame before ending it."))
+	);
+
+	mFrames[mFrameIndex].FenceValue = mFence->signal();
+	mFrameCount++;
+	mRecording = false;
+}
+
+void CodeRed::FramePacer::waitIdle()
+{
+	for (const auto& frame : mFrames) mFence->wait(frame.FenceValue);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#ifdef __ENABLE__DIRECTX12__
+#include <d3d12.h>
+#include <wrl/client.h>
+#endif
+
+#ifdef __ENABLE__VULKAN__
+#include <vulkan/vulkan.hpp>
+#endif
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace CodeRed {
+
+	//the fence of frame pacing, the value is increased when we signal it
+	//the work submitted before signal is finished when completedValue() >= the value
+	class FrameFence {
+	public:
+		FrameFence() = default;
+
+		virtual ~FrameFence() = default;
+
+		virtual auto signal() -> UInt64 = 0;
+
+		virtual auto completedValue() -> UInt64 = 0;
+
+		virtual void wait(const UInt64 value) = 0;
+	};
+
+	//the fence backed by the native fence of command queue, signal() signals it after the work we submitted
+	//so waiting a value only blocks until the frame of this value is finished, not the whole queue
+	//directx 12 uses one ID3D12Fence, vulkan uses a VkFence for every value in flight(they are reused)
+	class QueueFrameFence final : public FrameFence {
+	public:
+		explicit QueueFrameFence(
+			const std::shared_ptr<GpuLogicalDevice>& device,
+			const std::shared_ptr<GpuCommandQueue>& queue);
+
+		~QueueFrameFence();
+
+		auto signal() -> UInt64 override;
+
+		auto completedValue() -> UInt64 override;
+
+		void wait(const UInt64 value) override;
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+		std::shared_ptr<GpuCommandQueue> mQueue;
+
+		UInt64 mSignaledValue = 0;
+		UInt64 mCompletedValue = 0;
+
+#ifdef __ENABLE__DIRECTX12__
+		Microsoft::WRL::ComPtr<ID3D12Fence> mDirectX12Fence;
+
+		HANDLE mDirectX12Event = nullptr;
+#endif
+
+#ifdef __ENABLE__VULKAN__
+		//the fences of values are signaled in order, so we only check the oldest ones
+		//there are only a few frames in flight, so a vector is enough and it does not allocate in steady state
+		std::vector<std::pair<UInt64, vk::Fence>> mVulkanPendingFences;
+		std::vector<vk::Fence> mVulkanFreeFences;
+#endif
+	};
+
+	//the fence that completes the work after a delay since it is signaled
+	//it simulates the GPU, so the frame pacing can be tested without a device
+	class SimulatedFrameFence final : public FrameFence {
+	public:
+		explicit SimulatedFrameFence(
+			const std::chrono::microseconds& delay);
+
+		auto signal() -> UInt64 override;
+
+		auto completedValue() -> UInt64 override;
+
+		void wait(const UInt64 value) override;
+
+		//the number of waits that really blocked the caller
+		auto blockedWaits() const noexcept -> size_t { return mBlockedWaits; }
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		std::chrono::microseconds mDelay;
+
+		//the work is finished in order, so we only need the time of unfinished values
+		//a deque allocates blocks when values are pushed and popped, so we use a vector
+		std::vector<std::pair<UInt64, Clock::time_point>> mPending;
+
+		UInt64 mSignaledValue = 0;
+		UInt64 mCompletedValue = 0;
+
+		size_t mBlockedWaits = 0;
+
+		std::mutex mMutex;
+	};
+
+	//the objects that a frame slot owns, they are only reused after the frame used them is finished
+	struct FrameContext {
+		std::shared_ptr<GpuCommandAllocator> Allocator;
+		std::shared_ptr<GpuGraphicsCommandList> CommandList;
+
+		//the command list in a vector, so we can execute it without creating a vector every frame
+		std::vector<std::shared_ptr<GpuGraphicsCommandList>> CommandLists;
+
+		//the value we need wait before reusing this slot
+		UInt64 FenceValue = 0;
+
+		FrameContext() = default;
+	};
+	
+	//frame pacing with N frames in flight, every frame slot has a fence value, a command allocator
+	//and a command list recorded with the allocator
+	//beginFrame() only waits the frame that used the slot before, so the CPU can record
+	//the next frames while the GPU is executing the previous ones
+	class FramePacer final : public Noncopyable {
+	public:
+		explicit FramePacer(
+			const std::shared_ptr<GpuLogicalDevice>& device,
+			const std::shared_ptr<FrameFence>& fence,
+			const size_t framesInFlight = 2);
+
+		//wait the slot we will reuse and reset its allocator, return the index of slot
+		auto beginFrame() -> size_t;
+
+		//signal the fence after we submitted the commands of this frame
+		void endFrame();
+
+		//wait all frames in flight, call it before we destroy the resources used by GPU
+		void waitIdle();
+
+		auto context() const -> const FrameContext& { return mFrames[mFrameIndex]; }
+
+		auto context(const size_t index) const -> const FrameContext& { return mFrames[index]; }
+
+		auto allocator() const -> std::shared_ptr<GpuCommandAllocator> { return mFrames[mFrameIndex].Allocator; }
+
+		auto commandList() const -> std::shared_ptr<GpuGraphicsCommandList> { return mFrames[mFrameIndex].CommandList; }
+
+		auto commandLists() const -> const std::vector<std::shared_ptr<GpuGraphicsCommandList>>& { return mFrames[mFrameIndex].CommandLists; }
+
+		auto fence() const noexcept -> std::shared_ptr<FrameFence> { return mFence; }
+
+		auto frameIndex() const noexcept -> size_t { return mFrameIndex; }
+
+		auto frameCount() const noexcept -> UInt64 { return mFrameCount; }
+
+		auto framesInFlight() const noexcept -> size_t { return mFrames.size(); }
+
+		static constexpr size_t minFramesInFlight = 2;
+		static constexpr size_t maxFramesInFlight = 4;
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+		std::shared_ptr<FrameFence> mFence;
+
+		std::vector<FrameContext> mFrames;
+
+		size_t mFrameIndex = 0;
+		UInt64 mFrameCount = 0;
+
+		bool mRecording = false;
+	};
+
+}
@@ -1,11 +1,36 @@
 #include "FrameResources.hpp"
 
+#include <mutex>
+
 CodeRed::FrameResources::FrameResources(const std::vector<std::string>& names)
 {
-	for (auto &name : names) mResources.insert({ name, nullptr });
+	for (auto &name : names) reserve(intern(name));
 }
 
 CodeRed::FrameResources::FrameResources(const std::initializer_list<std::string>& names)
 {
-	for (auto& name : names) mResources.insert({ name, nullptr });
+	for (auto& name : names) reserve(intern(name));
+}
+
+auto CodeRed::FrameResources::intern(const std::string& name) -> size_t
+{
+	//the keys may be created when the static variables are initialized
+	//so the table is a local static variable
+	static std::unordered_map<std::string, size_t> indices;
+	static std::mutex mutex;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return indices.insert({ name, indices.size() }).first->second;
+}
+
+void CodeRed::FrameResources::reserve(const size_t index)
+{
+	if (index >= mResources.size()) mResources.resize(index + 1);
+}
+
+auto CodeRed::FrameResources::at(const size_t index) const -> const std::shared_ptr<void>&
+{
+	//getting a resource that is never set or reserved throws std::out_of_range as before
+	return mResources.at(index);
 }
@@ -6,6 +6,20 @@
 
 namespace CodeRed {
 
+	//the name of frame resource is interned to an index when we create the key
+	//so the lookup with key is an index of array, and the type is checked at compile time
+	template<typename T>
+	class FrameResourceKey {
+	public:
+		using Type = T;
+
+		explicit FrameResourceKey(const std::string& name);
+
+		auto index() const noexcept -> size_t { return mIndex; }
+	private:
+		size_t mIndex = 0;
+	};
+
 	class FrameResources {
 	public:
 		FrameResources() = default;
@@ -13,27 +27,68 @@ namespace CodeRed {
 		FrameResources(const std::vector<std::string>& names);
 
 		FrameResources(const std::initializer_list<std::string>& names);
-		
+
 		template<typename T>
 		void set(
 			const std::string& name,
 			const std::shared_ptr<T>& resource);
 
+		template<typename T>
+		void set(
+			const FrameResourceKey<T>& key,
+			const std::shared_ptr<typename FrameResourceKey<T>::Type>& resource);
+
 		template<typename T>
 		auto get(const std::string& name) const -> std::shared_ptr<T>;
+
+		template<typename T>
+		auto get(const FrameResourceKey<T>& key) const -> std::shared_ptr<T>;
+
+		//get the index of name, the same name always has the same index in this process
+		static auto intern(const std::string& name) -> size_t;
+	private:
+		void reserve(const size_t index);
+
+		auto at(const size_t index) const -> const std::shared_ptr<void>&;
 	private:
-		std::unordered_map<std::string, std::shared_ptr<void>> mResources;
+		std::vector<std::shared_ptr<void>> mResources;
 	};
 
+	template <typename T>
+	FrameResourceKey<T>::FrameResourceKey(const std::string& name) :
+		mIndex(FrameResources::intern(name))
+	{
+	}
+
 	template <typename T>
 	void FrameResources::set(const std::string& name, const std::shared_ptr<T>& resource)
 	{
-		mResources[name] = resource;
+		const auto index = intern(name);
+
+		reserve(index);
+
+		mResources[index] = resource;
+	}
+
+	template <typename T>
+	void FrameResources::set(
+		const FrameResourceKey<T>& key,
+		const std::shared_ptr<typename FrameResourceKey<T>::Type>& resource)
+	{
+		reserve(key.index());
+
+		mResources[key.index()] = resource;
 	}
 
 	template <typename T>
 	auto FrameResources::get(const std::string& name) const -> std::shared_ptr<T>
 	{
-		return std::static_pointer_cast<T>(mResources.at(name));
+		return std::static_pointer_cast<T>(at(intern(name)));
+	}
+
+	template <typename T>
+	auto FrameResources::get(const FrameResourceKey<T>& key) const -> std::shared_ptr<T>
+	{
+		return std::static_pointer_cast<T>(at(key.index()));
 	}
 }
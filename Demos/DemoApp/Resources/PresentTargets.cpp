@@ -0,0 +1,50 @@
+#include "PresentTargets.hpp"
+
+CodeRed::PresentTargets::PresentTargets(const std::shared_ptr<GpuSwapChain>& swapChain) :
+	mSwapChain(swapChain)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		swapChain == nullptr,
+		InvalidException<GpuSwapChain>({ "swapChain" })
+	);
+
+	mWidth = mSwapChain->width();
+	mHeight = mSwapChain->height();
+	mFormat = mSwapChain->format();
+}
+
+CodeRed::PresentTargets::PresentTargets(
+	const std::shared_ptr<GpuLogicalDevice>& device,
+	const size_t width,
+	const size_t height,
+	const PixelFormat format,
+	const size_t bufferCount) :
+	mWidth(width), mHeight(height), mFormat(format)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	for (size_t index = 0; index < bufferCount; index++) {
+		mOffscreenBuffers.push_back(device->createTexture(
+			ResourceInfo::Texture2D(
+				mWidth,
+				mHeight,
+				mFormat,
+				1,
+				ResourceUsage::RenderTarget
+			)
+		));
+	}
+}
+
+void CodeRed::PresentTargets::present()
+{
+	if (mSwapChain != nullptr) mSwapChain->present();
+}
+
+auto CodeRed::PresentTargets::buffer(const size_t index) const -> std::shared_ptr<GpuTexture>
+{
+	return mSwapChain != nullptr ? mSwapChain->buffer(index) : mOffscreenBuffers[index];
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+namespace CodeRed {
+
+	//the textures that the demo presents, the buffers of swap chain when we have a window
+	//or the offscreen textures when the demo runs in headless mode
+	//the offscreen textures use the same layouts as the buffers of swap chain
+	//so the render passes of demo do not need to know where they render to
+	class PresentTargets final : public Noncopyable {
+	public:
+		explicit PresentTargets(
+			const std::shared_ptr<GpuSwapChain>& swapChain);
+
+		explicit PresentTargets(
+			const std::shared_ptr<GpuLogicalDevice>& device,
+			const size_t width,
+			const size_t height,
+			const PixelFormat format,
+			const size_t bufferCount = 2);
+
+		//present the swap chain, the offscreen targets do nothing
+		void present();
+		
+		auto buffer(const size_t index) const -> std::shared_ptr<GpuTexture>;
+
+		auto swapChain() const noexcept -> std::shared_ptr<GpuSwapChain> { return mSwapChain; }
+
+		auto isOffscreen() const noexcept -> bool { return mSwapChain == nullptr; }
+
+		auto width() const noexcept -> size_t { return mWidth; }
+
+		auto height() const noexcept -> size_t { return mHeight; }
+
+		auto format() const noexcept -> PixelFormat { return mFormat; }
+
+	private:
+		std::shared_ptr<GpuSwapChain> mSwapChain;
+
+		std::vector<std::shared_ptr<GpuTexture>> mOffscreenBuffers;
+
+		size_t mWidth = 0;
+		size_t mHeight = 0;
+
+		PixelFormat mFormat = PixelFormat::BlueGreenRedAlpha8BitUnknown;
+	};
+	
+}
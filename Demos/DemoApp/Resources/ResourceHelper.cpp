@@ -1,5 +1,7 @@
 #include "ResourceHelper.hpp"
 
+#include "../Profiling/Profiler.hpp"
+
 #define STB_IMAGE_IMPLEMENTATION
 
 #include <stb_image.h>
@@ -25,6 +27,8 @@ void CodeRed::ResourceHelper::updateBuffer(
 	const std::shared_ptr<GpuBuffer>& buffer, 
 	const void* data)
 {
+	CODE_RED_PROFILE_ZONE("ResourceHelper::updateBuffer(Upload)");
+
 	//first, we create the command list and command queue for copy resource
 	auto commandList = device->createGraphicsCommandList(allocator);
 	auto commandQueue = queue;
@@ -65,6 +69,8 @@ void CodeRed::ResourceHelper::updateBuffer(
 	const void* data, 
 	const size_t size)
 {
+	CODE_RED_PROFILE_ZONE("ResourceHelper::updateBuffer(Mapped)");
+
 	const auto memory = buffer->mapMemory();
 
 	std::memcpy(memory, data, size == 0 ? buffer->size() : size);
@@ -79,13 +85,18 @@ void CodeRed::ResourceHelper::updateTexture(
 	const std::shared_ptr<GpuTexture>& texture,
 	const void* data)
 {
+	CODE_RED_PROFILE_ZONE("ResourceHelper::updateTexture");
+
 	auto commandList = device->createGraphicsCommandList(allocator);
 	auto commandQueue = queue;
 
 	size_t offset = 0;
 
+	//the texture buffers are kept until the copy is finished, we know the count, so we allocate once
 	auto bufferPool = std::vector<std::shared_ptr<GpuTextureBuffer>>();
 
+	bufferPool.reserve(texture->arrays() * texture->mipLevels());
+
 	auto oldLayout = texture->layout();
 
 	commandList->beginRecording();
@@ -123,6 +134,8 @@ auto CodeRed::ResourceHelper::loadTexture(
 	const std::string& fileName)
 	-> std::shared_ptr<GpuTexture>
 {
+	CODE_RED_PROFILE_ZONE("ResourceHelper::loadTexture");
+
 	auto width = 0;
 	auto height = 0;
 	auto channel = 0;
@@ -0,0 +1,333 @@
+#include "ShaderArchive.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+namespace CodeRed {
+
+	inline auto sameKey(
+		const ShaderArchiveEntry& entry,
+		const std::string& name,
+		const ShaderType& type,
+		const APIVersion& api) -> bool
+	{
+		return
+			entry.Type == static_cast<UInt32>(type) &&
+			entry.API == static_cast<UInt32>(api) &&
+			std::strncmp(entry.Name, name.c_str(), sizeof(entry.Name)) == 0;
+	}
+
+}
+
+CodeRed::ShaderArchive::ShaderArchive(const std::string& fileName)
+{
+#ifdef _WIN32
+	const auto file = CreateFile(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) return;
+
+	mFile = file;
+
+	LARGE_INTEGER size;
+
+	if (GetFileSizeEx(file, &size) == FALSE || size.QuadPart == 0) { close(); return; }
+
+	mSize = static_cast<size_t>(size.QuadPart);
+	mMapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mMapping == nullptr) { close(); return; }
+
+	mData = static_cast<const Byte*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	const auto file = open(fileName.c_str(), O_RDONLY);
+
+	if (file < 0) return;
+
+	struct stat status;
+
+	if (fstat(file, &status) != 0 || status.st_size == 0) { ::close(file); return; }
+
+	mSize = static_cast<size_t>(status.st_size);
+
+	const auto data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+
+	//the mapping keeps a reference of file, so we can close it now
+	::close(file);
+
+	if (data != MAP_FAILED) mData = static_cast<const Byte*>(data);
+#endif
+
+	if (mData == nullptr) { close(); return; }
+
+	//validate the header and the index before we trust any offset
+	ShaderArchiveHeader header;
+
+	if (mSize < sizeof(header)) { close(); return; }
+
+	std::memcpy(&header, mData, sizeof(header));
+
+	const auto indexSize = static_cast<UInt64>(header.Count) * sizeof(ShaderArchiveEntry);
+
+	if (header.Magic != magic || header.Version != version ||
+		sizeof(header) + indexSize > mSize) {
+		close(); return;
+	}
+
+	mEntries.resize(header.Count);
+
+	std::memcpy(mEntries.data(), mData + sizeof(header), static_cast<size_t>(indexSize));
+
+	for (const auto& entry : mEntries) {
+		if (entry.Offset > mSize || entry.Size > mSize - entry.Offset ||
+			entry.Name[sizeof(entry.Name) - 1] != '\0') {
+			close(); return;
+		}
+	}
+}
+
+CodeRed::ShaderArchive::~ShaderArchive()
+{
+	close();
+}
+
+auto CodeRed::ShaderArchive::find(
+	const std::string& name,
+	const ShaderType& type,
+	const APIVersion& api) const -> ShaderBlob
+{
+	const auto entry = findEntry(name, type, api);
+
+	return entry == nullptr ? ShaderBlob() : blob(*entry);
+}
+
+auto CodeRed::ShaderArchive::find(
+	const std::string& name,
+	const ShaderType& type,
+	const APIVersion& api,
+	const UInt64 sourceHash) const -> ShaderBlob
+{
+	const auto entry = findEntry(name, type, api);
+
+	return entry == nullptr || entry->SourceHash != sourceHash ? ShaderBlob() : blob(*entry);
+}
+
+auto CodeRed::ShaderArchive::blob(const ShaderArchiveEntry& entry) const noexcept -> ShaderBlob
+{
+	return ShaderBlob(mData + entry.Offset, static_cast<size_t>(entry.Size));
+}
+
+auto CodeRed::ShaderArchive::hash(const std::string& source) noexcept -> UInt64
+{
+	//fnv-1a, we need the same value between runs, so we do not use std::hash
+	UInt64 value = 14695981039346656037ull;
+
+	for (const auto character : source) {
+		value = value ^ static_cast<Byte>(character);
+		value = value * 1099511628211ull;
+	}
+
+	return value;
+}
+
+auto CodeRed::ShaderArchive::findEntry(
+	const std::string& name,
+	const ShaderType& type,
+	const APIVersion& api) const -> const ShaderArchiveEntry*
+{
+	//the archive only has a few entries, linear search is enough
+	for (const auto& entry : mEntries)
+		if (sameKey(entry, name, type, api)) return &entry;
+
+	return nullptr;
+}
+
+void CodeRed::ShaderArchive::close()
+{
+#ifdef _WIN32
+	if (mData != nullptr) UnmapViewOfFile(mData);
+	if (mMapping != nullptr) CloseHandle(static_cast<HANDLE>(mMapping));
+	if (mFile != nullptr) CloseHandle(static_cast<HANDLE>(mFile));
+#else
+	if (mData != nullptr) munmap(const_cast<Byte*>(mData), mSize);
+#endif
+
+	mEntries.clear();
+	mData = nullptr;
+	mSize = 0;
+	mFile = nullptr;
+	mMapping = nullptr;
+}
+
+void CodeRed::ShaderArchiveWriter::add(
+	const std::string& name,
+	const ShaderType& type,
+	const APIVersion& api,
+	const UInt64 sourceHash,
+	const ShaderBlob& blob)
+{
+	ShaderArchiveEntry entry;
+
+	CODE_RED_DEBUG_THROW_IF(
+		name.size() >= sizeof(entry.Name),
+		InvalidException<std::string>({ "name" })
+	);
+
+	std::memcpy(entry.Name, name.c_str(), name.size());
+
+	entry.Type = static_cast<UInt32>(type);
+	entry.API = static_cast<UInt32>(api);
+	entry.SourceHash = sourceHash;
+	entry.Size = blob.Size;
+
+	std::vector<Byte> code(blob.Data, blob.Data + blob.Size);
+
+	for (size_t index = 0; index < mEntries.size(); index++) {
+		if (!sameKey(mEntries[index], name, type, api)) continue;
+
+		mEntries[index] = entry;
+		mBlobs[index] = std::move(code);
+
+		return;
+	}
+
+	mEntries.push_back(entry);
+	mBlobs.push_back(std::move(code));
+}
+
+void CodeRed::ShaderArchiveWriter::add(const ShaderArchive& archive)
+{
+	for (const auto& entry : archive.entries()) {
+		add(entry.Name,
+			static_cast<ShaderType>(entry.Type),
+			static_cast<APIVersion>(entry.API),
+			entry.SourceHash,
+			archive.blob(entry));
+	}
+}
+
+auto CodeRed::ShaderArchiveWriter::write(const std::string& fileName) const -> bool
+{
+	const auto align = [](const UInt64 value)
+	{
+		return (value + ShaderArchive::alignment - 1) / ShaderArchive::alignment * ShaderArchive::alignment;
+	};
+
+	ShaderArchiveHeader header;
+
+	header.Magic = ShaderArchive::magic;
+	header.Version = ShaderArchive::version;
+	header.Count = static_cast<UInt32>(mEntries.size());
+	header.Alignment = ShaderArchive::alignment;
+
+	auto entries = mEntries;
+	auto offset = align(sizeof(header) + entries.size() * sizeof(ShaderArchiveEntry));
+
+	for (auto& entry : entries) {
+		entry.Offset = offset;
+
+		offset = align(offset + entry.Size);
+	}
+
+	const auto temporary = fileName + ".tmp";
+
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open()) return false;
+
+		const std::vector<char> padding(ShaderArchive::alignment, 0);
+
+		const auto pad = [&]()
+		{
+			const auto position = static_cast<UInt64>(file.tellp());
+
+			file.write(padding.data(), static_cast<std::streamsize>(align(position) - position));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()),
+			static_cast<std::streamsize>(entries.size() * sizeof(ShaderArchiveEntry)));
+
+		for (const auto& blob : mBlobs) {
+			pad();
+
+			file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+		}
+
+		if (!file.good()) return false;
+	}
+
+	std::error_code error;
+
+	std::filesystem::rename(temporary, fileName, error);
+
+	return !error;
+}
+
+CodeRed::ShaderArchiveCache::ShaderArchiveCache(const std::string& fileName) :
+	mArchive(std::make_unique<ShaderArchive>(fileName)), mFileName(fileName)
+{
+}
+
+auto CodeRed::ShaderArchiveCache::code(
+	const std::string& name,
+	const ShaderType& type,
+	const APIVersion& api,
+	const std::string& source,
+	const std::function<std::vector<Byte>()>& compile)
+	-> std::vector<Byte>
+{
+	const auto sourceHash = ShaderArchive::hash(source);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (mArchive != nullptr) {
+		const auto blob = mArchive->find(name, type, api, sourceHash);
+
+		//the shader state needs a std::vector, so it is the only copy of the blob
+		if (!blob.empty()) return std::vector<Byte>(blob.Data, blob.Data + blob.Size);
+	}
+
+	auto code = compile();
+
+	if (code.empty()) return code;
+
+	//when the first miss happened, we copy the blobs that are still valid to writer
+	//so the new archive will have the old blobs and the new blob
+	if (mWriter == nullptr) {
+		mWriter = std::make_unique<ShaderArchiveWriter>();
+
+		if (mArchive != nullptr) mWriter->add(*mArchive);
+	}
+
+	mWriter->add(name, type, api, sourceHash, ShaderBlob(code.data(), code.size()));
+
+	return code;
+}
+
+void CodeRed::ShaderArchiveCache::flush()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (mWriter == nullptr) return;
+
+	//we need unmap the archive before we replace it
+	mArchive.reset();
+
+	if (!mWriter->write(mFileName))
+		DebugReport::error("write shader archive \"" + mFileName + "\" failed.");
+
+	mWriter.reset();
+	mArchive = std::make_unique<ShaderArchive>(mFileName);
+}
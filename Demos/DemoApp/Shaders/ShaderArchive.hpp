@@ -0,0 +1,156 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace CodeRed {
+
+	/*
+	 * the layout of shader archive:
+	 * [ShaderArchiveHeader][ShaderArchiveEntry * Count][blob][blob]...
+	 * every blob starts at an offset that is aligned to the header alignment
+	 * all values are little endian, the archive is only read by the machine that built it
+	 */
+
+	struct ShaderArchiveHeader {
+		UInt32 Magic = 0;
+		UInt32 Version = 0;
+		UInt32 Count = 0;
+		UInt32 Alignment = 0;
+	};
+
+	struct ShaderArchiveEntry {
+		char Name[56] = {};
+
+		UInt32 Type = 0;
+		UInt32 API = 0;
+
+		//the hash of the source that the blob compiled from
+		//if the source is changed, the blob is out of date
+		UInt64 SourceHash = 0;
+
+		UInt64 Offset = 0;
+		UInt64 Size = 0;
+	};
+
+	struct ShaderBlob {
+		const Byte* Data = nullptr;
+		size_t Size = 0;
+
+		ShaderBlob() = default;
+
+		ShaderBlob(const Byte* data, const size_t size) :
+			Data(data), Size(size) {}
+
+		auto empty() const noexcept -> bool { return Data == nullptr || Size == 0; }
+	};
+
+	//read only view of shader archive, the file is mapped into memory
+	//so opening the archive only costs the page faults of the blobs we touch
+	class ShaderArchive final : public Noncopyable {
+	public:
+		explicit ShaderArchive(const std::string& fileName);
+
+		~ShaderArchive();
+
+		auto find(
+			const std::string& name,
+			const ShaderType& type,
+			const APIVersion& api) const -> ShaderBlob;
+
+		//find the blob only if it is compiled from the source with same hash
+		auto find(
+			const std::string& name,
+			const ShaderType& type,
+			const APIVersion& api,
+			const UInt64 sourceHash) const -> ShaderBlob;
+
+		auto entries() const noexcept -> const std::vector<ShaderArchiveEntry>& { return mEntries; }
+
+		auto blob(const ShaderArchiveEntry& entry) const noexcept -> ShaderBlob;
+
+		//if the file is not existed or it is not a valid archive, the archive is empty
+		auto valid() const noexcept -> bool { return mData != nullptr; }
+
+		static auto hash(const std::string& source) noexcept -> UInt64;
+
+		static constexpr UInt32 magic = 0x41535243; //"CRSA"
+		static constexpr UInt32 version = 1;
+		static constexpr UInt32 alignment = 64;
+	private:
+		auto findEntry(
+			const std::string& name,
+			const ShaderType& type,
+			const APIVersion& api) const -> const ShaderArchiveEntry*;
+
+		void close();
+	private:
+		std::vector<ShaderArchiveEntry> mEntries;
+
+		const Byte* mData = nullptr;
+		size_t mSize = 0;
+
+		void* mFile = nullptr;
+		void* mMapping = nullptr;
+	};
+
+	class ShaderArchiveWriter final : public Noncopyable {
+	public:
+		ShaderArchiveWriter() = default;
+
+		~ShaderArchiveWriter() = default;
+
+		//if there is a blob with same name, type and api, we will replace it
+		void add(
+			const std::string& name,
+			const ShaderType& type,
+			const APIVersion& api,
+			const UInt64 sourceHash,
+			const ShaderBlob& blob);
+
+		//copy the blobs of archive, the blobs with same key will be replaced
+		void add(const ShaderArchive& archive);
+
+		//write to a temporary file and replace the old one
+		//so the old archive is never seen as half written
+		auto write(const std::string& fileName) const -> bool;
+
+		auto size() const noexcept -> size_t { return mEntries.size(); }
+	private:
+		std::vector<ShaderArchiveEntry> mEntries;
+		std::vector<std::vector<Byte>> mBlobs;
+	};
+
+	//shader archive used as a persistent cache of compiled shaders
+	//hit: copy the mapped blob, miss: compile it and keep it until flush() writes the archive
+	//we do not write in the destructor, the cache may be a static that is destroyed after the logger
+	class ShaderArchiveCache final : public Noncopyable {
+	public:
+		explicit ShaderArchiveCache(const std::string& fileName);
+
+		~ShaderArchiveCache() = default;
+
+		auto code(
+			const std::string& name,
+			const ShaderType& type,
+			const APIVersion& api,
+			const std::string& source,
+			const std::function<std::vector<Byte>()>& compile)
+			-> std::vector<Byte>;
+
+		void flush();
+	private:
+		std::unique_ptr<ShaderArchive> mArchive;
+		std::unique_ptr<ShaderArchiveWriter> mWriter;
+
+		std::string mFileName;
+
+		std::mutex mMutex;
+	};
+
+}
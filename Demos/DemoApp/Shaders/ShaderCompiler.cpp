@@ -7,6 +7,9 @@
 
 #ifdef __ENABLE__VULKAN__
 #include <shaderc/shaderc.hpp>
+#include <spirv-tools/optimizer.hpp>
+#pragma comment(lib, "SPIRV-Tools-opt.lib")
+#pragma comment(lib, "SPIRV-Tools.lib")
 #endif
 
 #include <fstream>
@@ -66,6 +69,56 @@ auto CodeRed::ShaderCompiler::compileToSpv(
 	return code;
 }
 
+auto CodeRed::ShaderCompiler::optimizeSpv(
+	const std::vector<Byte>& code,
+	ShaderOptimizeReport& report,
+	const bool stripDebugInfo)
+	-> std::vector<Byte>
+{
+	//the count of instructions is the count of instruction headers after the module header
+	const auto countInstructions = [](const std::vector<uint32_t>& words)
+	{
+		size_t count = 0;
+
+		for (size_t location = 5; location < words.size() && (words[location] >> 16) != 0; count++)
+			location = location + (words[location] >> 16);
+
+		return count;
+	};
+
+	auto words = std::vector<uint32_t>(code.size() / sizeof(uint32_t));
+
+	std::memcpy(words.data(), code.data(), words.size() * sizeof(uint32_t));
+
+	spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_0);
+
+	optimizer.SetMessageConsumer([](spv_message_level_t level, const char*,
+		const spv_position_t&, const char* message)
+		{
+			if (level <= SPV_MSG_ERROR) DebugReport::error(message);
+		});
+
+	optimizer.RegisterPerformancePasses();
+
+	if (stripDebugInfo) optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
+
+	std::vector<uint32_t> optimized;
+
+	//if we failed to optimize the code, we still can use the code before optimizing
+	if (!optimizer.Run(words.data(), words.size(), &optimized)) optimized = words;
+
+	report.SizeBefore = code.size();
+	report.SizeAfter = optimized.size() * sizeof(uint32_t);
+	report.InstructionsBefore = countInstructions(words);
+	report.InstructionsAfter = countInstructions(optimized);
+	
+	auto result = std::vector<Byte>(optimized.size() * sizeof(uint32_t));
+
+	std::memcpy(result.data(), optimized.data(), result.size());
+
+	return result;
+}
+
 #endif
 
 #ifdef __ENABLE__DIRECTX12__
@@ -10,6 +10,25 @@
 
 namespace CodeRed {
 
+	struct ShaderOptimizeReport {
+		size_t SizeBefore = 0;
+		size_t SizeAfter = 0;
+		size_t InstructionsBefore = 0;
+		size_t InstructionsAfter = 0;
+
+		ShaderOptimizeReport() = default;
+
+		auto sizeDelta() const noexcept -> long long
+		{
+			return static_cast<long long>(SizeAfter) - static_cast<long long>(SizeBefore);
+		}
+
+		auto instructionsDelta() const noexcept -> long long
+		{
+			return static_cast<long long>(InstructionsAfter) - static_cast<long long>(InstructionsBefore);
+		}
+	};
+	
 	class ShaderCompiler {
 	public:
 		static auto readShader(const std::string& fileName) -> std::string;
@@ -17,6 +36,14 @@ namespace CodeRed {
 #ifdef __ENABLE__VULKAN__
 		static auto compileToSpv(const ShaderType& shaderType, const std::string& shader)
 			-> std::vector<Byte>;
+
+		//run the performance passes of spirv-opt and strip the debug instructions(OpName and so on)
+		//if you want to reflect the shader with names, reflect it before optimizing
+		static auto optimizeSpv(
+			const std::vector<Byte>& code,
+			ShaderOptimizeReport& report,
+			const bool stripDebugInfo = true)
+			-> std::vector<Byte>;
 #endif
 
 #ifdef __ENABLE__DIRECTX12__
@@ -0,0 +1,501 @@
+#include "ShaderReflection.hpp"
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <optional>
+#include <string_view>
+#include <deque>
+#include <mutex>
+
+namespace CodeRed {
+
+	namespace SpirV {
+
+		constexpr UInt32 MagicNumber = 0x07230203;
+		constexpr size_t HeaderSize = 5;
+
+		enum Op : UInt32 {
+			OpName = 5,
+			OpEntryPoint = 15,
+			OpTypeInt = 21,
+			OpTypeFloat = 22,
+			OpTypeVector = 23,
+			OpTypeMatrix = 24,
+			OpTypeImage = 25,
+			OpTypeSampler = 26,
+			OpTypeSampledImage = 27,
+			OpTypeArray = 28,
+			OpTypeRuntimeArray = 29,
+			OpTypeStruct = 30,
+			OpTypePointer = 32,
+			OpConstant = 43,
+			OpVariable = 59,
+			OpDecorate = 71,
+			OpMemberDecorate = 72
+		};
+
+		enum Decoration : UInt32 {
+			Block = 2,
+			BufferBlock = 3,
+			ArrayStride = 6,
+			MatrixStride = 7,
+			BuiltIn = 11,
+			Location = 30,
+			Binding = 33,
+			DescriptorSet = 34,
+			Offset = 35
+		};
+
+		enum ExecutionModel : UInt32 {
+			Vertex = 0
+		};
+
+		enum StorageClass : UInt32 {
+			UniformConstant = 0,
+			Input = 1,
+			Uniform = 2,
+			PushConstant = 9,
+			StorageBuffer = 12
+		};
+
+		struct Type {
+			UInt32 Op = 0;
+
+			//the component type of vector/matrix, element type of array
+			//or the pointee type of pointer
+			UInt32 Element = 0;
+			UInt32 Count = 0;
+			UInt32 Width = 0;
+			UInt32 StorageClass = 0;
+
+			std::vector<UInt32> Members;
+
+			//the signedness of integer type
+			UInt32 Signedness = 0;
+		};
+
+		struct Module {
+			std::unordered_map<UInt32, Type> Types;
+			std::unordered_map<UInt32, UInt32> Constants;
+			std::unordered_map<UInt32, std::string> Names;
+			std::unordered_map<UInt32, std::unordered_map<UInt32, UInt32>> Decorations;
+			std::unordered_map<UInt32, std::unordered_map<UInt32, UInt32>> MemberOffsets;
+			std::unordered_map<UInt32, std::unordered_map<UInt32, UInt32>> MemberMatrixStrides;
+			std::vector<std::pair<UInt32, UInt32>> Variables;
+
+			//the execution model of the first entry point
+			std::optional<UInt32> ExecutionModel;
+
+			auto decoration(const UInt32 id, const UInt32 decoration) const -> std::optional<UInt32>
+			{
+				const auto it = Decorations.find(id);
+
+				if (it == Decorations.end()) return std::nullopt;
+
+				const auto value = it->second.find(decoration);
+
+				if (value == it->second.end()) return std::nullopt;
+
+				return value->second;
+			}
+
+			auto name(const UInt32 id) const -> std::string
+			{
+				const auto it = Names.find(id);
+
+				return it == Names.end() ? "" : it->second;
+			}
+
+			auto sizeOf(const UInt32 id, const UInt32 matrixStride = 0) const -> size_t
+			{
+				const auto& type = Types.at(id);
+
+				switch (type.Op) {
+				case OpTypeInt:
+				case OpTypeFloat:
+					return type.Width / 8;
+				case OpTypeVector:
+					return sizeOf(type.Element) * type.Count;
+				case OpTypeMatrix:
+					return (matrixStride != 0 ? matrixStride : sizeOf(type.Element)) * type.Count;
+				case OpTypeArray: {
+					const auto stride = decoration(id, ArrayStride);
+
+					return (stride.has_value() ? stride.value() : sizeOf(type.Element)) * type.Count;
+				}
+				case OpTypeRuntimeArray:
+					return 0;
+				case OpTypeStruct: {
+					size_t size = 0;
+
+					//the size of struct is the end of the last member
+					for (UInt32 member = 0; member < type.Members.size(); member++) {
+						const auto offset = memberValue(MemberOffsets, id, member);
+						const auto stride = memberValue(MemberMatrixStrides, id, member);
+
+						size = std::max(size, offset + sizeOf(type.Members[member], static_cast<UInt32>(stride)));
+					}
+
+					return size;
+				}
+				default:
+					return 0;
+				}
+			}
+
+			//the stride of element if the last member of the struct is a runtime array
+			auto strideOf(const UInt32 id) const -> size_t
+			{
+				const auto& type = Types.at(id);
+
+				if (type.Op != OpTypeStruct || type.Members.empty()) return 0;
+
+				const auto last = type.Members.back();
+
+				if (Types.at(last).Op != OpTypeRuntimeArray) return 0;
+
+				const auto stride = decoration(last, ArrayStride);
+
+				return stride.has_value() ? stride.value() : sizeOf(Types.at(last).Element);
+			}
+
+			static auto memberValue(
+				const std::unordered_map<UInt32, std::unordered_map<UInt32, UInt32>>& values,
+				const UInt32 id, const UInt32 member) -> size_t
+			{
+				const auto it = values.find(id);
+
+				if (it == values.end()) return 0;
+
+				const auto value = it->second.find(member);
+
+				return value == it->second.end() ? 0 : value->second;
+			}
+		};
+
+		auto parse(const std::vector<Byte>& code) -> Module
+		{
+			CODE_RED_DEBUG_THROW_IF(
+				code.size() % sizeof(UInt32) != 0 || code.size() < HeaderSize * sizeof(UInt32),
+				InvalidException<std::vector<Byte>>({ "spir-v code" })
+			);
+
+			std::vector<UInt32> words(code.size() / sizeof(UInt32));
+
+			std::memcpy(words.data(), code.data(), code.size());
+
+			CODE_RED_DEBUG_THROW_IF(
+				words[0] != MagicNumber,
+				InvalidException<std::vector<Byte>>({ "spir-v code" })
+			);
+
+			Module module;
+
+			size_t location = HeaderSize;
+
+			while (location < words.size()) {
+				const auto count = words[location] >> 16;
+				const auto op = words[location] & 0xffff;
+				const auto* operands = words.data() + location + 1;
+
+				if (count == 0 || location + count > words.size()) break;
+
+				switch (op) {
+				case OpName:
+					module.Names[operands[0]] = std::string(reinterpret_cast<const char*>(operands + 1));
+					break;
+				case OpEntryPoint:
+					if (!module.ExecutionModel.has_value()) module.ExecutionModel = operands[0];
+					break;
+				case OpTypeInt:
+					module.Types[operands[0]] = { op, 0, 0, operands[1], 0, {}, operands[2] };
+					break;
+				case OpTypeFloat:
+					module.Types[operands[0]] = { op, 0, 0, operands[1] };
+					break;
+				case OpTypeVector:
+				case OpTypeMatrix:
+					module.Types[operands[0]] = { op, operands[1], operands[2] };
+					break;
+				case OpTypeImage:
+				case OpTypeSampler:
+				case OpTypeSampledImage:
+					module.Types[operands[0]] = { op };
+					break;
+				case OpTypeArray:
+					//the length of array is a id of constant, we resolve it at the end
+					module.Types[operands[0]] = { op, operands[1], operands[2] };
+					break;
+				case OpTypeRuntimeArray:
+					module.Types[operands[0]] = { op, operands[1] };
+					break;
+				case OpTypeStruct:
+					module.Types[operands[0]] = { op, 0, 0, 0, 0,
+						std::vector<UInt32>(operands + 1, operands + count - 1) };
+					break;
+				case OpTypePointer:
+					module.Types[operands[0]] = { op, operands[2], 0, 0, operands[1] };
+					break;
+				case OpConstant:
+					module.Constants[operands[1]] = operands[2];
+					break;
+				case OpVariable:
+					module.Variables.push_back({ operands[1], operands[0] });
+					break;
+				case OpDecorate:
+					module.Decorations[operands[0]][operands[1]] = count > 3 ? operands[2] : 0;
+					break;
+				case OpMemberDecorate:
+					if (operands[2] == Offset) module.MemberOffsets[operands[0]][operands[1]] = operands[3];
+					if (operands[2] == MatrixStride) module.MemberMatrixStrides[operands[0]][operands[1]] = operands[3];
+					break;
+				default:
+					break;
+				}
+
+				location = location + count;
+			}
+
+			for (auto& type : module.Types) {
+				if (type.second.Op != OpTypeArray) continue;
+
+				type.second.Count = module.Constants[type.second.Count];
+			}
+
+			return module;
+		}
+
+		auto formatOf(const Module& module, const UInt32 id) -> PixelFormat
+		{
+			const auto& type = module.Types.at(id);
+			const auto& component = type.Op == OpTypeVector ? module.Types.at(type.Element) : type;
+			const auto count = type.Op == OpTypeVector ? type.Count : 1;
+
+			//the input layout of effect passes only uses 32bit float components
+			//we do not guess a format for integer or matrix inputs, they need a hand-written layout
+			if (component.Op != OpTypeFloat || component.Width != 32 || type.Op == OpTypeMatrix) {
+				throw FailedException(DebugType::Create,
+					{ "shader reflection" },
+					{ "only the vertex inputs with 32bit float components are supported." });
+			}
+
+			switch (count) {
+			case 1: return PixelFormat::Red32BitFloat;
+			case 2: return PixelFormat::RedGreen32BitFloat;
+			case 3: return PixelFormat::RedGreenBlue32BitFloat;
+			default: return PixelFormat::RedGreenBlueAlpha32BitFloat;
+			}
+		}
+
+		//the semantic of input is the name of variable in upper case, "in vec3 position" is "POSITION"
+		//dxc names the input "in.var.POSITION", so we remove the prefix of it
+		//the vulkan pipeline binds the inputs by location, so the input without name uses its location
+		auto semanticOf(const std::string& name, const UInt32 location) -> std::string
+		{
+			static const std::string prefix = "in.var.";
+
+			auto semantic = name.compare(0, prefix.size(), prefix) == 0 ? name.substr(prefix.size()) : name;
+
+			if (semantic.empty()) return "LOCATION" + std::to_string(location);
+
+			std::transform(semantic.begin(), semantic.end(), semantic.begin(),
+				[](const char character) { return static_cast<char>(std::toupper(static_cast<unsigned char>(character))); });
+
+			return semantic;
+		}
+	}
+
+	struct ShaderReflectionCacheEntry {
+		size_t Hash = 0;
+
+		std::vector<Byte> Code;
+		ShaderReflection Reflection;
+	};
+
+	//the effect passes only have a few shaders, we keep the newest entries and drop the oldest one
+	//so the shaders reloaded by the watcher do not grow the cache forever
+	constexpr size_t gShaderReflectionCacheCapacity = 32;
+
+	static std::deque<ShaderReflectionCacheEntry> gShaderReflectionCache;
+	static std::mutex gShaderReflectionCacheMutex;
+}
+
+auto CodeRed::ShaderReflection::resourceElements() const -> std::vector<ResourceLayoutElement>
+{
+	std::vector<ResourceLayoutElement> elements;
+
+	for (const auto& binding : Bindings) {
+		switch (binding.Type) {
+		case ShaderBindingType::Buffer:
+			elements.push_back(ResourceLayoutElement(ResourceType::Buffer, binding.Binding, binding.Space)); break;
+		case ShaderBindingType::GroupBuffer:
+			elements.push_back(ResourceLayoutElement(ResourceType::GroupBuffer, binding.Binding, binding.Space)); break;
+		case ShaderBindingType::Texture:
+			elements.push_back(ResourceLayoutElement(ResourceType::Texture, binding.Binding, binding.Space)); break;
+		default:
+			break;
+		}
+	}
+
+	return elements;
+}
+
+auto CodeRed::ShaderReflection::samplerBindings() const -> std::vector<ShaderBinding>
+{
+	std::vector<ShaderBinding> samplers;
+
+	for (const auto& binding : Bindings)
+		if (binding.Type == ShaderBindingType::Sampler) samplers.push_back(binding);
+
+	return samplers;
+}
+
+auto CodeRed::ShaderReflection::inputElements() const -> std::vector<InputLayoutElement>
+{
+	std::vector<InputLayoutElement> elements;
+
+	for (const auto& input : Inputs)
+		elements.push_back(InputLayoutElement(input.Name, input.Format));
+
+	return elements;
+}
+
+auto CodeRed::ShaderReflection::merge(
+	const ShaderReflection& first,
+	const ShaderReflection& second) -> ShaderReflection
+{
+	ShaderReflection reflection = first;
+
+	//the binding used by both shaders only need one element
+	for (const auto& binding : second.Bindings) {
+		const auto it = std::find_if(reflection.Bindings.begin(), reflection.Bindings.end(),
+			[&](const ShaderBinding& value)
+			{
+				return value.Binding == binding.Binding && value.Space == binding.Space;
+			});
+
+		if (it == reflection.Bindings.end()) reflection.Bindings.push_back(binding);
+	}
+
+	std::sort(reflection.Bindings.begin(), reflection.Bindings.end(),
+		[](const ShaderBinding& left, const ShaderBinding& right)
+		{
+			return left.Space != right.Space ? left.Space < right.Space : left.Binding < right.Binding;
+		});
+
+	//only the vertex shader has the input layout
+	if (reflection.Inputs.empty()) reflection.Inputs = second.Inputs;
+
+	reflection.Constant32Bits = std::max(first.Constant32Bits, second.Constant32Bits);
+
+	return reflection;
+}
+
+auto CodeRed::ShaderReflection::reflect(const std::vector<Byte>& code) -> ShaderReflection
+{
+	const auto hash = std::hash<std::string_view>()(
+		std::string_view(reinterpret_cast<const char*>(code.data()), code.size()));
+
+	{
+		std::lock_guard<std::mutex> lock(gShaderReflectionCacheMutex);
+
+		for (const auto& entry : gShaderReflectionCache)
+			if (entry.Hash == hash && entry.Code == code) return entry.Reflection;
+	}
+
+	const auto module = SpirV::parse(code);
+
+	ShaderReflection reflection;
+
+	for (const auto& variable : module.Variables) {
+		const auto& pointer = module.Types.at(variable.second);
+
+		//we only care the resources and inputs of shader
+		if (pointer.StorageClass != SpirV::Uniform &&
+			pointer.StorageClass != SpirV::StorageBuffer &&
+			pointer.StorageClass != SpirV::UniformConstant &&
+			pointer.StorageClass != SpirV::PushConstant &&
+			pointer.StorageClass != SpirV::Input) continue;
+
+		auto typeId = pointer.Element;
+
+		//the array of resources, we only need the type of element
+		while (pointer.StorageClass == SpirV::UniformConstant &&
+			(module.Types.at(typeId).Op == SpirV::OpTypeArray ||
+			module.Types.at(typeId).Op == SpirV::OpTypeRuntimeArray)) {
+			typeId = module.Types.at(typeId).Element;
+		}
+
+		const auto& type = module.Types.at(typeId);
+		const auto name = module.name(variable.first);
+		const auto binding = module.decoration(variable.first, SpirV::Binding);
+		const auto space = module.decoration(variable.first, SpirV::DescriptorSet);
+
+		switch (pointer.StorageClass) {
+		case SpirV::Uniform:
+		case SpirV::StorageBuffer: {
+			const auto isGroupBuffer = pointer.StorageClass == SpirV::StorageBuffer ||
+				module.decoration(typeId, SpirV::BufferBlock).has_value();
+
+			reflection.Bindings.push_back(ShaderBinding(
+				isGroupBuffer ? ShaderBindingType::GroupBuffer : ShaderBindingType::Buffer,
+				name,
+				binding.value_or(0),
+				space.value_or(0),
+				isGroupBuffer ? module.strideOf(typeId) : module.sizeOf(typeId)));
+			break;
+		}
+		case SpirV::UniformConstant: {
+			if (type.Op != SpirV::OpTypeImage && type.Op != SpirV::OpTypeSampledImage &&
+				type.Op != SpirV::OpTypeSampler) break;
+
+			reflection.Bindings.push_back(ShaderBinding(
+				type.Op == SpirV::OpTypeSampler ? ShaderBindingType::Sampler : ShaderBindingType::Texture,
+				name,
+				binding.value_or(0),
+				space.value_or(0),
+				0));
+			break;
+		}
+		case SpirV::PushConstant:
+			reflection.Constant32Bits = module.sizeOf(typeId) / sizeof(UInt32);
+			break;
+		case SpirV::Input: {
+			const auto location = module.decoration(variable.first, SpirV::Location);
+
+			//only the inputs of vertex shader are the input layout, the inputs of pixel shader are varyings
+			if (module.ExecutionModel != SpirV::Vertex) break;
+
+			//the built-in inputs(gl_VertexIndex and so on) do not have location
+			if (!location.has_value() || module.decoration(variable.first, SpirV::BuiltIn).has_value()) break;
+
+			reflection.Inputs.push_back(ShaderInput(
+				SpirV::semanticOf(name, location.value()),
+				SpirV::formatOf(module, typeId),
+				location.value()));
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	std::sort(reflection.Bindings.begin(), reflection.Bindings.end(),
+		[](const ShaderBinding& left, const ShaderBinding& right)
+		{
+			return left.Space != right.Space ? left.Space < right.Space : left.Binding < right.Binding;
+		});
+
+	std::sort(reflection.Inputs.begin(), reflection.Inputs.end(),
+		[](const ShaderInput& left, const ShaderInput& right) { return left.Location < right.Location; });
+
+	std::lock_guard<std::mutex> lock(gShaderReflectionCacheMutex);
+
+	if (gShaderReflectionCache.size() == gShaderReflectionCacheCapacity) gShaderReflectionCache.pop_front();
+
+	gShaderReflectionCache.push_back({ hash, code, reflection });
+
+	return reflection;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include <string>
+#include <vector>
+
+namespace CodeRed {
+
+	enum class ShaderBindingType : UInt32 {
+		Buffer = 0,
+		GroupBuffer = 1,
+		Texture = 2,
+		Sampler = 3
+	};
+
+	struct ShaderBinding {
+		ShaderBindingType Type = ShaderBindingType::Buffer;
+		std::string Name;
+
+		size_t Binding = 0;
+		size_t Space = 0;
+
+		//the size of constant buffer, or the size of element of group buffer
+		size_t Size = 0;
+
+		ShaderBinding() = default;
+
+		ShaderBinding(
+			const ShaderBindingType type,
+			const std::string& name,
+			const size_t binding,
+			const size_t space,
+			const size_t size) :
+			Type(type), Name(name), Binding(binding), Space(space), Size(size) {}
+	};
+
+	struct ShaderInput {
+		std::string Name;
+		PixelFormat Format = PixelFormat::RedGreenBlue32BitFloat;
+		size_t Location = 0;
+
+		ShaderInput() = default;
+
+		ShaderInput(
+			const std::string& name,
+			const PixelFormat format,
+			const size_t location) :
+			Name(name), Format(format), Location(location) {}
+	};
+
+	struct ShaderReflection {
+		std::vector<ShaderBinding> Bindings;
+		std::vector<ShaderInput> Inputs;
+
+		//the count of 32bit values in push constant block
+		size_t Constant32Bits = 0;
+
+		ShaderReflection() = default;
+
+		auto resourceElements() const -> std::vector<ResourceLayoutElement>;
+
+		auto samplerBindings() const -> std::vector<ShaderBinding>;
+
+		auto inputElements() const -> std::vector<InputLayoutElement>;
+
+		//merge the reflection of vertex shader and pixel shader
+		static auto merge(
+			const ShaderReflection& first,
+			const ShaderReflection& second) -> ShaderReflection;
+
+		//reflect the spir-v code, the result is cached with the code
+		//so reflecting the same code again is only a lookup
+		//only the vertex shader has inputs, and the inputs should have 32bit float components
+		static auto reflect(const std::vector<Byte>& code) -> ShaderReflection;
+	};
+
+}
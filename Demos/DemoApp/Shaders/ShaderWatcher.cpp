@@ -0,0 +1,372 @@
+#include "ShaderWatcher.hpp"
+#include "ShaderCompiler.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#include <unordered_set>
+#include <fstream>
+#include <regex>
+
+CodeRed::ShaderWatcher::ShaderWatcher(const std::shared_ptr<GpuLogicalDevice>& device) :
+	mDevice(device)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	mPipelineFactory = mDevice->createPipelineFactory();
+
+	//the stop event is used to wake up the watcher thread when we destroy the watcher
+#ifdef _WIN32
+	mStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+#else
+	mStopEvent = eventfd(0, EFD_CLOEXEC);
+#endif
+
+	mThread = std::thread([this]() { run(); });
+}
+
+CodeRed::ShaderWatcher::~ShaderWatcher()
+{
+	mRunning = false;
+
+#ifdef _WIN32
+	SetEvent(static_cast<HANDLE>(mStopEvent));
+
+	if (mThread.joinable()) mThread.join();
+
+	CloseHandle(static_cast<HANDLE>(mStopEvent));
+#else
+	const uint64_t value = 1;
+
+	write(mStopEvent, &value, sizeof(value));
+
+	if (mThread.joinable()) mThread.join();
+
+	close(mStopEvent);
+#endif
+}
+
+void CodeRed::ShaderWatcher::watch(
+	const std::shared_ptr<PipelineInfo>& pipelineInfo,
+	const ShaderType& type,
+	const std::string& fileName,
+	const std::string& entry)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		pipelineInfo == nullptr,
+		InvalidException<PipelineInfo>({ "pipeline info" })
+	);
+
+	ShaderSource source;
+
+	source.Pipeline = pipelineInfo;
+	source.Type = type;
+	source.FileName = fileName;
+	source.Entry = entry;
+	source.Files = dependencies(fileName);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mSources.push_back(source);
+	mDirectoriesChanged = true;
+}
+
+void CodeRed::ShaderWatcher::update()
+{
+	std::vector<CompiledShader> compiledShaders;
+
+	//the watcher thread only holds the lock to push the compiled shaders
+	//so we will not wait for any compiling
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (mCompiledShaders.empty()) return;
+
+		compiledShaders.swap(mCompiledShaders);
+	}
+
+	std::unordered_set<std::shared_ptr<PipelineInfo>> pipelines;
+
+	for (const auto& shader : compiledShaders) {
+		if (shader.Type == ShaderType::Vertex) shader.Pipeline->setVertexShaderState(shader.State);
+		if (shader.Type == ShaderType::Pixel) shader.Pipeline->setPixelShaderState(shader.State);
+
+		pipelines.insert(shader.Pipeline);
+	}
+
+	//a pipeline info may have more than one shader changed, we only rebuild it once
+	//we keep drawing with the old pipeline until the new one is created
+	for (const auto& pipeline : pipelines) pipeline->updateStateAsync();
+}
+
+#ifdef _WIN32
+
+void CodeRed::ShaderWatcher::run()
+{
+	std::vector<HANDLE> notifications;
+
+	const auto closeNotifications = [&]()
+	{
+		for (auto& notification : notifications) FindCloseChangeNotification(notification);
+
+		notifications.clear();
+	};
+
+	while (mRunning == true) {
+		//when a new shader is watched, the directories we need to watch may be changed
+		//so we rebuild the notifications of all directories
+		if (mDirectoriesChanged.exchange(false) == true) {
+			std::unordered_set<std::string> directories;
+
+			closeNotifications();
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				for (const auto& source : mSources) {
+					for (const auto& file : source.Files) {
+						const auto directory = std::filesystem::absolute(file.first).parent_path();
+
+						directories.insert(directory.string());
+					}
+				}
+			}
+
+			for (const auto& directory : directories) {
+				const auto notification = FindFirstChangeNotification(
+					directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+				if (notification != INVALID_HANDLE_VALUE) notifications.push_back(notification);
+			}
+		}
+
+		//the first handle is the stop event, we can wait 63 directories at most
+		std::vector<HANDLE> handles = { static_cast<HANDLE>(mStopEvent) };
+
+		handles.insert(handles.end(), notifications.begin(),
+			notifications.begin() + std::min(notifications.size(), static_cast<size_t>(MAXIMUM_WAIT_OBJECTS - 1)));
+
+		//we use a timeout to check if there are new directories to watch
+		const auto result = WaitForMultipleObjects(
+			static_cast<DWORD>(handles.size()), handles.data(), FALSE, 250);
+
+		if (mRunning == false) break;
+		if (result == WAIT_TIMEOUT || result == WAIT_FAILED) continue;
+
+		FindNextChangeNotification(handles[result - WAIT_OBJECT_0]);
+
+		reload();
+	}
+
+	closeNotifications();
+}
+
+#else
+
+void CodeRed::ShaderWatcher::run()
+{
+	const auto notification = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	std::vector<int> watches;
+
+	const auto closeWatches = [&]()
+	{
+		for (auto& watch : watches) inotify_rm_watch(notification, watch);
+
+		watches.clear();
+	};
+
+	while (mRunning == true) {
+		//when a new shader is watched, the directories we need to watch may be changed
+		//so we rebuild the watches of all directories
+		if (mDirectoriesChanged.exchange(false) == true) {
+			std::unordered_set<std::string> directories;
+
+			closeWatches();
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+
+				for (const auto& source : mSources) {
+					for (const auto& file : source.Files) {
+						const auto directory = std::filesystem::absolute(file.first).parent_path();
+
+						directories.insert(directory.string());
+					}
+				}
+			}
+
+			//the editors may write a temporary file and rename it, so we watch the moves too
+			for (const auto& directory : directories) {
+				const auto watch = inotify_add_watch(notification, directory.c_str(),
+					IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+				if (watch != -1) watches.push_back(watch);
+			}
+		}
+
+		pollfd descriptors[2] = {
+			{ mStopEvent, POLLIN, 0 },
+			{ notification, POLLIN, 0 }
+		};
+
+		//we use a timeout to check if there are new directories to watch
+		const auto result = poll(descriptors, 2, 250);
+
+		if (mRunning == false) break;
+		if (result <= 0 || (descriptors[1].revents & POLLIN) == 0) continue;
+
+		//we do not care which file is changed, isChanged() finds the shaders to compile
+		//so we only drain the events
+		alignas(inotify_event) char events[4096];
+
+		while (read(notification, events, sizeof(events)) > 0) {}
+
+		reload();
+	}
+
+	closeWatches();
+	close(notification);
+}
+
+#endif
+
+void CodeRed::ShaderWatcher::reload()
+{
+	//the file system and the include scanning are slow, and update() needs the lock on the render thread
+	//so we copy the sources under the lock, and find the changed shaders and their dependencies without it
+	std::vector<ShaderSource> sources;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		sources = mSources;
+	}
+
+	std::vector<size_t> changedSources;
+
+	for (size_t index = 0; index < sources.size(); index++) {
+		if (isChanged(sources[index]) == false) continue;
+
+		sources[index].Files = dependencies(sources[index].FileName);
+
+		changedSources.push_back(index);
+	}
+
+	if (changedSources.empty()) return;
+
+	//the sources are only appended, so the index of source is not changed after we copied them
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (const auto index : changedSources) mSources[index].Files = sources[index].Files;
+	}
+
+	//the includes of the shader may be changed, so we need rebuild the notifications
+	mDirectoriesChanged = true;
+
+	for (const auto index : changedSources) {
+		const auto& source = sources[index];
+
+		try {
+			const auto code = compile(source.Type, ShaderCompiler::readShader(source.FileName), source.Entry);
+
+			if (code.empty()) continue;
+
+			CompiledShader shader;
+
+			shader.Pipeline = source.Pipeline;
+			shader.Type = source.Type;
+			shader.State = mPipelineFactory->createShaderState(source.Type, code, source.Entry);
+
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			mCompiledShaders.push_back(std::move(shader));
+		}
+		catch (...) {
+			//if we failed to compile the shader, we keep the old one
+			//the compiler has reported the error message
+			DebugReport::error("reload shader \"" + source.FileName + "\" failed.");
+		}
+	}
+}
+
+auto CodeRed::ShaderWatcher::compile(const ShaderType& type, const std::string& text, const std::string& entry) const
+	-> std::vector<Byte>
+{
+	if (mDevice->apiVersion() == APIVersion::DirectX12) {
+#ifdef __ENABLE__DIRECTX12__
+		return ShaderCompiler::compileToCso(type, text, entry);
+#endif
+	}
+
+	if (mDevice->apiVersion() == APIVersion::Vulkan) {
+#ifdef __ENABLE__VULKAN__
+		return ShaderCompiler::compileToSpv(type, text);
+#endif
+	}
+
+	return {};
+}
+
+auto CodeRed::ShaderWatcher::isChanged(const ShaderSource& source) -> bool
+{
+	std::error_code error;
+
+	for (const auto& file : source.Files) {
+		const auto time = std::filesystem::last_write_time(file.first, error);
+
+		//the editor may remove the file and write a new one
+		//so we ignore the file that we can not access now
+		if (!error && time != file.second) return true;
+	}
+
+	return false;
+}
+
+auto CodeRed::ShaderWatcher::dependencies(const std::string& fileName)
+	-> std::vector<std::pair<std::string, FileTime>>
+{
+	static const std::regex includeRegex(R"(^\s*#\s*include\s*["<]([^">]+)[">])");
+
+	std::vector<std::pair<std::string, FileTime>> files;
+	std::unordered_set<std::string> visited;
+	std::vector<std::filesystem::path> stack = { fileName };
+
+	//we walk the "#include" directives of the shader and its includes
+	//the include file is relative to the file that includes it
+	while (!stack.empty()) {
+		const auto path = stack.back(); stack.pop_back();
+
+		std::error_code error;
+
+		const auto time = std::filesystem::last_write_time(path, error);
+
+		if (error || visited.insert(path.lexically_normal().string()).second == false) continue;
+
+		files.push_back({ path.string(), time });
+
+		std::ifstream file(path);
+		std::string line;
+		std::smatch match;
+
+		while (std::getline(file, line)) {
+			if (!std::regex_search(line, match, includeRegex)) continue;
+
+			const auto include = path.parent_path() / match[1].str();
+
+			stack.push_back(std::filesystem::exists(include) ? include : std::filesystem::path(match[1].str()));
+		}
+	}
+
+	return files;
+}
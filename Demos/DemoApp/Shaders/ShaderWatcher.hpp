@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../Pipelines/PipelineInfo.hpp"
+
+#include <filesystem>
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+namespace CodeRed {
+
+	class ShaderWatcher final : public Noncopyable {
+	public:
+		explicit ShaderWatcher(
+			const std::shared_ptr<GpuLogicalDevice>& device);
+
+		~ShaderWatcher();
+
+		void watch(
+			const std::shared_ptr<PipelineInfo>& pipelineInfo,
+			const ShaderType& type,
+			const std::string& fileName,
+			const std::string& entry = "main");
+
+		//give the shaders that finished compiling to their pipeline infos
+		//the pipelines are created on worker threads, the pipeline info swaps them in
+		//when updatePendingState() finds they are ready, so the render thread never waits for them
+		void update();
+	private:
+		using FileTime = std::filesystem::file_time_type;
+
+		struct ShaderSource {
+			std::shared_ptr<PipelineInfo> Pipeline;
+			ShaderType Type = ShaderType::Vertex;
+			std::string FileName;
+			std::string Entry;
+
+			//the source file and the files it includes with their last write time
+			std::vector<std::pair<std::string, FileTime>> Files;
+		};
+
+		struct CompiledShader {
+			std::shared_ptr<PipelineInfo> Pipeline;
+			ShaderType Type = ShaderType::Vertex;
+
+			//the shader state is created on the watcher thread, it only copies the code
+			std::shared_ptr<GpuShaderState> State;
+		};
+
+		void run();
+
+		//compile the shaders whose source or dependencies are changed
+		void reload();
+
+		auto compile(const ShaderType& type, const std::string& text, const std::string& entry) const
+			-> std::vector<Byte>;
+
+		static auto isChanged(const ShaderSource& source) -> bool;
+
+		static auto dependencies(const std::string& fileName)
+			-> std::vector<std::pair<std::string, FileTime>>;
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+		std::shared_ptr<GpuPipelineFactory> mPipelineFactory;
+
+		std::vector<ShaderSource> mSources;
+		std::vector<CompiledShader> mCompiledShaders;
+
+		std::atomic<bool> mDirectoriesChanged = false;
+
+		//the watcher thread runs until the watcher is destroyed
+		std::atomic<bool> mRunning = true;
+
+#ifdef _WIN32
+		void* mStopEvent = nullptr;
+#else
+		//the eventfd to wake up the watcher thread
+		int mStopEvent = -1;
+#endif
+
+		std::thread mThread;
+		std::mutex mMutex;
+	};
+
+}
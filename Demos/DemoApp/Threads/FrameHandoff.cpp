@@ -0,0 +1,90 @@
+#include "FrameHandoff.hpp"
+
+CodeRed::FrameHandoff::FrameHandoff(const size_t slots) :
+	mSlots(slots)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		mSlots == 0,
+		InvalidException<size_t>({ "slots" })
+	);
+
+	reset();
+}
+
+auto CodeRed::FrameHandoff::acquireWrite() -> size_t
+{
+	return acquire(mFreeSlots);
+}
+
+void CodeRed::FrameHandoff::submitWrite(const size_t slot)
+{
+	release(mSubmittedSlots, slot);
+}
+
+auto CodeRed::FrameHandoff::acquireRead() -> size_t
+{
+	return acquire(mSubmittedSlots);
+}
+
+void CodeRed::FrameHandoff::releaseRead(const size_t slot)
+{
+	release(mFreeSlots, slot);
+}
+
+void CodeRed::FrameHandoff::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mStopped = true;
+	}
+
+	mCondition.notify_all();
+}
+
+void CodeRed::FrameHandoff::reset()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mFreeSlots = SlotQueue();
+	mSubmittedSlots = SlotQueue();
+
+	mFreeSlots.Slots.resize(mSlots);
+	mSubmittedSlots.Slots.resize(mSlots);
+
+	for (size_t index = 0; index < mSlots; index++) mFreeSlots.push(index);
+
+	mStopped = false;
+}
+
+auto CodeRed::FrameHandoff::acquire(SlotQueue& queue) -> size_t
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	mCondition.wait(lock, [&]() { return mStopped || !queue.empty(); });
+
+	if (mStopped) return invalidSlot;
+
+	return queue.pop();
+}
+
+void CodeRed::FrameHandoff::release(SlotQueue& queue, const size_t slot)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		slot >= mSlots,
+		InvalidException<size_t>({ "slot" })
+	);
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		CODE_RED_DEBUG_THROW_IF(
+			queue.Count == mSlots,
+			Exception(DebugReport::makeError("the slot is released more than once."))
+		);
+
+		queue.push(slot);
+	}
+
+	mCondition.notify_all();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include <condition_variable>
+#include <vector>
+#include <mutex>
+
+namespace CodeRed {
+
+	/*
+	 * the bounded queue of frame slots between a producer thread and a consumer thread
+	 * 1. the producer acquires a free slot, writes the state of frame into it and submits it
+	 * 2. the consumer acquires the oldest submitted slot, reads it and releases it
+	 * the slots are handed off in order, and the producer waits when all slots are submitted or read
+	 * after stop(), the waiting threads wake up and acquire returns invalidSlot
+	 */
+	class FrameHandoff final : public Noncopyable {
+	public:
+		explicit FrameHandoff(const size_t slots = 2);
+
+		~FrameHandoff() = default;
+
+		auto acquireWrite() -> size_t;
+
+		void submitWrite(const size_t slot);
+
+		auto acquireRead() -> size_t;
+
+		void releaseRead(const size_t slot);
+
+		void stop();
+
+		void reset();
+
+		auto slots() const noexcept -> size_t { return mSlots; }
+
+		static constexpr size_t invalidSlot = static_cast<size_t>(-1);
+	private:
+		//the ring of slot indices, the capacity is the number of slots, so it never allocates after reset
+		struct SlotQueue {
+			std::vector<size_t> Slots;
+
+			size_t Head = 0;
+			size_t Count = 0;
+
+			auto empty() const noexcept -> bool { return Count == 0; }
+
+			void push(const size_t slot) { Slots[(Head + Count) % Slots.size()] = slot; Count++; }
+
+			auto pop() -> size_t { const auto slot = Slots[Head]; Head = (Head + 1) % Slots.size(); Count--; return slot; }
+		};
+
+		auto acquire(SlotQueue& queue) -> size_t;
+
+		void release(SlotQueue& queue, const size_t slot);
+	private:
+		size_t mSlots;
+
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+
+		SlotQueue mFreeSlots;
+		SlotQueue mSubmittedSlots;
+
+		bool mStopped = false;
+	};
+	
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace CodeRed {
+
+	template <typename Signature>
+	class FunctionReference;
+
+	//the non-owning reference of a callable object, it is two pointers and never allocates
+	//std::function copies the callable and may allocate if the captures are large
+	//only use it when the callable lives longer than the reference(for example, the caller waits for the call)
+	template <typename Result, typename... Arguments>
+	class FunctionReference<Result(Arguments...)> {
+	public:
+		template <typename Function, typename = std::enable_if_t<
+			!std::is_same_v<std::decay_t<Function>, FunctionReference>>>
+		FunctionReference(const Function& function) noexcept :
+			mFunction(&function),
+			mInvoke([](const void* function, Arguments... arguments) -> Result
+				{
+					return (*static_cast<const Function*>(function))(std::forward<Arguments>(arguments)...);
+				}) {}
+
+		auto operator()(Arguments... arguments) const -> Result
+		{
+			return mInvoke(mFunction, std::forward<Arguments>(arguments)...);
+		}
+	private:
+		const void* mFunction;
+
+		Result (*mInvoke)(const void* function, Arguments... arguments);
+	};
+	
+}
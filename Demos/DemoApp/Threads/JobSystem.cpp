@@ -0,0 +1,154 @@
+#include "JobSystem.hpp"
+
+#include "../Profiling/Profiler.hpp"
+
+#include <algorithm>
+
+CodeRed::JobSystem::JobSystem(const size_t threads)
+{
+	for (size_t index = 0; index < threads; index++)
+		mThreads.push_back(std::thread([this]() { workerLoop(); }));
+
+	//a worker may not be scheduled until the warmup frames are over(for example, on one core)
+	//so we wait for them, the first zone of worker does not allocate in the steady state
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	mFinishCondition.wait(lock, [&]() { return mStartedWorkers == mThreads.size(); });
+}
+
+CodeRed::JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mExit = true;
+	}
+
+	mStartCondition.notify_all();
+
+	for (auto& thread : mThreads) thread.join();
+}
+
+void CodeRed::JobSystem::parallelFor(const size_t count, const Job& job)
+{
+	parallelFor(count, 1, job);
+}
+
+void CodeRed::JobSystem::parallelFor(const size_t count, const size_t minItems, const Job& job)
+{
+	if (count == 0) return;
+
+	const auto jobs = std::min(workers(), std::max(count / std::max(minItems, static_cast<size_t>(1)), static_cast<size_t>(1)));
+
+	//only one job, we do not need to wake up the workers
+	if (jobs == 1) { job(JobRange(0, 1, 0, count)); return; }
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	//a worker may still be checking the jobs of last dispatch
+	mFinishCondition.wait(lock, [&]() { return mActiveWorkers == 0; });
+
+	mJob = &job;
+	mItems = count;
+	mJobs = jobs;
+	mNextJob = 0;
+	mFinishedJobs = 0;
+	mGeneration++;
+
+	lock.unlock();
+
+	mStartCondition.notify_all();
+
+	const auto finished = runJobs();
+
+	lock.lock();
+
+	mFinishedJobs = mFinishedJobs + finished;
+
+	mFinishCondition.wait(lock, [&]() { return mFinishedJobs == mJobs; });
+
+	mJob = nullptr;
+
+	//the workers do not touch the dispatch after all jobs are finished, so we can throw now
+	if (mException != nullptr) {
+		const auto exception = mException;
+
+		mException = nullptr;
+
+		std::rethrow_exception(exception);
+	}
+}
+
+auto CodeRed::JobSystem::defaultThreads() -> size_t
+{
+	const auto cores = static_cast<size_t>(std::thread::hardware_concurrency());
+
+	//the thread that dispatches jobs is a worker too
+	return cores > 1 ? cores - 1 : 0;
+}
+
+void CodeRed::JobSystem::workerLoop()
+{
+	//a worker may not get a job in the warmup frames, so it registers before the first job
+	Profiler::registerThread();
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mStartedWorkers++;
+	}
+
+	mFinishCondition.notify_all();
+
+	size_t generation = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+
+			mStartCondition.wait(lock, [&]() { return mExit || mGeneration != generation; });
+
+			if (mExit) return;
+
+			generation = mGeneration;
+			mActiveWorkers++;
+		}
+
+		const auto finished = runJobs();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			mFinishedJobs = mFinishedJobs + finished;
+			mActiveWorkers--;
+		}
+
+		mFinishCondition.notify_all();
+	}
+}
+
+auto CodeRed::JobSystem::runJobs() -> size_t
+{
+	size_t finished = 0;
+
+	//the workers take the jobs until all jobs are taken
+	//so a slow worker does not delay the jobs it did not take
+	for (auto index = mNextJob++; index < mJobs; index = mNextJob++) {
+		const auto begin = mItems * index / mJobs;
+		const auto end = mItems * (index + 1) / mJobs;
+
+		//the job that throws is finished too, otherwise parallelFor would wait it forever
+		try {
+			(*mJob)(JobRange(index, mJobs, begin, end));
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if (mException == nullptr) mException = std::current_exception();
+		}
+
+		finished++;
+	}
+
+	return finished;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include "FunctionReference.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+namespace CodeRed {
+
+	//the range of items that a job handles, [Begin, End)
+	//the job with index 0 is always executed by the thread that calls parallelFor
+	struct JobRange {
+		size_t Index = 0;
+		size_t Count = 0;
+
+		size_t Begin = 0;
+		size_t End = 0;
+
+		JobRange() = default;
+
+		JobRange(
+			const size_t index,
+			const size_t count,
+			const size_t begin,
+			const size_t end) :
+			Index(index), Count(count), Begin(begin), End(end) {}
+
+		auto first() const noexcept -> bool { return Index == 0; }
+
+		auto last() const noexcept -> bool { return Index + 1 == Count; }
+	};
+
+	//a fixed number of worker threads that run parallelFor
+	//the thread calling parallelFor works as well, so workers() is the number of threads plus one
+	//parallelFor is not reentrant, only one thread can dispatch jobs at the same time
+	class JobSystem final : public Noncopyable {
+	public:
+		//parallelFor waits for the jobs, so the job is referenced instead of copied
+		using Job = FunctionReference<void(const JobRange& range)>;
+		
+		explicit JobSystem(
+			const size_t threads = defaultThreads());
+
+		~JobSystem();
+
+		//split [0, count) into at most workers() jobs with continuous ranges and wait them
+		//the jobs are executed in any order, but the job index is the order of ranges
+		//if jobs throw, the other jobs still run and the first exception is thrown after all jobs are done
+		void parallelFor(const size_t count, const Job& job);
+
+		//split [0, count) into jobs and every job has at least minItems items
+		void parallelFor(const size_t count, const size_t minItems, const Job& job);
+
+		auto workers() const noexcept -> size_t { return mThreads.size() + 1; }
+
+		static auto defaultThreads() -> size_t;
+	private:
+		void workerLoop();
+
+		//return the number of jobs this thread executed
+		auto runJobs() -> size_t;
+	private:
+		std::vector<std::thread> mThreads;
+
+		std::mutex mMutex;
+		std::condition_variable mStartCondition;
+		std::condition_variable mFinishCondition;
+
+		//the jobs of current dispatch, they are written by the dispatching thread with mutex
+		const Job* mJob = nullptr;
+
+		size_t mItems = 0;
+		size_t mJobs = 0;
+
+		std::atomic<size_t> mNextJob = 0;
+		size_t mFinishedJobs = 0;
+
+		//the first exception thrown by the jobs of current dispatch
+		std::exception_ptr mException;
+
+		//the workers that are taking jobs, we can not start a new dispatch until they are done
+		size_t mActiveWorkers = 0;
+
+		//the workers that are registered to profiler, the constructor waits for all of them
+		size_t mStartedWorkers = 0;
+		
+		//the workers wake up when the generation is changed
+		size_t mGeneration = 0;
+
+		bool mExit = false;
+	};
+	
+}
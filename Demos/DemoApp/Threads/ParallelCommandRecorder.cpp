@@ -0,0 +1,64 @@
+#include "ParallelCommandRecorder.hpp"
+
+#include <algorithm>
+
+CodeRed::ParallelCommandRecorder::ParallelCommandRecorder(
+	const std::shared_ptr<GpuLogicalDevice>& device,
+	const std::shared_ptr<JobSystem>& jobSystem,
+	const size_t framesInFlight) :
+	mDevice(device), mJobSystem(jobSystem), mFrames(framesInFlight)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		device == nullptr,
+		InvalidException<GpuLogicalDevice>({ "device" })
+	);
+
+	CODE_RED_DEBUG_THROW_IF(
+		jobSystem == nullptr,
+		InvalidException<JobSystem>({ "jobSystem" })
+	);
+
+	//the command allocator can not be used by two threads at the same time
+	//so every job has its own allocator
+	for (auto& frame : mFrames) {
+		for (size_t index = 0; index < mJobSystem->workers(); index++) {
+			frame.Allocators.push_back(mDevice->createCommandAllocator());
+			frame.CommandLists.push_back(mDevice->createGraphicsCommandList(frame.Allocators.back()));
+		}
+
+		frame.Recorded.reserve(frame.CommandLists.size());
+	}
+}
+
+auto CodeRed::ParallelCommandRecorder::record(
+	const size_t frameIndex,
+	const size_t count,
+	const size_t minItems,
+	const Record& record) -> const std::vector<std::shared_ptr<GpuGraphicsCommandList>>&
+{
+	auto& frame = mFrames[frameIndex];
+
+	//we record one job at least, so the record function can record the commands that do not depend on items
+	const auto jobs = std::max(std::min(mJobSystem->workers(), count / std::max(minItems, static_cast<size_t>(1))),
+		static_cast<size_t>(1));
+
+	mJobSystem->parallelFor(jobs, [&](const JobRange& jobRange)
+		{
+			for (auto job = jobRange.Begin; job < jobRange.End; job++) {
+				const auto& allocator = frame.Allocators[job];
+				const auto& commandList = frame.CommandLists[job];
+
+				allocator->reset();
+
+				commandList->beginRecording();
+
+				record(commandList, JobRange(job, jobs, count * job / jobs, count * (job + 1) / jobs));
+
+				commandList->endRecording();
+			}
+		});
+
+	frame.Recorded.assign(frame.CommandLists.begin(), frame.CommandLists.begin() + jobs);
+
+	return frame.Recorded;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+namespace CodeRed {
+
+	//record the commands of a frame into a command list per job on the workers of job system
+	//every frame slot has its own allocators and command lists, so the frames in flight are not reset
+	//the command lists are returned in the order of ranges, execute them in one call to keep the order
+	class ParallelCommandRecorder final : public Noncopyable {
+	public:
+		using Record = FunctionReference<void(
+			const std::shared_ptr<GpuGraphicsCommandList>& commandList,
+			const JobRange& range)>;
+
+		explicit ParallelCommandRecorder(
+			const std::shared_ptr<GpuLogicalDevice>& device,
+			const std::shared_ptr<JobSystem>& jobSystem,
+			const size_t framesInFlight = 2);
+
+		//the command lists are began and ended by the recorder, the record function only records commands
+		//please make sure the GPU finished the frame that used this slot before(for example, FramePacer::beginFrame)
+		//the returned command lists are valid until the next record of this frame slot
+		auto record(
+			const size_t frameIndex,
+			const size_t count,
+			const size_t minItems,
+			const Record& record) -> const std::vector<std::shared_ptr<GpuGraphicsCommandList>>&;
+
+		auto jobSystem() const noexcept -> std::shared_ptr<JobSystem> { return mJobSystem; }
+	private:
+		struct FrameCommands {
+			std::vector<std::shared_ptr<GpuCommandAllocator>> Allocators;
+			std::vector<std::shared_ptr<GpuGraphicsCommandList>> CommandLists;
+
+			//the command lists recorded in this frame, the capacity is reserved so it does not allocate
+			std::vector<std::shared_ptr<GpuGraphicsCommandList>> Recorded;
+		};
+	private:
+		std::shared_ptr<GpuLogicalDevice> mDevice;
+		std::shared_ptr<JobSystem> mJobSystem;
+
+		std::vector<FrameCommands> mFrames;
+	};
+	
+}
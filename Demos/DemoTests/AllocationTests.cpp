@@ -0,0 +1,59 @@
+#include "Test.hpp"
+
+#include <Profiling/AllocationCounter.hpp>
+#include <Profiling/Profiler.hpp>
+#include <Resources/FramePacer.hpp>
+#include <Threads/JobSystem.hpp>
+
+#include <atomic>
+
+//the parts of the frame loop that do not need a device, the demos run them every frame
+//so after the warmup frames they should not allocate, the demos check the rest with --max-allocations 0
+DEMO_TEST("The frame loop helpers do not allocate in steady state")
+{
+	const auto fence = std::make_shared<CodeRed::SimulatedFrameFence>(std::chrono::milliseconds(0));
+
+	CodeRed::FramePacer pacer(nullptr, fence, 3);
+	CodeRed::JobSystem jobSystem(3);
+
+	std::vector<CodeRed::ProfileZoneStats> stats;
+	std::atomic<size_t> items = 0;
+
+	const auto runFrame = [&]()
+	{
+		CODE_RED_PROFILE_ZONE("AllocationTests::Frame");
+
+		pacer.beginFrame();
+
+		jobSystem.parallelFor(1000, 64, [&](const CodeRed::JobRange& range)
+			{
+				CODE_RED_PROFILE_ZONE("AllocationTests::Job");
+
+				items += range.End - range.Begin;
+			});
+
+		pacer.endFrame();
+	};
+
+	CodeRed::Profiler::clear();
+
+	//the warmup frames register the zones and threads, and fill the scratch memory
+	for (size_t frame = 0; frame < 100; frame++) {
+		runFrame();
+
+		CodeRed::Profiler::collect();
+		CodeRed::Profiler::stats(stats);
+	}
+
+	const auto allocations = CodeRed::AllocationCounter::allocations();
+
+	for (size_t frame = 0; frame < 1000; frame++) {
+		runFrame();
+
+		CodeRed::Profiler::collect();
+		CodeRed::Profiler::stats(stats);
+	}
+
+	DEMO_CHECK(CodeRed::AllocationCounter::allocations() == allocations);
+	DEMO_CHECK(items == 1100 * 1000);
+}
@@ -0,0 +1,57 @@
+#include "Test.hpp"
+
+#include <Profiling/BenchmarkReport.hpp>
+
+static auto regressed(const std::vector<Demo::BenchmarkRegression>& regressions, const std::string& name) -> bool
+{
+	for (const auto& regression : regressions) {
+		if (regression.Name == name) return true;
+	}
+
+	return false;
+}
+
+DEMO_TEST("BenchmarkReport ignores the changes of time under the floor")
+{
+	Demo::BenchmarkReport baseline("Test", 100);
+	Demo::BenchmarkReport current("Test", 100);
+
+	//the tiny phase triples, but it is only 0.02 ms slower
+	baseline.add("simulate.p50", 0.01);
+	current.add("simulate.p50", 0.03);
+
+	//the phase is slower than the tolerance and the floor
+	baseline.add("render.p50", 1.0);
+	current.add("render.p50", 1.2);
+
+	//the allocations have no floor, one more allocation is a regression
+	baseline.add("allocations.mean", 0);
+	current.add("allocations.mean", 1);
+
+	const auto regressions = current.compare(baseline, 0.1);
+
+	DEMO_CHECK(!regressed(regressions, "simulate.p50"));
+	DEMO_CHECK(regressed(regressions, "render.p50"));
+	DEMO_CHECK(regressed(regressions, "allocations.mean"));
+}
+
+DEMO_TEST("BenchmarkReport does not gate the wait and the max of times")
+{
+	Demo::BenchmarkReport baseline("Test", 100);
+	Demo::BenchmarkReport current("Test", 100);
+
+	baseline.add("wait.p50", 1.0);
+	current.add("wait.p50", 10.0);
+
+	baseline.add("frame.max", 1.0);
+	current.add("frame.max", 10.0);
+
+	baseline.add("allocations.max", 0);
+	current.add("allocations.max", 1);
+
+	const auto regressions = current.compare(baseline, 0.1);
+
+	DEMO_CHECK(!regressed(regressions, "wait.p50"));
+	DEMO_CHECK(!regressed(regressions, "frame.max"));
+	DEMO_CHECK(regressed(regressions, "allocations.max"));
+}
@@ -0,0 +1,59 @@
+#include "Test.hpp"
+
+#include <Resources/FramePacer.hpp>
+
+//the simulated GPU needs 50ms for a frame, the CPU records a frame at once
+//so the CPU runs ahead until all slots are in flight
+static const auto frameDelay = std::chrono::milliseconds(50);
+
+DEMO_TEST("FramePacer does not block until all slots are in flight")
+{
+	const auto fence = std::make_shared<CodeRed::SimulatedFrameFence>(frameDelay);
+
+	CodeRed::FramePacer pacer(nullptr, fence, 3);
+
+	for (size_t frame = 0; frame < 3; frame++) {
+		DEMO_CHECK(pacer.beginFrame() == frame);
+
+		pacer.endFrame();
+	}
+
+	DEMO_CHECK(fence->blockedWaits() == 0);
+}
+
+DEMO_TEST("FramePacer only waits the frame that used the slot")
+{
+	const auto fence = std::make_shared<CodeRed::SimulatedFrameFence>(frameDelay);
+
+	CodeRed::FramePacer pacer(nullptr, fence, 3);
+
+	for (size_t frame = 0; frame < 3; frame++) {
+		pacer.beginFrame();
+		pacer.endFrame();
+	}
+
+	//the fourth frame reuses the slot 0, it waits the first frame and the others are still in flight
+	DEMO_CHECK(pacer.beginFrame() == 0);
+	DEMO_CHECK(fence->blockedWaits() == 1);
+	DEMO_CHECK(fence->completedValue() >= 1);
+	DEMO_CHECK(fence->completedValue() < 3);
+
+	pacer.endFrame();
+}
+
+DEMO_TEST("FramePacer waitIdle finishes all frames")
+{
+	const auto fence = std::make_shared<CodeRed::SimulatedFrameFence>(frameDelay);
+
+	CodeRed::FramePacer pacer(nullptr, fence, 3);
+
+	for (size_t frame = 0; frame < 5; frame++) {
+		pacer.beginFrame();
+		pacer.endFrame();
+	}
+
+	pacer.waitIdle();
+
+	DEMO_CHECK(pacer.frameCount() == 5);
+	DEMO_CHECK(fence->completedValue() == 5);
+}
@@ -0,0 +1,62 @@
+#include "Test.hpp"
+
+#include <Resources/FrameResources.hpp>
+
+#include <chrono>
+#include <iostream>
+
+DEMO_TEST("FrameResources key and name find the same resource")
+{
+	const CodeRed::FrameResourceKey<int> key("FrameResourcesTests.Value");
+
+	CodeRed::FrameResources resources;
+
+	const auto value = std::make_shared<int>(7);
+
+	resources.set(key, value);
+
+	DEMO_CHECK(resources.get(key) == value);
+	DEMO_CHECK(resources.get<int>("FrameResourcesTests.Value") == value);
+	DEMO_CHECK(key.index() == CodeRed::FrameResources::intern("FrameResourcesTests.Value"));
+}
+
+DEMO_TEST("FrameResources key and name lookup timings")
+{
+	//the frame resources of a demo, the names are as long as the names we use in demos
+	const std::vector<std::string> names = {
+		"FrameBuffer", "DescriptorHeap", "VertexBuffer", "TransformedPositions", "Colors", "Instance"
+	};
+
+	std::vector<CodeRed::FrameResourceKey<int>> keys;
+	CodeRed::FrameResources resources;
+
+	for (const auto& name : names) {
+		keys.push_back(CodeRed::FrameResourceKey<int>(name));
+		resources.set(keys.back(), std::make_shared<int>(static_cast<int>(keys.size())));
+	}
+
+	const size_t iterations = 200000;
+
+	const auto measure = [&](const auto& lookup) {
+		long long sum = 0;
+
+		const auto begin = std::chrono::high_resolution_clock::now();
+
+		for (size_t iteration = 0; iteration < iterations; iteration++) {
+			for (size_t index = 0; index < names.size(); index++) sum = sum + *lookup(index);
+		}
+
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		//the sum keeps the lookups, so the compiler can not remove them
+		DEMO_CHECK(sum == static_cast<long long>(iterations) * 21);
+
+		return std::chrono::duration<double, std::nano>(end - begin).count() / (iterations * names.size());
+	};
+
+	const auto keyTime = measure([&](const size_t index) { return resources.get(keys[index]); });
+	const auto nameTime = measure([&](const size_t index) { return resources.get<int>(names[index]); });
+
+	//the timings depend on the machine, so we only print them and do not check them
+	std::cout << "FrameResources::get: key " << keyTime << " ns, name " << nameTime << " ns" << std::endl;
+}
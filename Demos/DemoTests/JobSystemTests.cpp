@@ -0,0 +1,73 @@
+#include "Test.hpp"
+
+#include <Threads/JobSystem.hpp>
+
+#include <stdexcept>
+
+DEMO_TEST("JobSystem covers the range with continuous jobs")
+{
+	CodeRed::JobSystem jobSystem(3);
+
+	std::vector<size_t> owners(1000, 0);
+
+	jobSystem.parallelFor(owners.size(), [&](const CodeRed::JobRange& range)
+		{
+			for (auto index = range.Begin; index < range.End; index++) owners[index] = range.Index + 1;
+		});
+
+	//every item is handled once, and the job index is the order of ranges
+	for (size_t index = 1; index < owners.size(); index++) {
+		DEMO_CHECK(owners[index] != 0);
+		DEMO_CHECK(owners[index] >= owners[index - 1]);
+	}
+
+	DEMO_CHECK(owners.front() == 1);
+	DEMO_CHECK(owners.back() == jobSystem.workers());
+}
+
+DEMO_TEST("JobSystem throws the exception of job after all jobs are finished")
+{
+	CodeRed::JobSystem jobSystem(3);
+
+	std::atomic<size_t> finishedJobs = 0;
+
+	auto thrown = false;
+
+	try {
+		jobSystem.parallelFor(4, [&](const CodeRed::JobRange& range)
+			{
+				if (range.Index == 2) throw std::runtime_error("job failed");
+
+				finishedJobs++;
+			});
+	}
+	catch (const std::runtime_error&) {
+		thrown = true;
+	}
+
+	DEMO_CHECK(thrown);
+	DEMO_CHECK(finishedJobs == 3);
+
+	//the exception does not leak to the next dispatch
+	finishedJobs = 0;
+
+	jobSystem.parallelFor(4, [&](const CodeRed::JobRange& range) { finishedJobs++; });
+
+	DEMO_CHECK(finishedJobs == 4);
+}
+
+DEMO_TEST("JobSystem throws the exception of job without workers")
+{
+	CodeRed::JobSystem jobSystem(0);
+
+	auto thrown = false;
+
+	try {
+		jobSystem.parallelFor(4, [&](const CodeRed::JobRange& range) { throw std::runtime_error("job failed"); });
+	}
+	catch (const std::runtime_error&) {
+		thrown = true;
+	}
+
+	DEMO_CHECK(thrown);
+}
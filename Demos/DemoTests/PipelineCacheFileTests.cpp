@@ -0,0 +1,139 @@
+#include "TestDevice.hpp"
+
+#include <Pipelines/PipelineCacheFile.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+static auto testFileName() -> std::string
+{
+	return (std::filesystem::temp_directory_path() / "DemoTests.PipelineCache").string();
+}
+
+static auto testIdentity() -> CodeRed::PipelineCacheIdentity
+{
+	return CodeRed::PipelineCacheIdentity(CodeRed::APIVersion::Vulkan, "Test Adapter", 0x10de, 0x1b80, 1);
+}
+
+static auto testData() -> std::vector<CodeRed::Byte>
+{
+	std::vector<CodeRed::Byte> data(1000);
+
+	for (size_t index = 0; index < data.size(); index++) data[index] = static_cast<CodeRed::Byte>(index * 7);
+
+	return data;
+}
+
+//save the test data with the identity, so the tests can load it with other identities
+static void saveTestFile(const CodeRed::PipelineCacheIdentity& identity)
+{
+	const auto backend = std::make_shared<CodeRed::MemoryPipelineCacheBackend>();
+
+	backend->setData(testData());
+
+	DEMO_CHECK(CodeRed::PipelineCacheFile(testFileName(), identity, backend).save());
+}
+
+static auto loadTestFile(const CodeRed::PipelineCacheIdentity& identity)
+	-> std::shared_ptr<CodeRed::MemoryPipelineCacheBackend>
+{
+	const auto backend = std::make_shared<CodeRed::MemoryPipelineCacheBackend>();
+
+	return CodeRed::PipelineCacheFile(testFileName(), identity, backend).load() ? backend : nullptr;
+}
+
+DEMO_TEST("PipelineCacheFile loads the data it saved")
+{
+	saveTestFile(testIdentity());
+
+	const auto backend = loadTestFile(testIdentity());
+
+	DEMO_CHECK(backend != nullptr);
+	DEMO_CHECK(backend->data() == testData());
+
+	std::filesystem::remove(testFileName());
+}
+
+DEMO_TEST("PipelineCacheFile ignores the file of other adapter, driver or api")
+{
+	saveTestFile(testIdentity());
+
+	auto identity = testIdentity();
+
+	identity.DeviceId = identity.DeviceId + 1;
+
+	DEMO_CHECK(loadTestFile(identity) == nullptr);
+
+	identity = testIdentity();
+	identity.VendorId = identity.VendorId + 1;
+
+	DEMO_CHECK(loadTestFile(identity) == nullptr);
+
+	identity = testIdentity();
+	identity.DriverVersion = identity.DriverVersion + 1;
+
+	DEMO_CHECK(loadTestFile(identity) == nullptr);
+
+	identity = testIdentity();
+	identity.AdapterName = "Other Adapter";
+
+	DEMO_CHECK(loadTestFile(identity) == nullptr);
+
+	identity = testIdentity();
+	identity.API = CodeRed::APIVersion::DirectX12;
+
+	DEMO_CHECK(loadTestFile(identity) == nullptr);
+
+	//the file is still valid for the identity that saved it
+	DEMO_CHECK(loadTestFile(testIdentity()) != nullptr);
+
+	std::filesystem::remove(testFileName());
+}
+
+DEMO_TEST("PipelineCacheFile ignores a broken or missing file")
+{
+	std::filesystem::remove(testFileName());
+
+	DEMO_CHECK(loadTestFile(testIdentity()) == nullptr);
+
+	saveTestFile(testIdentity());
+
+	//change the last byte of data, the hash of data is not matched
+	{
+		std::fstream file(testFileName(), std::ios::binary | std::ios::in | std::ios::out);
+
+		file.seekp(-1, std::ios::end);
+		file.put(0x7f);
+	}
+
+	DEMO_CHECK(loadTestFile(testIdentity()) == nullptr);
+
+	//cut the file, the size of data is not matched
+	std::filesystem::resize_file(testFileName(), std::filesystem::file_size(testFileName()) - 10);
+
+	DEMO_CHECK(loadTestFile(testIdentity()) == nullptr);
+
+	std::filesystem::remove(testFileName());
+}
+
+#ifdef __ENABLE__VULKAN__
+
+DEMO_TEST("PipelineCacheFile feeds the saved data to the native cache of device")
+{
+	const auto device = Demo::Test::testDevice();
+	const auto saved = std::make_shared<CodeRed::DevicePipelineCacheBackend>(device);
+
+	//the native cache always has a header, so the data is not empty even if it has no pipeline
+	DEMO_CHECK(!saved->serialize().empty());
+	DEMO_CHECK(CodeRed::PipelineCacheFile(testFileName(), testIdentity(), saved).save());
+
+	const auto loaded = std::make_shared<CodeRed::DevicePipelineCacheBackend>(device);
+
+	DEMO_CHECK(CodeRed::PipelineCacheFile(testFileName(), testIdentity(), loaded).load());
+	DEMO_CHECK(loaded->nativeVulkan());
+	DEMO_CHECK(loaded->serialize() == saved->serialize());
+
+	std::filesystem::remove(testFileName());
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "TestDevice.hpp"
+
+#include <Effects/GeneralEffectPass.hpp>
+#include <Pipelines/PipelineStateCache.hpp>
+#include <Pipelines/PipelineInfo.hpp>
+#include <Shaders/ShaderCompiler.hpp>
+
+#ifdef __ENABLE__VULKAN__
+
+static const std::string vertexShaderText = R"(
+#version 450
+
+void main()
+{
+	vec2 position = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static const std::string pixelShaderText = R"(
+#version 450
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+	outColor = vec4(1.0);
+}
+)";
+
+static void createShaders(
+	const std::shared_ptr<CodeRed::GpuPipelineFactory>& pipelineFactory,
+	std::shared_ptr<CodeRed::GpuShaderState>& vertexShader,
+	std::shared_ptr<CodeRed::GpuShaderState>& pixelShader)
+{
+	vertexShader = pipelineFactory->createShaderState(
+		CodeRed::ShaderType::Vertex,
+		CodeRed::ShaderCompiler::compileToSpv(CodeRed::ShaderType::Vertex, vertexShaderText),
+		"main");
+
+	pixelShader = pipelineFactory->createShaderState(
+		CodeRed::ShaderType::Pixel,
+		CodeRed::ShaderCompiler::compileToSpv(CodeRed::ShaderType::Pixel, pixelShaderText),
+		"main");
+}
+
+DEMO_TEST("PipelineInfo creates every default state once per device")
+{
+	const auto device = Demo::Test::testDevice();
+	const auto pipelineFactory = device->createPipelineFactory();
+
+	std::shared_ptr<CodeRed::GpuShaderState> vertexShader;
+	std::shared_ptr<CodeRed::GpuShaderState> pixelShader;
+
+	createShaders(pipelineFactory, vertexShader, pixelShader);
+
+	//the device is new, so none of its default states is created
+	const auto before = CodeRed::PipelineInfo::defaultStateCreations();
+
+	const auto first = std::make_shared<CodeRed::PipelineInfo>(device);
+
+	//creating a pipeline info does not create any state
+	DEMO_CHECK(CodeRed::PipelineInfo::defaultStateCreations() == before);
+
+	first->setVertexShaderState(vertexShader);
+	first->setPixelShaderState(pixelShader);
+	first->updateState();
+
+	//rasterization, input assembly, depth stencil, blend, resource layout and render pass
+	DEMO_CHECK(CodeRed::PipelineInfo::defaultStateCreations() - before == 6);
+	DEMO_CHECK(first->graphicsPipeline() != nullptr);
+
+	const auto second = std::make_shared<CodeRed::PipelineInfo>(device);
+
+	second->setVertexShaderState(vertexShader);
+	second->setPixelShaderState(pixelShader);
+	second->updateState();
+
+	//the second pipeline info shares the default states of the first one
+	DEMO_CHECK(CodeRed::PipelineInfo::defaultStateCreations() - before == 6);
+	DEMO_CHECK(second->blendState() == first->blendState());
+	DEMO_CHECK(second->renderPass() == first->renderPass());
+
+	const auto third = std::make_shared<CodeRed::PipelineInfo>(device);
+
+	third->setRasterizationState(pipelineFactory->createRasterizationState());
+	third->setInputAssemblyState(pipelineFactory->createInputAssemblyState({}));
+	third->setDepthStencilState(pipelineFactory->createDetphStencilState());
+	third->setBlendState(pipelineFactory->createBlendState());
+	third->setResourceLayout(device->createResourceLayout({}, {}));
+	third->setRenderPass(first->renderPass());
+	third->setVertexShaderState(vertexShader);
+	third->setPixelShaderState(pixelShader);
+	third->updateState();
+
+	//the pipeline info with all states does not need any default state
+	DEMO_CHECK(CodeRed::PipelineInfo::defaultStateCreations() - before == 6);
+	DEMO_CHECK(third->blendState() != first->blendState());
+}
+
+DEMO_TEST("PipelineInfo keeps the replaced pipelines until their frames are finished")
+{
+	const auto device = Demo::Test::testDevice();
+	const auto pipelineFactory = device->createPipelineFactory();
+
+	std::shared_ptr<CodeRed::GpuShaderState> vertexShader;
+	std::shared_ptr<CodeRed::GpuShaderState> pixelShader;
+
+	createShaders(pipelineFactory, vertexShader, pixelShader);
+
+	//the pacer only paces the simulated frames, the pipelines are not really used by GPU
+	const auto pacer = std::make_shared<CodeRed::FramePacer>(nullptr,
+		std::make_shared<CodeRed::SimulatedFrameFence>(std::chrono::milliseconds(50)));
+
+	const auto info = std::make_shared<CodeRed::PipelineInfo>(device);
+
+	info->setFramePacer(pacer);
+	info->setVertexShaderState(vertexShader);
+	info->setPixelShaderState(pixelShader);
+	info->updateState();
+
+	pacer->beginFrame();
+
+	//the pipeline may be replaced more times than frames in flight in one frame(for example, hot reload)
+	for (size_t index = 0; index < CodeRed::FramePacer::maxFramesInFlight + 2; index++) {
+		info->setBlendState(pipelineFactory->createBlendState());
+		info->updateState();
+	}
+
+	pacer->endFrame();
+
+	//the frame may use all of them, so none of them is released
+	DEMO_CHECK(info->retiredPipelines() == CodeRed::FramePacer::maxFramesInFlight + 2);
+
+	pacer->waitIdle();
+
+	info->updatePendingState();
+
+	DEMO_CHECK(info->retiredPipelines() == 0);
+}
+
+DEMO_TEST("PipelineCache hits the pipeline of a state toggled back")
+{
+	const auto device = Demo::Test::testDevice();
+	const auto pipelineFactory = device->createPipelineFactory();
+
+	std::shared_ptr<CodeRed::GpuShaderState> vertexShader;
+	std::shared_ptr<CodeRed::GpuShaderState> pixelShader;
+
+	createShaders(pipelineFactory, vertexShader, pixelShader);
+
+	const auto states = std::make_shared<CodeRed::PipelineStateCache>(device);
+	const auto cache = std::make_shared<CodeRed::PipelineCache>(device);
+	const auto info = std::make_shared<CodeRed::PipelineInfo>(device);
+
+	info->setPipelineCache(cache);
+	info->setVertexShaderState(vertexShader);
+	info->setPixelShaderState(pixelShader);
+
+	const auto none = states->rasterizationState(CodeRed::FrontFace::Clockwise, CodeRed::CullMode::None);
+
+	info->setRasterizationState(none);
+	info->updateState();
+
+	info->setRasterizationState(states->rasterizationState(CodeRed::FrontFace::Clockwise, CodeRed::CullMode::Back));
+	info->updateState();
+
+	//the state is created again with the same arguments, so it is the same object
+	info->setRasterizationState(states->rasterizationState(CodeRed::FrontFace::Clockwise, CodeRed::CullMode::None));
+	info->updateState();
+
+	DEMO_CHECK(info->rasterizationState() == none);
+	DEMO_CHECK(states->size() == 2);
+	DEMO_CHECK(cache->misses() == 2);
+	DEMO_CHECK(cache->hits() == 1);
+}
+
+DEMO_TEST("EffectPass creates its layouts once per device")
+{
+	const auto device = Demo::Test::testDevice();
+
+	const auto renderPass = device->createRenderPass(
+		CodeRed::Attachment::RenderTarget(CodeRed::PixelFormat::RedGreenBlueAlpha8BitUnknown),
+		CodeRed::Attachment::DepthStencil(CodeRed::PixelFormat::Depth32BitFloat));
+
+	const auto before = CodeRed::EffectPass::layoutCreations();
+
+	const auto first = std::make_shared<CodeRed::GeneralEffectPass>(device, renderPass);
+
+	//the vulkan effect pass only creates the layouts reflected from its shaders, not the hlsl ones
+	DEMO_CHECK(CodeRed::EffectPass::layoutCreations() - before == 2);
+
+	const auto second = std::make_shared<CodeRed::GeneralEffectPass>(device, renderPass);
+
+	//the second effect pass shares the layouts of the first one
+	DEMO_CHECK(CodeRed::EffectPass::layoutCreations() - before == 2);
+	DEMO_CHECK(second->pipelineInfo()->inputAssemblyState() == first->pipelineInfo()->inputAssemblyState());
+	DEMO_CHECK(second->pipelineInfo()->resourceLayout() == first->pipelineInfo()->resourceLayout());
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "Test.hpp"
+
+#include <Profiling/Profiler.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <chrono>
+#include <thread>
+
+static auto zoneStats(const std::string& name) -> CodeRed::ProfileZoneStats
+{
+	const auto stats = CodeRed::Profiler::stats();
+
+	const auto it = std::find_if(stats.begin(), stats.end(),
+		[&](const CodeRed::ProfileZoneStats& zone) { return zone.Name == name; });
+
+	return it == stats.end() ? CodeRed::ProfileZoneStats() : *it;
+}
+
+DEMO_TEST("Profiler collects the zones of threads that exited")
+{
+	CodeRed::Profiler::clear();
+
+	for (size_t index = 0; index < 4; index++) {
+		std::thread([]()
+			{
+				for (size_t zone = 0; zone < 10; zone++) {
+					CODE_RED_PROFILE_ZONE("ProfilerTests::Exited");
+				}
+			}).join();
+	}
+
+	//the threads exited before we collect, their events are still collected once
+	CodeRed::Profiler::collect();
+	CodeRed::Profiler::collect();
+
+	DEMO_CHECK(zoneStats("ProfilerTests::Exited").Count == 40);
+}
+
+DEMO_TEST("Profiler only tracks the allocations of allocation zones")
+{
+	CodeRed::Profiler::clear();
+
+	{
+		//the first zone of thread registers the thread, the registration allocates
+		CODE_RED_PROFILE_ZONE("ProfilerTests::Register");
+	}
+
+	//call the operator new directly, so the compiler does not remove the allocation
+	for (size_t index = 0; index < 10; index++) {
+		CODE_RED_PROFILE_ALLOCATION_ZONE("ProfilerTests::Allocation");
+
+		::operator delete(::operator new(16));
+	}
+
+	for (size_t index = 0; index < 10; index++) {
+		CODE_RED_PROFILE_ZONE("ProfilerTests::Untracked");
+
+		::operator delete(::operator new(16));
+	}
+
+	CodeRed::Profiler::collect();
+
+	const auto allocation = zoneStats("ProfilerTests::Allocation");
+	const auto untracked = zoneStats("ProfilerTests::Untracked");
+
+	DEMO_CHECK(allocation.TracksAllocations && allocation.Allocations == 1);
+	DEMO_CHECK(!untracked.TracksAllocations && untracked.Count == 10);
+}
+
+DEMO_TEST("Profiler zone cost")
+{
+	CodeRed::Profiler::clear();
+
+	const size_t zones = 10000;
+	const size_t rounds = 5;
+
+	//the first events touch the memory of the ring buffer of thread, so we do not measure them
+	for (size_t index = 0; index < CodeRed::Profiler::threadCapacity; index++) {
+		CODE_RED_PROFILE_ZONE("ProfilerTests::Warmup");
+	}
+
+	CodeRed::Profiler::collect();
+
+	//the best round of zones, the other rounds may be interrupted by the system
+	const auto measure = [&](const auto& runZones)
+	{
+		auto best = std::numeric_limits<double>::max();
+
+		for (size_t round = 0; round < rounds; round++) {
+			const auto begin = std::chrono::high_resolution_clock::now();
+
+			runZones();
+
+			const auto end = std::chrono::high_resolution_clock::now();
+
+			//the events of a round fit in the ring buffer of thread, so none of them is dropped
+			CodeRed::Profiler::collect();
+
+			best = std::min(best, std::chrono::duration<double, std::nano>(end - begin).count() / zones);
+		}
+
+		return best;
+	};
+
+	const auto zoneCost = measure([&]()
+		{
+			for (size_t index = 0; index < zones; index++) {
+				CODE_RED_PROFILE_ZONE("ProfilerTests::Cost");
+			}
+		});
+
+	const auto allocationZoneCost = measure([&]()
+		{
+			for (size_t index = 0; index < zones; index++) {
+				CODE_RED_PROFILE_ALLOCATION_ZONE("ProfilerTests::AllocationCost");
+			}
+		});
+
+	DEMO_CHECK(zoneStats("ProfilerTests::Cost").Count == zones * rounds);
+	DEMO_CHECK(zoneStats("ProfilerTests::AllocationCost").Count == zones * rounds);
+
+	//the cost depends on the machine, so we only print it
+	std::cout << "CODE_RED_PROFILE_ZONE: " << zoneCost << " ns/zone" << std::endl;
+	std::cout << "CODE_RED_PROFILE_ALLOCATION_ZONE: " << allocationZoneCost << " ns/zone" << std::endl;
+}
@@ -0,0 +1,153 @@
+#include "Test.hpp"
+
+#include <Graphs/RenderGraph.hpp>
+
+using Access = CodeRed::RenderGraphAccess;
+using Layout = CodeRed::ResourceLayout;
+
+static auto passesOf(const CodeRed::RenderGraphCompiled& compiled) -> std::vector<size_t>
+{
+	std::vector<size_t> passes;
+
+	for (const auto& step : compiled.Steps) passes.push_back(step.Pass);
+
+	return passes;
+}
+
+static auto colorInfo() -> CodeRed::RenderGraphTextureInfo
+{
+	return CodeRed::RenderGraphTextureInfo(1280, 720, CodeRed::PixelFormat::RedGreenBlueAlpha8BitUnknown);
+}
+
+DEMO_TEST("RenderGraph culls the passes that do not contribute to imported textures")
+{
+	CodeRed::RenderGraph graph;
+
+	const auto backBuffer = graph.importTexture("BackBuffer", nullptr, Layout::Present, Layout::Present);
+	const auto used = graph.createTexture("Used", colorInfo());
+	const auto unused = graph.createTexture("Unused", colorInfo());
+
+	const auto writeUsed = graph.addPass("WriteUsed",
+		{ Access::write(used, Layout::RenderTarget, Layout::GeneralRead) }, nullptr);
+	const auto writeUnused = graph.addPass("WriteUnused",
+		{ Access::write(unused, Layout::RenderTarget, Layout::GeneralRead) }, nullptr);
+	const auto sideEffect = graph.addPass("SideEffect", {}, nullptr, true);
+	const auto compose = graph.addPass("Compose",
+		{
+			Access::read(used, Layout::GeneralRead),
+			Access::write(backBuffer, Layout::RenderTarget, Layout::Present)
+		}, nullptr);
+
+	const auto& compiled = graph.compile();
+
+	DEMO_CHECK(passesOf(compiled) == std::vector<size_t>({ writeUsed, sideEffect, compose }));
+	DEMO_CHECK(compiled.CulledPasses == std::vector<size_t>({ writeUnused }));
+
+	//the texture only used by culled passes has no slot, so it is never created
+	DEMO_CHECK(compiled.Slots[unused] == CodeRed::RenderGraphCompiled::invalidSlot);
+	DEMO_CHECK(compiled.Slots[backBuffer] == CodeRed::RenderGraphCompiled::invalidSlot);
+}
+
+DEMO_TEST("RenderGraph aliases the compatible transient textures with disjoint lifetimes")
+{
+	CodeRed::RenderGraph graph;
+
+	const auto backBuffer = graph.importTexture("BackBuffer", nullptr, Layout::Present, Layout::Present);
+	const auto first = graph.createTexture("First", colorInfo());
+	const auto second = graph.createTexture("Second", colorInfo());
+	const auto third = graph.createTexture("Third", colorInfo());
+	const auto small = graph.createTexture("Small",
+		CodeRed::RenderGraphTextureInfo(640, 360, CodeRed::PixelFormat::RedGreenBlueAlpha8BitUnknown));
+
+	//first: [0, 1], second: [1, 2], third: [2, 3], small: [3, 4]
+	graph.addPass("WriteFirst", { Access::write(first, Layout::RenderTarget, Layout::GeneralRead) }, nullptr);
+	graph.addPass("FirstToSecond",
+		{
+			Access::read(first, Layout::GeneralRead),
+			Access::write(second, Layout::RenderTarget, Layout::GeneralRead)
+		}, nullptr);
+	graph.addPass("SecondToThird",
+		{
+			Access::read(second, Layout::GeneralRead),
+			Access::write(third, Layout::RenderTarget, Layout::GeneralRead)
+		}, nullptr);
+	graph.addPass("ThirdToSmall",
+		{
+			Access::read(third, Layout::GeneralRead),
+			Access::write(small, Layout::RenderTarget, Layout::GeneralRead)
+		}, nullptr);
+	graph.addPass("Compose",
+		{
+			Access::read(small, Layout::GeneralRead),
+			Access::write(backBuffer, Layout::RenderTarget, Layout::Present)
+		}, nullptr);
+
+	const auto& compiled = graph.compile();
+
+	//first and third do not overlap, second overlaps both of them
+	DEMO_CHECK(compiled.Slots[first] == compiled.Slots[third]);
+	DEMO_CHECK(compiled.Slots[first] != compiled.Slots[second]);
+
+	//small does not overlap first and second, but the description is different
+	DEMO_CHECK(compiled.Slots[small] != compiled.Slots[first]);
+	DEMO_CHECK(compiled.Slots[small] != compiled.Slots[second]);
+
+	DEMO_CHECK(compiled.SlotInfos.size() == 3);
+}
+
+DEMO_TEST("RenderGraph only transitions the resources that are not in the layout we need")
+{
+	CodeRed::RenderGraph graph;
+
+	const auto backBuffer = graph.importTexture("BackBuffer", nullptr, Layout::Present, Layout::Present);
+	const auto msaaBuffer = graph.createTexture("MSAABuffer",
+		CodeRed::RenderGraphTextureInfo(1280, 720, CodeRed::PixelFormat::RedGreenBlueAlpha8BitUnknown,
+			CodeRed::MultiSample::Count4));
+
+	//the passes of triangle demo with msaa
+	graph.addPass("Scene",
+		{ Access::write(msaaBuffer, Layout::RenderTarget, Layout::GeneralRead) }, nullptr);
+	graph.addPass("Resolve",
+		{
+			Access::read(msaaBuffer, Layout::GeneralRead),
+			Access::write(backBuffer, Layout::Present, Layout::Present)
+		}, nullptr);
+	graph.addPass("UI",
+		{ Access::write(backBuffer, Layout::RenderTarget, Layout::Present) }, nullptr);
+
+	const auto& compiled = graph.compile();
+
+	DEMO_CHECK(compiled.Steps.size() == 3);
+
+	//the transient texture starts in the layout of its first pass, and the scene leaves it in the
+	//layout that resolve reads, the back buffer starts in present that resolve needs
+	DEMO_CHECK(compiled.Steps[0].Barriers.empty());
+	DEMO_CHECK(compiled.Steps[1].Barriers.empty());
+
+	//the ui needs the back buffer as render target
+	DEMO_CHECK(compiled.Steps[2].Barriers.size() == 1);
+	DEMO_CHECK(compiled.Steps[2].Barriers[0].Resource == backBuffer);
+	DEMO_CHECK(compiled.Steps[2].Barriers[0].Before == Layout::Present);
+	DEMO_CHECK(compiled.Steps[2].Barriers[0].After == Layout::RenderTarget);
+
+	//the render pass of ui leaves the back buffer in present, so there is no final barrier
+	DEMO_CHECK(compiled.FinalBarriers.empty());
+}
+
+DEMO_TEST("RenderGraph transitions the imported textures to their final layout")
+{
+	CodeRed::RenderGraph graph;
+
+	const auto backBuffer = graph.importTexture("BackBuffer", nullptr, Layout::Present, Layout::Present);
+
+	graph.addPass("Copy", { Access::write(backBuffer, Layout::CopyDestination, Layout::CopyDestination) }, nullptr);
+
+	const auto& compiled = graph.compile();
+
+	DEMO_CHECK(compiled.Steps[0].Barriers.size() == 1);
+	DEMO_CHECK(compiled.Steps[0].Barriers[0].After == Layout::CopyDestination);
+
+	DEMO_CHECK(compiled.FinalBarriers.size() == 1);
+	DEMO_CHECK(compiled.FinalBarriers[0].Before == Layout::CopyDestination);
+	DEMO_CHECK(compiled.FinalBarriers[0].After == Layout::Present);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Demo::Test {
+
+	struct TestCase {
+		std::string Name;
+		std::function<void()> Run;
+
+		TestCase() = default;
+
+		TestCase(
+			const std::string& name,
+			const std::function<void()>& run) :
+			Name(name), Run(run) {}
+	};
+
+	//a failed check throws, so the test stops at its first failure
+	struct TestFailure {
+		std::string Message;
+	};
+
+	//the test needs something we do not have(for example, a display adapter)
+	struct TestSkipped {
+		std::string Reason;
+	};
+
+	inline auto testCases() -> std::vector<TestCase>&
+	{
+		static std::vector<TestCase> cases;
+
+		return cases;
+	}
+
+	struct TestRegistration {
+		TestRegistration(const std::string& name, const std::function<void()>& run)
+		{
+			testCases().push_back(TestCase(name, run));
+		}
+	};
+	
+}
+
+#define DEMO_TEST_CONCAT_IMPL(left, right) left##right
+#define DEMO_TEST_CONCAT(left, right) DEMO_TEST_CONCAT_IMPL(left, right)
+
+//define a test case, it is registered before main, so the runner finds all tests of the project
+#define DEMO_TEST(name) \
+	static void DEMO_TEST_CONCAT(demoTest, __LINE__)(); \
+	static const Demo::Test::TestRegistration DEMO_TEST_CONCAT(demoTestRegistration, __LINE__)( \
+		name, DEMO_TEST_CONCAT(demoTest, __LINE__)); \
+	static void DEMO_TEST_CONCAT(demoTest, __LINE__)()
+
+#define DEMO_CHECK(condition) \
+	do { \
+		if (!(condition)) throw Demo::Test::TestFailure{ \
+			std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " + #condition }; \
+	} while (false)
+
+#define DEMO_SKIP(reason) throw Demo::Test::TestSkipped{ reason }
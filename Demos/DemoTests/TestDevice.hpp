@@ -0,0 +1,41 @@
+#pragma once
+
+#include <CodeRed/Core/CodeRedGraphics.hpp>
+
+#include "Test.hpp"
+
+namespace Demo::Test {
+
+	//create a logical device on the first display adapter
+	//the machines without adapter(for example, a build agent) skip the test
+	inline auto testDevice() -> std::shared_ptr<CodeRed::GpuLogicalDevice>
+	{
+		try {
+#ifdef __ENABLE__VULKAN__
+			const auto systemInfo = std::make_shared<CodeRed::VulkanSystemInfo>();
+			const auto adapters = systemInfo->selectDisplayAdapter();
+
+			if (!adapters.empty()) {
+				return std::static_pointer_cast<CodeRed::GpuLogicalDevice>(
+					std::make_shared<CodeRed::VulkanLogicalDevice>(adapters[0]));
+			}
+#else
+#ifdef __ENABLE__DIRECTX12__
+			const auto systemInfo = std::make_shared<CodeRed::DirectX12SystemInfo>();
+			const auto adapters = systemInfo->selectDisplayAdapter();
+
+			if (!adapters.empty()) {
+				return std::static_pointer_cast<CodeRed::GpuLogicalDevice>(
+					std::make_shared<CodeRed::DirectX12LogicalDevice>(adapters[0]));
+			}
+#endif
+#endif
+		}
+		catch (...) {
+			//the system has no driver of the api
+		}
+
+		DEMO_SKIP("there is no display adapter.");
+	}
+	
+}
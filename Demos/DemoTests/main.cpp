@@ -0,0 +1,48 @@
+#include "Test.hpp"
+
+#include <iostream>
+
+int main(int argc, char** argv) {
+	//run all tests with "DemoTests", or the tests whose name contains the filter with "DemoTests filter"
+	const std::string filter = argc > 1 ? argv[1] : "";
+
+	size_t passed = 0;
+	size_t failed = 0;
+	size_t skipped = 0;
+
+	for (const auto& test : Demo::Test::testCases()) {
+		if (test.Name.find(filter) == std::string::npos) continue;
+
+		try {
+			test.Run();
+
+			std::cout << "[pass] " << test.Name << std::endl;
+
+			passed++;
+		}
+		catch (const Demo::Test::TestSkipped& skip) {
+			std::cout << "[skip] " << test.Name << ": " << skip.Reason << std::endl;
+
+			skipped++;
+		}
+		catch (const Demo::Test::TestFailure& failure) {
+			std::cout << "[fail] " << test.Name << ": " << failure.Message << std::endl;
+
+			failed++;
+		}
+		catch (const std::exception& exception) {
+			std::cout << "[fail] " << test.Name << ": " << exception.what() << std::endl;
+
+			failed++;
+		}
+		catch (...) {
+			std::cout << "[fail] " << test.Name << ": unknown exception" << std::endl;
+
+			failed++;
+		}
+	}
+
+	std::cout << passed << " passed, " << failed << " failed, " << skipped << " skipped" << std::endl;
+
+	return failed == 0 ? 0 : 1;
+}
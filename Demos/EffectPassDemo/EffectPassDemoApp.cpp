@@ -1,13 +1,32 @@
 #include "EffectPassDemoApp.hpp"
 
+#include <algorithm>
 #include <random>
 
+//the keys of frame resources, the names are interned once when the program starts
+static const CodeRed::FrameResourceKey<CodeRed::GpuFrameBuffer> FrameBufferKey("FrameBuffer");
+#ifdef __PBR__MODE__
+static const CodeRed::FrameResourceKey<CodeRed::PhysicallyBasedEffectPass> EffectPassKey("EffectPass");
+#else
+static const CodeRed::FrameResourceKey<CodeRed::GeneralEffectPass> EffectPassKey("EffectPass");
+#endif
+
 EffectPassDemoUIComponent::EffectPassDemoUIComponent()
 {
+	mShaderOptimizeReports = CodeRed::EffectPass::shaderOptimizeReports();
+
 	mProgramStateView = std::make_shared<CodeRed::ImGuiView>([&]
 		{
 			ImGui::Text("DemoApp average %.3f ms/frame (%.1f FPS)",
 				1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+			//only the shaders compiled in release are optimized, the archived shaders have no report
+			for (const auto& report : mShaderOptimizeReports) {
+				ImGui::Text("%s: %zu -> %zu bytes, %zu -> %zu instructions",
+					report.first.c_str(),
+					report.second.SizeBefore, report.second.SizeAfter,
+					report.second.InstructionsBefore, report.second.InstructionsAfter);
+			}
 		});
 
 	mLightView = std::make_shared<CodeRed::ImGuiView>([&]
@@ -44,7 +63,8 @@ EffectPassDemoUIComponent::EffectPassDemoUIComponent()
 EffectPassDemoApp::EffectPassDemoApp(
 	const std::string& name,
 	const size_t width,
-	const size_t height) :
+	const size_t height,
+	const size_t threads) :
 #ifdef __DIRECTX12__MODE__
 	DemoApp(name + "[DirectX12]", width, height)
 #else
@@ -55,6 +75,8 @@ EffectPassDemoApp::EffectPassDemoApp(
 #endif
 #endif	
 {
+	mThreads = threads;
+
 	initialize();
 }
 
@@ -63,6 +85,15 @@ EffectPassDemoApp::~EffectPassDemoApp()
 	//if we want to destroy the demo app, device and so on
 	//we need wait for command queue to idle
 	mCommandQueue->waitIdle();
+
+	//the shaders compiled in this run are loaded from the archive in the next run
+	CodeRed::EffectPass::saveShaderArchive();
+}
+
+void EffectPassDemoApp::waitFrame()
+{
+	//wait for the frame that used this slot, so we can write the frame resources of it
+	mCurrentFrameIndex = mFramePacer->beginFrame();
 }
 
 void EffectPassDemoApp::update(float delta)
@@ -75,7 +106,7 @@ void EffectPassDemoApp::update(float delta)
 	//such as, update buffer, copy texture and so on
 	//the function call is before render()
 
-	auto effectPass = mFrameResources[mCurrentFrameIndex].get<EffectPass>("EffectPass");
+	auto effectPass = mFrameResources[mCurrentFrameIndex].get(EffectPassKey);
 
 	for (size_t index = 0; index < mTransforms.size(); index++) {
 		const auto speed = glm::pi<float>() * 0.00f;
@@ -103,7 +134,7 @@ void EffectPassDemoApp::update(float delta)
 	effectPass->setTextureMaterial(getTextureMaterial(mUIComponent->TextureMaterialName));
 #endif
 
-	effectPass->updateToGpu(mCommandAllocator, mCommandQueue);
+	effectPass->updateToGpu(mFramePacer->allocator(), mCommandQueue);
 
 	mImGuiWindows->update();
 }
@@ -114,31 +145,75 @@ void EffectPassDemoApp::render(float delta)
 	//we use a frame resource to record the resource we will use in this frame
 	//with frame resource, we can try to avoid the synchronization of CPU and GPU
 	const auto frameBuffer =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuFrameBuffer>("FrameBuffer");
+		mFrameResources[mCurrentFrameIndex].get(FrameBufferKey);
 	const auto effectPass =
-		mFrameResources[mCurrentFrameIndex].get<EffectPass>("EffectPass");
+		mFrameResources[mCurrentFrameIndex].get(EffectPassKey);
 
-	//wait for GPU and reset the command allocator
-	mCommandQueue->waitIdle();
-	mCommandAllocator->reset();
+#ifdef __SHADER__HOT__RELOAD__
+	//the new pipelines are created in background, the effect pass swaps them in
+	//when it prepares the effect and they are ready, the frames in flight keep the old ones
+	mShaderWatcher->update();
+#endif
+
+#ifdef __PARALLEL__RECORDING__MODE__
+	//swap in the pipeline on this thread, the jobs only read the effect pass
+	effectPass->prepareEffect();
+
+	//every job records a range of spheres into its own command list
+	//the command lists are executed in the order of ranges
+	const auto& commandLists = mCommandRecorder->record(
+		mCurrentFrameIndex, sphereCount, minSpheresPerJob,
+		[&](const std::shared_ptr<CodeRed::GpuGraphicsCommandList>& jobCommandList, const CodeRed::JobRange& range)
+		{
+			jobCommandList->setViewPort(frameBuffer->fullViewPort());
+			jobCommandList->setScissorRect(frameBuffer->fullScissorRect());
+
+			jobCommandList->setVertexBuffer(mVertexBuffer);
+			jobCommandList->setIndexBuffer(mIndexBuffer);
+
+			//the first job clears the frame buffer, the others keep the spheres drawn before
+			jobCommandList->beginRenderPass(
+				range.first() ? mRenderPass : mLoadRenderPass,
+				frameBuffer);
+
+			effectPass->bindEffect(jobCommandList);
+
+			//one draw call per sphere, the start instance location is the index of sphere
+			for (auto index = range.Begin; index < range.End; index++) {
+#ifdef __TEXTURE__MATERIAL__MODE__
+				effectPass->drawIndexedWithTextureMaterial(jobCommandList, mIndexBuffer->count(), 1, 0, 0, index);
+#else
+				effectPass->drawIndexed(jobCommandList, mIndexBuffer->count(), 1, 0, 0, index);
+#endif
+			}
+
+			//only one job draws the ui, so the ui windows are not used by two threads
+			if (range.last()) mImGuiWindows->draw(jobCommandList);
+
+			jobCommandList->endRenderPass();
+		});
+
+	mCommandQueue->execute(commandLists);
+#else
+	auto commandList = mFramePacer->commandList();
 
 	//begin to recording commands
-	mCommandList->beginRecording();
+	commandList->beginRecording();
 
 	//set view port and scissor rect
-	mCommandList->setViewPort(frameBuffer->fullViewPort());
-	mCommandList->setScissorRect(frameBuffer->fullScissorRect());
+	commandList->setViewPort(frameBuffer->fullViewPort());
+	commandList->setScissorRect(frameBuffer->fullScissorRect());
 
 	//set vertex buffer and index buffer
-	mCommandList->setVertexBuffer(mVertexBuffer);
-	mCommandList->setIndexBuffer(mIndexBuffer);
+	commandList->setVertexBuffer(mVertexBuffer);
+	commandList->setIndexBuffer(mIndexBuffer);
 
 	//begin render pass and set frame buffer
-	mCommandList->beginRenderPass(
+	commandList->beginRenderPass(
 		mRenderPass,
 		frameBuffer);
 
-	effectPass->beginEffect(mCommandList);
+	effectPass->beginEffect(commandList);
 
 	//add some draw commands
 	//the draw commands must between the render pass
@@ -150,18 +225,19 @@ void EffectPassDemoApp::render(float delta)
 
 	effectPass->endEffect();
 
-	mImGuiWindows->draw(mCommandList);
+	mImGuiWindows->draw(commandList);
 
-	mCommandList->endRenderPass();
+	commandList->endRenderPass();
 
-	mCommandList->endRecording();
+	commandList->endRecording();
 
 	//execute the commands recording by command list
-	mCommandQueue->execute({ mCommandList });
+	mCommandQueue->execute(mFramePacer->commandLists());
+#endif
 
-	mSwapChain->present();
+	mPresentTargets->present();
 
-	mCurrentFrameIndex = (mCurrentFrameIndex + 1) % maxFrameResources;
+	mFramePacer->endFrame();
 }
 
 void EffectPassDemoApp::initialize()
@@ -184,6 +260,9 @@ void EffectPassDemoApp::initialize()
 #endif
 #endif
 
+	//the pipeline cache is only valid for the adapter we created the device on
+	loadPipelineCache(adapters[0], mDevice);
+
 	initializeSpheres();
 	initializeCommands();
 	initializeSwapChain();
@@ -198,17 +277,20 @@ void EffectPassDemoApp::initialize()
 
 void EffectPassDemoApp::initializeSpheres()
 {
-	const auto projection = glm::perspectiveFovLH(
-		glm::pi<float>() * 0.25f,
-		static_cast<float>(width()),
-		static_cast<float>(height()),
-		1.0f, 1000.0f);
-
-#ifdef __TEXTURE__MATERIAL__MODE__
+#if defined(__TEXTURE__MATERIAL__MODE__)
 	const auto eyePosition = glm::vec4(0, 0, -20, 0);
+#elif defined(__BENCHMARK__SCENE__MODE__)
+	//the grid of benchmark is about 1200 units wide, we move the eye back to see all spheres
+	const auto eyePosition = glm::vec4(0, 0, -1800, 0);
 #else
 	const auto eyePosition = glm::vec4(0, 0, -100, 0);
 #endif
+
+	const auto projection = glm::perspectiveFovLH(
+		glm::pi<float>() * 0.25f,
+		static_cast<float>(width()),
+		static_cast<float>(height()),
+		1.0f, std::max(1000.0f, -eyePosition.z * 2.0f));
 	
 	const auto view = glm::lookAtLH(
 		glm::vec3(eyePosition),
@@ -275,7 +357,20 @@ void EffectPassDemoApp::initializeCommands()
 	//the command queue is a queue that store the commands are submitted to GPU
 	mCommandAllocator = mDevice->createCommandAllocator();
 	mCommandQueue = mDevice->createCommandQueue();
-	mCommandList = mDevice->createGraphicsCommandList(mCommandAllocator);
+
+	//every frame in flight has its own command allocator and command list
+	//we only wait for the frame that used the same slot before
+	mFramePacer = std::make_shared<CodeRed::FramePacer>(
+		mDevice,
+		std::make_shared<CodeRed::QueueFrameFence>(mDevice, mCommandQueue),
+		maxFrameResources);
+
+#ifdef __PARALLEL__RECORDING__MODE__
+	//the thread of demo records the first job, so the job system has one thread less than cores
+	mJobSystem = std::make_shared<CodeRed::JobSystem>(mThreads);
+	mCommandRecorder = std::make_shared<CodeRed::ParallelCommandRecorder>(
+		mDevice, mJobSystem, maxFrameResources);
+#endif
 }
 
 void EffectPassDemoApp::initializeSwapChain()
@@ -283,16 +378,24 @@ void EffectPassDemoApp::initializeSwapChain()
 	//create the swap chain
 	//if we want to write the back buffer(to window)
 	//we need use the queue that create the swap chain to submit the draw commands
-	mSwapChain = mDevice->createSwapChain(
-		mCommandQueue,
-		{ width(), height(), handle() },
-		CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
-		maxFrameResources
-	);
+	//in headless mode, there is no window, so we render to offscreen textures
+	mPresentTargets = isHeadless() ?
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice,
+			width(), height(),
+			CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+			maxFrameResources) :
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice->createSwapChain(
+				mCommandQueue,
+				{ width(), height(), handle() },
+				CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+				maxFrameResources
+			));
 
 	mDepthBuffer = mDevice->createTexture(
 		CodeRed::ResourceInfo::DepthStencil(
-			mSwapChain->width(), mSwapChain->height(),
+			mPresentTargets->width(), mPresentTargets->height(),
 			CodeRed::PixelFormat::Depth32BitFloat,
 			CodeRed::ClearValue(1, 0)
 		)
@@ -300,9 +403,9 @@ void EffectPassDemoApp::initializeSwapChain()
 	
 	for (size_t index = 0; index < maxFrameResources; index++) {
 		mFrameResources[index].set(
-			"FrameBuffer",
+			FrameBufferKey,
 			mDevice->createFrameBuffer(
-				{ mSwapChain->buffer(index)->reference() },
+				{ mPresentTargets->buffer(index)->reference() },
 				mDepthBuffer->reference()
 			)
 		);
@@ -450,23 +553,75 @@ void EffectPassDemoApp::initializePipeline()
 	//you can use setXXX to set the graphics pipeline state
 	//but you should use "updateState()" to create graphics pipeline
 	mRenderPass = mDevice->createRenderPass(
-		{ CodeRed::Attachment::RenderTarget(mSwapChain->format()) },
+		{ CodeRed::Attachment::RenderTarget(mPresentTargets->format()) },
 		CodeRed::Attachment::DepthStencil(mDepthBuffer->format())
 	);
 
 	mRenderPass->setClear(CodeRed::ClearValue(0.27f, 0.27f, 0.27f, 1.0f),
 		CodeRed::ClearValue(1, 0));
 
+	mLoadRenderPass = mDevice->createRenderPass(
+		{
+			CodeRed::Attachment::RenderTarget(mPresentTargets->format(),
+			CodeRed::ResourceLayout::RenderTarget,
+			CodeRed::ResourceLayout::Present,
+			CodeRed::AttachmentLoad::Load,
+			CodeRed::AttachmentStore::Store)
+		},
+		CodeRed::Attachment::DepthStencil(mDepthBuffer->format(),
+			CodeRed::ResourceLayout::DepthStencil,
+			CodeRed::ResourceLayout::DepthStencil,
+			CodeRed::AttachmentLoad::Load,
+			CodeRed::AttachmentStore::Store,
+			CodeRed::AttachmentLoad::Load,
+			CodeRed::AttachmentStore::Store)
+	);
+
 	auto pipelineFactory = mDevice->createPipelineFactory();
 	
 	for (auto& frameResource : mFrameResources) {
-		frameResource.set("EffectPass",
+		frameResource.set(EffectPassKey,
 			std::make_shared<EffectPass>(
 				mDevice,
 				mRenderPass,
 				sphereCount)
 		);
+
+		//the effect pass may replace its pipeline, the old one is released after the frames used it
+		frameResource.get(EffectPassKey)->pipelineInfo()->setFramePacer(mFramePacer);
 	}
+
+#ifdef __SHADER__HOT__RELOAD__
+	//we watch the source of effect shaders in DemoApp
+	//when we edit them, the watcher will recompile them in background
+#ifdef __PBR__MODE__
+	const std::string effectName = "PhysicallyBasedEffectPass";
+#else
+	const std::string effectName = "GeneralEffectPass";
+#endif
+
+	//the shaders are found from the path of this source file, so the watcher does not depend on
+	//the working directory of the demo
+	const auto effectDirectory = (std::filesystem::path(__FILE__).parent_path() /
+		"../DemoApp/Effects/Shaders" / effectName).lexically_normal().string() + "/";
+
+#ifdef __DIRECTX12__MODE__
+	const auto vertexShaderName = effectDirectory + "Dx" + effectName + "Vertex.hlsl";
+	const auto pixelShaderName = effectDirectory + "Dx" + effectName + "Pixel.hlsl";
+#else
+	const auto vertexShaderName = effectDirectory + "Vk" + effectName + "Vertex.vert";
+	const auto pixelShaderName = effectDirectory + "Vk" + effectName + "Pixel.frag";
+#endif
+
+	mShaderWatcher = std::make_shared<CodeRed::ShaderWatcher>(mDevice);
+
+	for (auto& frameResource : mFrameResources) {
+		const auto effectPass = frameResource.get(EffectPassKey);
+
+		mShaderWatcher->watch(effectPass->pipelineInfo(), CodeRed::ShaderType::Vertex, vertexShaderName);
+		mShaderWatcher->watch(effectPass->pipelineInfo(), CodeRed::ShaderType::Pixel, pixelShaderName);
+	}
+#endif
 }
 
 void EffectPassDemoApp::initializeImGuiWindows()
@@ -492,6 +647,7 @@ void EffectPassDemoApp::initializeImGuiWindows()
 		maxFrameResources);
 
 	mImGuiWindows->add("Tool", "Program State", mUIComponent->programStateView());
+	mImGuiWindows->add("Tool", "Profiler", CodeRed::ProfilerView::create());
 	mImGuiWindows->add("Tool", "Light", mUIComponent->lightView());
 	
 #ifdef __TEXTURE__MATERIAL__MODE__
@@ -3,19 +3,36 @@
 #include <Effects/PhysicallyBasedEffectPass.hpp>
 #include <Effects/GeneralEffectPass.hpp>
 #include <Resources/FrameResources.hpp>
+#include <Resources/FramePacer.hpp>
+#include <Resources/PresentTargets.hpp>
 #include <Resources/ResourceHelper.hpp>
 #include <Pipelines/PipelineInfo.hpp>
 #include <Shaders/ShaderCompiler.hpp>
+#include <Shaders/ShaderWatcher.hpp>
+#include <Threads/ParallelCommandRecorder.hpp>
 
 #include <DemoApp.hpp>
 
 #include <Extensions/ImGui/ImGuiWindows.hpp>
+#include <Profiling/ProfilerView.hpp>
 
 //#define __DIRECTX12__MODE__
 #define __VULKAN__MODE__
 
 #define __PBR__MODE__
 
+//record the draw calls of spheres on more than one thread
+//the spheres use the start instance location as their index
+#define __PARALLEL__RECORDING__MODE__
+
+//draw 100 x 100 spheres, so the recording of draw calls is heavy enough to compare
+//the parallel recording with the single thread recording
+//#define __BENCHMARK__SCENE__MODE__
+
+//recompile the effect shaders when we edit them, it needs the source of DemoApp
+//so it is only for development and it is disabled by default
+//#define __SHADER__HOT__RELOAD__
+
 #ifdef __PBR__MODE__
 //#define __TEXTURE__MATERIAL__MODE__
 #endif
@@ -49,6 +66,9 @@ public:
 private:
 	std::shared_ptr<CodeRed::ImGuiView> mProgramStateView;
 	std::shared_ptr<CodeRed::ImGuiView> mLightView;
+
+	//the effect passes are created before the ui, so the reports do not change after it
+	std::vector<std::pair<std::string, CodeRed::ShaderOptimizeReport>> mShaderOptimizeReports;
 	
 #ifdef __TEXTURE__MATERIAL__MODE__
 	std::shared_ptr<CodeRed::ImGuiView> mTextureMaterialView;
@@ -60,7 +80,8 @@ public:
 	EffectPassDemoApp(
 		const std::string& name,
 		const size_t width,
-		const size_t height);
+		const size_t height,
+		const size_t threads = CodeRed::JobSystem::defaultThreads());
 
 	~EffectPassDemoApp();
 private:
@@ -73,6 +94,7 @@ private:
 	using Material = CodeRed::Material;
 #endif
 private:
+	void waitFrame() override;
 	void update(float delta) override;
 	void render(float delta) override;
 
@@ -101,24 +123,39 @@ private:
 	auto getTextureMaterial(const std::string& name) -> TextureMaterial;
 private:
 	const size_t maxFrameResources = 2;
-#ifdef __TEXTURE__MATERIAL__MODE__
+#if defined(__TEXTURE__MATERIAL__MODE__)
 	const size_t rowCount = 1;
 	const size_t columnCount = 1;
+#elif defined(__BENCHMARK__SCENE__MODE__)
+	const size_t rowCount = 100;
+	const size_t columnCount = 100;
 #else
 	const size_t rowCount = 6;
 	const size_t columnCount = 9;
 #endif
 	const size_t sphereCount = rowCount * columnCount;
+	const size_t minSpheresPerJob = 8;
 
 	size_t mCurrentFrameIndex = 0;
 
 	std::shared_ptr<CodeRed::GpuLogicalDevice> mDevice;
-	std::shared_ptr<CodeRed::GpuSwapChain> mSwapChain;
+	std::shared_ptr<CodeRed::PresentTargets> mPresentTargets;
 
+	//the command allocator is only used to upload resources when we initialize
+	//the frames use the command allocators and command lists of frame pacer
 	std::shared_ptr<CodeRed::GpuCommandAllocator> mCommandAllocator;
-	std::shared_ptr<CodeRed::GpuGraphicsCommandList> mCommandList;
 	std::shared_ptr<CodeRed::GpuCommandQueue> mCommandQueue;
 
+	std::shared_ptr<CodeRed::FramePacer> mFramePacer;
+
+	//the threads of job system, the thread of demo records the first job
+	size_t mThreads = 0;
+
+#ifdef __PARALLEL__RECORDING__MODE__
+	std::shared_ptr<CodeRed::JobSystem> mJobSystem;
+	std::shared_ptr<CodeRed::ParallelCommandRecorder> mCommandRecorder;
+#endif
+
 	std::vector<CodeRed::FrameResources> mFrameResources =
 		std::vector<CodeRed::FrameResources>(maxFrameResources);
 
@@ -129,8 +166,13 @@ private:
 
 	std::shared_ptr<CodeRed::GpuRenderPass> mRenderPass;
 
+	//the render pass that loads the frame buffer, the command lists after the first one use it
+	std::shared_ptr<CodeRed::GpuRenderPass> mLoadRenderPass;
+
 	std::shared_ptr<EffectPassDemoUIComponent> mUIComponent;
 	std::shared_ptr<CodeRed::ImGuiWindows> mImGuiWindows;
+
+	std::shared_ptr<CodeRed::ShaderWatcher> mShaderWatcher;
 	
 	std::vector<CodeRed::Transform3D> mTransforms = std::vector<CodeRed::Transform3D>(sphereCount);
 	
@@ -1,8 +1,23 @@
 #include "EffectPassDemoApp.hpp"
 
-int main() {
-	auto app = EffectPassDemoApp("EffectPassDemoApp", 1280, 720);
+#include <cstring>
+
+int main(int argc, char** argv) {
+	//run without window with "--headless [--frames count] [--timestep seconds] [--trace fileName]"
+	//benchmark with "--benchmark fileName [--baseline fileName] [--tolerance value]", it fails if it regresses
+	//check the steady state with "--max-allocations 0 [--warmup frames]", it fails if a frame allocates
+	//record the draw calls with "--threads count" threads and the thread of demo, benchmark it with different threads to see the scaling
+	Demo::DemoApp::setHeadless(Demo::HeadlessInfo::fromCommandLine(argc, argv));
+
+	auto threads = CodeRed::JobSystem::defaultThreads();
+
+	for (auto index = 1; index + 1 < argc; index++)
+		if (std::strcmp(argv[index], "--threads") == 0) threads = static_cast<size_t>(std::stoull(argv[index + 1]));
+
+	auto app = EffectPassDemoApp("EffectPassDemoApp", 1280, 720, threads);
 
 	app.show();
 	app.runLoop();
+
+	return app.exitCode();
 }
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "FlowersDemoApp.hpp"
 
+//the keys of frame resources, the names are interned once when the program starts
+static const CodeRed::FrameResourceKey<CodeRed::GpuFrameBuffer> FrameBufferKey("FrameBuffer");
+static const CodeRed::FrameResourceKey<CodeRed::GpuDescriptorHeap> DescriptorHeapKey("DescriptorHeap");
+static const CodeRed::FrameResourceKey<CodeRed::GpuBuffer> TransformedPositionsKey("TransformedPositions");
+static const CodeRed::FrameResourceKey<CodeRed::GpuBuffer> ColorsKey("Colors");
+
 FlowersDemoUIComponent::FlowersDemoUIComponent()
 {	
 	mProgramStateView = std::make_shared<CodeRed::ImGuiView>([&]
@@ -34,6 +40,13 @@ FlowersDemoApp::FlowersDemoApp(
 #endif
 #endif	
 {
+	//the flowers rotate with fixed time step, so they rotate the same on every machine
+	setFixedStep(Demo::FixedStepInfo(1.0f / 60.0f, 4));
+
+#ifdef __PIPELINED__MODE__
+	setPipelined(true);
+#endif
+
 	initialize();
 }
 
@@ -44,60 +57,76 @@ FlowersDemoApp::~FlowersDemoApp()
 	mCommandQueue->waitIdle();
 }
 
-void FlowersDemoApp::update(float delta)
+void FlowersDemoApp::simulate(float step)
 {
-	//when we pause the program, we do not update the flowers
-	if (mUIComponent->Pause == false) mFlowersGenerator->update(delta);
+	//when we pause the program, we update the flowers with zero time
+	//so the previous positions are same as the current positions and the interpolation stops
+	mFlowersGenerator->update(mPause ? 0.0f : step);
+}
 
-	const auto buffer = mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuBuffer>("TransformedPositions");
+void FlowersDemoApp::publish(size_t slot)
+{
+	mFlowersGenerator->interpolate(mFrameSlots[slot].data(), interpolationFactor());
+}
+
+void FlowersDemoApp::waitFrame()
+{
+	//wait for the frame that used this slot, so we can write the frame resources of it
+	mCurrentFrameIndex = mFramePacer->beginFrame();
+}
+
+void FlowersDemoApp::update(float delta)
+{
+	const auto buffer = mFrameResources[mCurrentFrameIndex].get(TransformedPositionsKey);
 
 	const auto memory = buffer->mapMemory();
-	std::memcpy(memory, mFlowersGenerator->positions(), buffer->size());
+	std::memcpy(memory, mFrameSlots[frameSlot()].data(), buffer->size());
 	buffer->unmapMemory();
 
 	mImGuiWindows->update();
+
+	mPause = mUIComponent->Pause;
 }
 
 void FlowersDemoApp::render(float delta)
 {
 	const auto frameBuffer =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuFrameBuffer>("FrameBuffer");
+		mFrameResources[mCurrentFrameIndex].get(FrameBufferKey);
 	const auto descriptorHeap =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuDescriptorHeap>("DescriptorHeap");
+		mFrameResources[mCurrentFrameIndex].get(DescriptorHeapKey);
 
-	mCommandQueue->waitIdle();
-	mCommandAllocator->reset();
+	auto commandList = mFramePacer->commandList();
 
-	mCommandList->beginRecording();
+	commandList->beginRecording();
 
-	mCommandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
-	mCommandList->setResourceLayout(mPipelineInfo->resourceLayout());
+	commandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
+	commandList->setResourceLayout(mPipelineInfo->resourceLayout());
 
-	mCommandList->setViewPort(frameBuffer->fullViewPort());
-	mCommandList->setScissorRect(frameBuffer->fullScissorRect());
+	commandList->setViewPort(frameBuffer->fullViewPort());
+	commandList->setScissorRect(frameBuffer->fullScissorRect());
 
-	mCommandList->setVertexBuffer(mVertexBuffer);
-	mCommandList->setIndexBuffer(mIndexBuffer);
+	commandList->setVertexBuffer(mVertexBuffer);
+	commandList->setIndexBuffer(mIndexBuffer);
 
-	mCommandList->setDescriptorHeap(descriptorHeap);
+	commandList->setDescriptorHeap(descriptorHeap);
 
-	mCommandList->beginRenderPass(
+	commandList->beginRenderPass(
 		mPipelineInfo->renderPass(),
 		frameBuffer);
 
-	mCommandList->drawIndexed(3, mUIComponent->NowFlowers * 8);
+	commandList->drawIndexed(3, mUIComponent->NowFlowers * 8);
 
-	mImGuiWindows->draw(mCommandList);
+	mImGuiWindows->draw(commandList);
 	
-	mCommandList->endRenderPass();
+	commandList->endRenderPass();
 
-	mCommandList->endRecording();
+	commandList->endRecording();
 
-	mCommandQueue->execute({ mCommandList });
+	mCommandQueue->execute(mFramePacer->commandLists());
 
-	mSwapChain->present();
+	mPresentTargets->present();
 
-	mCurrentFrameIndex = (mCurrentFrameIndex + 1) % maxFrameResources;
+	mFramePacer->endFrame();
 }
 
 void FlowersDemoApp::initialize()
@@ -120,6 +149,9 @@ void FlowersDemoApp::initialize()
 #endif
 #endif
 
+	//the pipeline cache is only valid for the adapter we created the device on
+	loadPipelineCache(adapters[0], mDevice);
+
 	initializeFlowers();
 	initializeCommands();
 	initializeSwapChain();
@@ -136,13 +168,25 @@ void FlowersDemoApp::initializeFlowers()
 {
 	mFlowersGenerator = std::make_shared<FlowersGenerator>(
 		width(), height(), flowersCount);
+
+	for (auto& positions : mFrameSlots) {
+		positions.resize(flowersCount * 8);
+
+		mFlowersGenerator->interpolate(positions.data(), 1.0f);
+	}
 }
 
 void FlowersDemoApp::initializeCommands()
 {
 	mCommandAllocator = mDevice->createCommandAllocator();
 	mCommandQueue = mDevice->createCommandQueue();
-	mCommandList = mDevice->createGraphicsCommandList(mCommandAllocator);
+
+	//every frame in flight has its own command allocator and command list
+	//we only wait for the frame that used the same slot before
+	mFramePacer = std::make_shared<CodeRed::FramePacer>(
+		mDevice,
+		std::make_shared<CodeRed::QueueFrameFence>(mDevice, mCommandQueue),
+		maxFrameResources);
 }
 
 void FlowersDemoApp::initializeSwapChain()
@@ -150,18 +194,26 @@ void FlowersDemoApp::initializeSwapChain()
 	//create the swap chain
 	//if we want to write the back buffer(to window)
 	//we need use the queue that create the swap chain to submit the draw commands
-	mSwapChain = mDevice->createSwapChain(
-		mCommandQueue,
-		{ width(), height(), handle() },
-		CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
-		maxFrameResources
-	);
+	//in headless mode, there is no window, so we render to offscreen textures
+	mPresentTargets = isHeadless() ?
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice,
+			width(), height(),
+			CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+			maxFrameResources) :
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice->createSwapChain(
+				mCommandQueue,
+				{ width(), height(), handle() },
+				CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+				maxFrameResources
+			));
 
 	for (size_t index = 0; index < maxFrameResources; index++) {
 		mFrameResources[index].set(
-			"FrameBuffer",
+			FrameBufferKey,
 			mDevice->createFrameBuffer(
-				{ mSwapChain->buffer(index)->reference() },
+				{ mPresentTargets->buffer(index)->reference() },
 				nullptr
 			)
 		);
@@ -195,7 +247,7 @@ void FlowersDemoApp::initializeBuffers()
 
 	for (auto& frameResource : mFrameResources) {
 		frameResource.set(
-			"TransformedPositions",
+			TransformedPositionsKey,
 			mDevice->createBuffer(
 				CodeRed::ResourceInfo::GroupBuffer(
 					sizeof(glm::vec2) * 3,
@@ -205,7 +257,7 @@ void FlowersDemoApp::initializeBuffers()
 		);
 
 		frameResource.set(
-			"Colors",
+			ColorsKey,
 			mDevice->createBuffer(
 				CodeRed::ResourceInfo::GroupBuffer(
 					sizeof(glm::vec4) * 3,
@@ -215,7 +267,7 @@ void FlowersDemoApp::initializeBuffers()
 			)
 		);
 
-		auto colors = frameResource.get<CodeRed::GpuBuffer>("Colors");
+		auto colors = frameResource.get(ColorsKey);
 
 		CodeRed::ResourceHelper::updateBuffer(mDevice, mCommandAllocator, mCommandQueue, colors, mFlowersGenerator->colors());
 	}
@@ -343,7 +395,7 @@ void FlowersDemoApp::initializePipeline()
 
 	mPipelineInfo->setRenderPass(
 		mDevice->createRenderPass(
-			{ CodeRed::Attachment::RenderTarget(mSwapChain->format()) }
+			{ CodeRed::Attachment::RenderTarget(mPresentTargets->format()) }
 		)
 	);
 
@@ -368,6 +420,7 @@ void FlowersDemoApp::initializeImGuiWindows()
 		maxFrameResources);
 
 	mImGuiWindows->add("Tool", "Program State", mUIComponent->programStateView());
+	mImGuiWindows->add("Tool", "Profiler", CodeRed::ProfilerView::create());
 	mImGuiWindows->add("Tool", "Flowers", mUIComponent->flowersView());
 }
 
@@ -378,15 +431,15 @@ void FlowersDemoApp::initializeDescriptorHeaps()
 			mPipelineInfo->resourceLayout()
 		);
 
-		auto transformedPositions = frameResource.get<CodeRed::GpuBuffer>("TransformedPositions");
-		auto colors = frameResource.get<CodeRed::GpuBuffer>("Colors");
+		auto transformedPositions = frameResource.get(TransformedPositionsKey);
+		auto colors = frameResource.get(ColorsKey);
 
 		descriptorHeap->bindBuffer(transformedPositions, 0);
 		descriptorHeap->bindBuffer(colors, 1);
 		descriptorHeap->bindBuffer(mViewBuffer, 2);
 		
 		frameResource.set(
-			"DescriptorHeap",
+			DescriptorHeapKey,
 			descriptorHeap
 		);
 	}
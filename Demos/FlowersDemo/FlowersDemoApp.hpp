@@ -2,17 +2,28 @@
 
 #include <Shaders/ShaderCompiler.hpp>
 #include <Resources/FrameResources.hpp>
+#include <Resources/FramePacer.hpp>
+#include <Resources/PresentTargets.hpp>
 #include <Resources/ResourceHelper.hpp>
 #include <Pipelines/PipelineInfo.hpp>
 #include <DemoApp.hpp>
 
 #include <Extensions/ImGui/ImGuiWindows.hpp>
+#include <Profiling/ProfilerView.hpp>
 
 #include "FlowersGenerator.hpp"
 
+#include <atomic>
+
+//directx 12 is only on windows, the other platforms use vulkan
+#ifdef _WIN32
 #define __DIRECTX12__MODE__
+#endif
 #define __VULKAN__MODE__
 
+//simulate the flowers of next frame on another thread while we render current frame
+#define __PIPELINED__MODE__
+
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 
@@ -41,6 +52,9 @@ public:
 
 	~FlowersDemoApp();
 private:
+	void simulate(float step) override;
+	void publish(size_t slot) override;
+	void waitFrame() override;
 	void update(float delta) override;
 	void render(float delta) override;
 
@@ -72,12 +86,15 @@ private:
 	size_t mCurrentFrameIndex = 0;
 
 	std::shared_ptr<CodeRed::GpuLogicalDevice> mDevice;
-	std::shared_ptr<CodeRed::GpuSwapChain> mSwapChain;
+	std::shared_ptr<CodeRed::PresentTargets> mPresentTargets;
 
+	//the command allocator is only used to upload resources when we initialize
+	//the frames use the command allocators and command lists of frame pacer
 	std::shared_ptr<CodeRed::GpuCommandAllocator> mCommandAllocator;
-	std::shared_ptr<CodeRed::GpuGraphicsCommandList> mCommandList;
 	std::shared_ptr<CodeRed::GpuCommandQueue> mCommandQueue;
 
+	std::shared_ptr<CodeRed::FramePacer> mFramePacer;
+
 	std::vector<CodeRed::FrameResources> mFrameResources =
 		std::vector<CodeRed::FrameResources>(maxFrameResources);
 
@@ -93,6 +110,13 @@ private:
 
 	std::shared_ptr<FlowersGenerator> mFlowersGenerator;
 
+	//the interpolated positions that the simulation publishes for update
+	std::vector<std::vector<LeafPosition2>> mFrameSlots =
+		std::vector<std::vector<LeafPosition2>>(maxFrameSlots);
+
+	//the pause state of ui, it is written by update and read by simulate
+	std::atomic<bool> mPause = false;
+
 	std::vector<CodeRed::Byte> mVertexShaderCode;
 	std::vector<CodeRed::Byte> mPixelShaderCode;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "FlowersGenerator.hpp"
 
+#include <Profiling/Profiler.hpp>
+
 #include <random>
 
 auto generateColor(
@@ -82,10 +84,16 @@ FlowersGenerator::FlowersGenerator(
 		mTransforms[index] = glm::translate(glm::mat4(1), glm::vec3(position, 0.0f));
 		mSpeeds[index] = sRange(random);
 	}
+
+	transformPositions();
+
+	mPreviousPositions = mTransformedPositions;
 }
 
 void FlowersGenerator::update(float delta)
-{	
+{
+	CODE_RED_PROFILE_ZONE("FlowersGenerator::update");
+
 	for (size_t index = 0; index < mTransforms.size(); index++) {
 		const auto speed = mSpeeds[index];
 		const auto angle = delta * speed;
@@ -93,12 +101,23 @@ void FlowersGenerator::update(float delta)
 		mTransforms[index] = glm::rotate(mTransforms[index], angle, glm::vec3(0, 0, 1));
 	}
 
-	for (size_t index = 0; index < mPositions.size(); index++) {
-		auto& transform = mTransforms[index / 8];
+	//the vectors have the same size, so the copy does not allocate memory
+	mPreviousPositions = mTransformedPositions;
+
+	transformPositions();
+}
+
+void FlowersGenerator::interpolate(void* memory, const float factor) const
+{
+	const auto positions = static_cast<LeafPosition2*>(memory);
+
+	//the leaves rotate a small angle in one update, so the linear interpolation is close to the arc
+	for (size_t index = 0; index < mTransformedPositions.size(); index++) {
+		const auto& previous = mPreviousPositions[index];
+		const auto& current = mTransformedPositions[index];
 
 		for (size_t offset = 0; offset < 3; offset++) {
-			mTransformedPositions[index].Point[offset] =
-				transform * glm::vec4(mPositions[index].Point[offset], 0.0f, 1.0f);
+			positions[index].Point[offset] = glm::mix(previous.Point[offset], current.Point[offset], factor);
 		}
 	}
 }
@@ -112,3 +131,15 @@ auto FlowersGenerator::colors() noexcept -> void*
 {
 	return mColors.data();
 }
+
+void FlowersGenerator::transformPositions()
+{
+	for (size_t index = 0; index < mPositions.size(); index++) {
+		auto& transform = mTransforms[index / 8];
+
+		for (size_t offset = 0; offset < 3; offset++) {
+			mTransformedPositions[index].Point[offset] =
+				transform * glm::vec4(mPositions[index].Point[offset], 0.0f, 1.0f);
+		}
+	}
+}
@@ -23,7 +23,13 @@ public:
 
 	auto positions() noexcept -> void*;
 
+	//write the interpolation of positions before and after the last update to memory
+	//the memory should have the same size as positions
+	void interpolate(void* memory, const float factor) const;
+
 	auto colors() noexcept -> void*;
+private:
+	void transformPositions();
 private:
 	const float minRadius = 100.0f;
 	const float maxRadius = 200.0f;
@@ -37,6 +43,7 @@ private:
 	std::vector<float> mSpeeds;
 	
 	std::vector<LeafPosition2> mTransformedPositions;
+	std::vector<LeafPosition2> mPreviousPositions;
 	std::vector<LeafPosition2> mPositions;
 	std::vector<LeafColor> mColors;
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "ParticleEmitter.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+
+ParticleEmitter::ParticleEmitter(
+	const glm::vec2& position,
+	const float rate,
+	const float life,
+	const float maxSize,
+	const unsigned seed) :
+	mPosition(position), mRate(rate), mLife(life), mMaxSize(maxSize), mRandom(seed)
+{
+}
+
+void ParticleEmitter::emit(ParticleSystem& system, const float step)
+{
+	std::uniform_real_distribution<float> angleRange(0.0f, glm::two_pi<float>());
+	std::uniform_real_distribution<float> sizeRange(mMaxSize * 0.4f, mMaxSize);
+
+	mAccumulator = mAccumulator + mRate * step;
+
+	for (; mAccumulator >= 1.0f; mAccumulator = mAccumulator - 1.0f) {
+		const auto angle = angleRange(mRandom);
+
+		system.spawn(
+			Particle(
+				mPosition,
+				glm::vec2(std::cos(angle), std::sin(angle)),
+				glm::vec2(sizeRange(mRandom))),
+			mLife);
+	}
+}
+
+auto ParticleEmitter::capacity(const float step) const noexcept -> size_t
+{
+	return static_cast<size_t>(std::ceil(mRate * (mLife + step))) + 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ParticleSystem.hpp"
+
+#include <random>
+
+//spawn particles at a point with random directions, the particles live for a fixed time
+//the size of particles is in [maxSize * 0.4, maxSize], the grid of collision needs its cells to be not smaller than maxSize
+class ParticleEmitter final {
+public:
+	ParticleEmitter(
+		const glm::vec2& position,
+		const float rate,
+		const float life,
+		const float maxSize,
+		const unsigned seed = 0);
+
+	//spawn the particles of this step, the particles are dropped if the pool is full
+	void emit(ParticleSystem& system, const float step);
+
+	//the most particles of this emitter that are alive at the same time, if the emitter is updated with step
+	//the particles die in the first update after their life is over, so they live one step more at most
+	auto capacity(const float step) const noexcept -> size_t;
+private:
+	glm::vec2 mPosition = glm::vec2(0);
+
+	//the particles spawned in one second
+	float mRate = 0;
+	float mLife = 0;
+	float mMaxSize = 1;
+
+	//the part of particle that is not spawned in last steps
+	float mAccumulator = 0;
+
+	std::default_random_engine mRandom;
+};
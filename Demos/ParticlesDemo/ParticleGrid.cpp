@@ -0,0 +1,251 @@
+#include "ParticleGrid.hpp"
+
+#include <Profiling/Profiler.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+ParticleGrid::ParticleGrid(
+	const float cellSize,
+	const float width,
+	const float height,
+	const size_t capacity) :
+	mCellSize(cellSize)
+{
+	mColumns = std::max(static_cast<size_t>(std::ceil(width / mCellSize)), static_cast<size_t>(1));
+	mRows = std::max(static_cast<size_t>(std::ceil(height / mCellSize)), static_cast<size_t>(1));
+
+	mCellStarts.resize(mColumns * mRows + 1);
+	mJobCells.resize(mColumns * mRows);
+
+	mCells.resize(capacity);
+	mSorted.resize(capacity);
+	mCenterX.resize(capacity);
+	mCenterY.resize(capacity);
+	mRadius.resize(capacity);
+	mForwardX.resize(capacity);
+	mForwardY.resize(capacity);
+}
+
+void ParticleGrid::build(const ParticleStreams& streams, const size_t count)
+{
+	CODE_RED_PROFILE_ZONE("ParticleGrid::build");
+
+	mCount = count;
+
+	const auto range = CodeRed::JobRange(0, 1, 0, mCount);
+
+	countCells(streams, range);
+	sumCells(1);
+	scatterCells(streams, range);
+}
+
+void ParticleGrid::build(
+	const ParticleStreams& streams,
+	const size_t count,
+	CodeRed::JobSystem& jobSystem,
+	const size_t minParticles)
+{
+	CODE_RED_PROFILE_ZONE("ParticleGrid::build");
+
+	mCount = count;
+
+	//the grid is empty, we do not run any job
+	if (mCount == 0) { std::fill(mCellStarts.begin(), mCellStarts.end(), 0); return; }
+
+	//the jobs are not more than workers, so the counts of jobs only allocate when we build the first grid
+	const auto cells = mColumns * mRows;
+
+	if (mJobCells.size() < jobSystem.workers() * cells) mJobCells.resize(jobSystem.workers() * cells);
+
+	//the two dispatches have same count and minParticles, so they split the particles into same ranges
+	size_t jobs = 1;
+
+	jobSystem.parallelFor(mCount, minParticles, [&](const CodeRed::JobRange& range)
+		{
+			if (range.first()) jobs = range.Count;
+
+			countCells(streams, range);
+		});
+
+	sumCells(jobs);
+
+	jobSystem.parallelFor(mCount, minParticles, [&](const CodeRed::JobRange& range)
+		{
+			scatterCells(streams, range);
+		});
+}
+
+void ParticleGrid::collide(const ParticleStreams& streams, const size_t begin, const size_t end) const
+{
+	CODE_RED_PROFILE_ZONE("ParticleGrid::collide");
+
+	//a cell belongs to the range that has its first particle, so every cell is resolved by one range
+	const auto endCell = cellAt(end);
+
+	for (auto cell = cellAt(begin); cell < endCell; cell++) {
+		const auto row = cell / mColumns;
+		const auto column = cell % mColumns;
+
+		const auto firstRow = row == 0 ? 0 : row - 1;
+		const auto lastRow = std::min(row + 1, mRows - 1);
+
+		const auto firstColumn = column == 0 ? 0 : column - 1;
+		const auto lastColumn = std::min(column + 1, mColumns - 1);
+
+		for (auto particle = mCellStarts[cell]; particle < mCellStarts[cell + 1]; particle++) {
+			Response response;
+
+			for (auto neighbor = firstRow; neighbor <= lastRow; neighbor++) {
+				respond(particle,
+					mCellStarts[neighbor * mColumns + firstColumn],
+					mCellStarts[neighbor * mColumns + lastColumn + 1],
+					response);
+			}
+
+			apply(streams, particle, response);
+		}
+	}
+}
+
+void ParticleGrid::collideBruteForce(const ParticleStreams& streams, const size_t begin, const size_t end) const
+{
+	CODE_RED_PROFILE_ZONE("ParticleGrid::collideBruteForce");
+
+	for (auto particle = begin; particle < end; particle++) {
+		Response response;
+
+		respond(particle, 0, mCount, response);
+
+		apply(streams, particle, response);
+	}
+}
+
+auto ParticleGrid::cellOf(const float x, const float y) const noexcept -> size_t
+{
+	//the particles out of the grid are in the cells of border
+	const auto column = std::min(static_cast<size_t>(std::max(x / mCellSize, 0.0f)), mColumns - 1);
+	const auto row = std::min(static_cast<size_t>(std::max(y / mCellSize, 0.0f)), mRows - 1);
+
+	return row * mColumns + column;
+}
+
+auto ParticleGrid::cellAt(const size_t particle) const noexcept -> size_t
+{
+	//the starts of cells are sorted, the empty cells have the same start as the next cell
+	return static_cast<size_t>(std::lower_bound(mCellStarts.begin(), mCellStarts.end() - 1, particle) - mCellStarts.begin());
+}
+
+void ParticleGrid::countCells(const ParticleStreams& streams, const CodeRed::JobRange& range)
+{
+	const auto cells = mColumns * mRows;
+	const auto counts = mJobCells.data() + range.Index * cells;
+
+	std::fill(counts, counts + cells, 0);
+
+	//the particle is drawn in [position, position + size], so the center is position + size * 0.5
+	for (auto index = range.Begin; index < range.End; index++) {
+		//a particle larger than the cell may collide with particles out of the 3 x 3 cells, we would miss them
+		CODE_RED_DEBUG_THROW_IF(
+			streams.SizeX[index] > mCellSize,
+			CodeRed::InvalidException<float>({ "particle size" })
+		);
+
+		const auto cell = cellOf(
+			streams.PositionX[index] + streams.SizeX[index] * 0.5f,
+			streams.PositionY[index] + streams.SizeY[index] * 0.5f);
+
+		mCells[index] = static_cast<unsigned>(cell);
+		counts[cell]++;
+	}
+}
+
+void ParticleGrid::sumCells(const size_t jobs)
+{
+	const auto cells = mColumns * mRows;
+
+	unsigned start = 0;
+
+	//the particles of job j in a cell are after the particles of jobs [0, j) in the same cell
+	for (size_t cell = 0; cell < cells; cell++) {
+		mCellStarts[cell] = start;
+
+		for (size_t job = 0; job < jobs; job++) {
+			const auto count = mJobCells[job * cells + cell];
+
+			mJobCells[job * cells + cell] = start;
+
+			start = start + count;
+		}
+	}
+
+	mCellStarts[cells] = start;
+}
+
+void ParticleGrid::scatterCells(const ParticleStreams& streams, const CodeRed::JobRange& range)
+{
+	const auto cursors = mJobCells.data() + range.Index * mColumns * mRows;
+
+	for (auto index = range.Begin; index < range.End; index++) {
+		const auto sorted = cursors[mCells[index]]++;
+
+		mSorted[sorted] = static_cast<unsigned>(index);
+		mCenterX[sorted] = streams.PositionX[index] + streams.SizeX[index] * 0.5f;
+		mCenterY[sorted] = streams.PositionY[index] + streams.SizeY[index] * 0.5f;
+		mRadius[sorted] = streams.SizeX[index] * 0.5f;
+		mForwardX[sorted] = streams.ForwardX[index];
+		mForwardY[sorted] = streams.ForwardY[index];
+	}
+}
+
+void ParticleGrid::respond(const size_t particle, const size_t begin, const size_t end, Response& response) const
+{
+	const auto centerX = mCenterX[particle];
+	const auto centerY = mCenterY[particle];
+	const auto radius = mRadius[particle];
+	const auto forwardX = mForwardX[particle];
+	const auto forwardY = mForwardY[particle];
+
+	for (auto other = begin; other < end; other++) {
+		const auto dx = centerX - mCenterX[other];
+		const auto dy = centerY - mCenterY[other];
+		const auto distance2 = dx * dx + dy * dy;
+		const auto range = radius + mRadius[other];
+
+		//the particle itself and the particles at the same center have no normal
+		if (distance2 >= range * range || distance2 == 0.0f) continue;
+
+		const auto distance = std::sqrt(distance2);
+		const auto normalX = dx / distance;
+		const auto normalY = dy / distance;
+
+		//the elastic collision of same mass, only the particles that move closer exchange the velocity
+		const auto approach = (forwardX - mForwardX[other]) * normalX + (forwardY - mForwardY[other]) * normalY;
+
+		if (approach < 0.0f) {
+			response.ForwardX = response.ForwardX - approach * normalX;
+			response.ForwardY = response.ForwardY - approach * normalY;
+		}
+
+		//both particles move half of the overlap
+		const auto push = (range - distance) * 0.5f;
+
+		response.OffsetX = response.OffsetX + normalX * push;
+		response.OffsetY = response.OffsetY + normalY * push;
+		response.Contacts++;
+	}
+}
+
+void ParticleGrid::apply(const ParticleStreams& streams, const size_t particle, const Response& response) const
+{
+	if (response.Contacts == 0) return;
+
+	//the contacts are resolved at the same time, we average them so the crowded particles are stable
+	const auto weight = 1.0f / static_cast<float>(response.Contacts);
+	const auto index = mSorted[particle];
+
+	streams.ForwardX[index] = mForwardX[particle] + response.ForwardX * weight;
+	streams.ForwardY[index] = mForwardY[particle] + response.ForwardY * weight;
+	streams.PositionX[index] = streams.PositionX[index] + response.OffsetX * weight;
+	streams.PositionY[index] = streams.PositionY[index] + response.OffsetY * weight;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ParticleSystem.hpp"
+
+#include <Threads/JobSystem.hpp>
+
+#include <vector>
+
+/*
+ * the uniform grid of particles for collision, it is built in every step with counting sort
+ * 1. every job counts the particles of its range in every cell
+ * 2. the prefix sum of counts finds the start of cells, and the start of every job in every cell
+ * 3. every job scatters its particles to their cells, the states are copied in the sorted order
+ * the jobs are continuous ranges of pool, so the particles of a cell keep the order of pool with any number of jobs
+ * the cell is not smaller than the diameter of particles, so a particle only collides with the particles
+ * in the 3 x 3 cells around it, and the cells in one row of them are a continuous range of sorted states
+ * the collision reads the sorted states and writes the particles, so the particles can collide in parallel
+ */
+class ParticleGrid final {
+public:
+	ParticleGrid(
+		const float cellSize,
+		const float width,
+		const float height,
+		const size_t capacity);
+
+	void build(const ParticleStreams& streams, const size_t count);
+
+	//build the grid with the jobs of job system, every job has minParticles particles at least
+	void build(
+		const ParticleStreams& streams,
+		const size_t count,
+		CodeRed::JobSystem& jobSystem,
+		const size_t minParticles);
+
+	//resolve the collisions of the cells whose first sorted particle is in [begin, end) with the particles in neighbor cells
+	//so the jobs split by the sorted particles resolve about the same particles, and they can run on different threads
+	void collide(const ParticleStreams& streams, const size_t begin, const size_t end) const;
+
+	//resolve the collisions of the sorted particles [begin, end) with all particles
+	//it is only used to compare with the grid
+	void collideBruteForce(const ParticleStreams& streams, const size_t begin, const size_t end) const;
+
+	auto size() const noexcept -> size_t { return mCount; }
+private:
+	struct Response {
+		float ForwardX = 0;
+		float ForwardY = 0;
+		float OffsetX = 0;
+		float OffsetY = 0;
+
+		size_t Contacts = 0;
+	};
+
+	auto cellOf(const float x, const float y) const noexcept -> size_t;
+
+	//the first cell whose first sorted particle is not before the particle
+	auto cellAt(const size_t particle) const noexcept -> size_t;
+
+	//count the particles of job in every cell
+	void countCells(const ParticleStreams& streams, const CodeRed::JobRange& range);
+
+	//find the start of cells and the start of jobs in every cell
+	void sumCells(const size_t jobs);
+
+	//move the states of the particles of job to their sorted order
+	void scatterCells(const ParticleStreams& streams, const CodeRed::JobRange& range);
+
+	//accumulate the response of sorted particle with the sorted particles [begin, end)
+	void respond(const size_t particle, const size_t begin, const size_t end, Response& response) const;
+
+	void apply(const ParticleStreams& streams, const size_t particle, const Response& response) const;
+private:
+	float mCellSize = 1;
+
+	size_t mColumns = 1;
+	size_t mRows = 1;
+
+	size_t mCount = 0;
+
+	//the indices are 32 bits, so the sort moves less memory
+	//the start of cells in the sorted particles, the last one is the count of particles
+	std::vector<unsigned> mCellStarts;
+
+	//the counts of job in cells, then they are the cursors of job in cells when we scatter the particles
+	//the cells of a job are continuous, so the jobs only share the cache lines at the ends of them
+	std::vector<unsigned> mJobCells;
+
+	//the cell of particles in the order of pool
+	std::vector<unsigned> mCells;
+
+	//the states in the sorted order, mSorted is the index of particle in the pool
+	std::vector<unsigned> mSorted;
+	std::vector<float> mCenterX;
+	std::vector<float> mCenterY;
+	std::vector<float> mRadius;
+	std::vector<float> mForwardX;
+	std::vector<float> mForwardY;
+};
@@ -0,0 +1,290 @@
+#include "ParticleSystem.hpp"
+
+#include <Profiling/Profiler.hpp>
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define __PARTICLE__SSE__
+#endif
+
+static auto paddedCount(const size_t count) -> size_t
+{
+	return (count + ParticleSystem::paddingCount - 1) / ParticleSystem::paddingCount * ParticleSystem::paddingCount;
+}
+
+//move one component of particles, if the particle is out of [0, bound] we reverse the offset and forward
+//the reverse is xor with the sign bit of the compare mask, so there is no branch
+//count is a multiple of paddingCount, so an iteration updates a block(2 AVX or 4 SSE vectors)
+//the inner loop has a constant count, so it is unrolled and the independent vectors overlap
+static void updateComponent(
+	float* position,
+	float* previous,
+	float* forward,
+	const float* size,
+	const float length,
+	const float bound,
+	const size_t count)
+{
+#if defined(__AVX__)
+	const auto lengths = _mm256_set1_ps(length);
+	const auto bounds = _mm256_set1_ps(bound);
+	const auto zeros = _mm256_setzero_ps();
+	const auto signs = _mm256_set1_ps(-0.0f);
+
+	for (size_t block = 0; block < count; block += ParticleSystem::paddingCount) {
+		for (auto index = block; index < block + ParticleSystem::paddingCount; index += ParticleSystem::laneCount) {
+			const auto positions = _mm256_loadu_ps(position + index);
+			const auto forwards = _mm256_loadu_ps(forward + index);
+			const auto sizes = _mm256_loadu_ps(size + index);
+
+			const auto offsets = _mm256_mul_ps(forwards, lengths);
+			const auto targets = _mm256_add_ps(positions, offsets);
+
+			const auto out = _mm256_or_ps(
+				_mm256_cmp_ps(_mm256_sub_ps(targets, sizes), zeros, _CMP_LT_OQ),
+				_mm256_cmp_ps(_mm256_add_ps(targets, sizes), bounds, _CMP_GT_OQ));
+			const auto reverse = _mm256_and_ps(out, signs);
+
+			_mm256_storeu_ps(previous + index, positions);
+			_mm256_storeu_ps(position + index, _mm256_add_ps(positions, _mm256_xor_ps(offsets, reverse)));
+			_mm256_storeu_ps(forward + index, _mm256_xor_ps(forwards, reverse));
+		}
+	}
+#elif defined(__PARTICLE__SSE__)
+	const auto lengths = _mm_set1_ps(length);
+	const auto bounds = _mm_set1_ps(bound);
+	const auto zeros = _mm_setzero_ps();
+	const auto signs = _mm_set1_ps(-0.0f);
+
+	for (size_t block = 0; block < count; block += ParticleSystem::paddingCount) {
+		for (auto index = block; index < block + ParticleSystem::paddingCount; index += ParticleSystem::laneCount) {
+			const auto positions = _mm_loadu_ps(position + index);
+			const auto forwards = _mm_loadu_ps(forward + index);
+			const auto sizes = _mm_loadu_ps(size + index);
+
+			const auto offsets = _mm_mul_ps(forwards, lengths);
+			const auto targets = _mm_add_ps(positions, offsets);
+
+			const auto out = _mm_or_ps(
+				_mm_cmplt_ps(_mm_sub_ps(targets, sizes), zeros),
+				_mm_cmpgt_ps(_mm_add_ps(targets, sizes), bounds));
+			const auto reverse = _mm_and_ps(out, signs);
+
+			_mm_storeu_ps(previous + index, positions);
+			_mm_storeu_ps(position + index, _mm_add_ps(positions, _mm_xor_ps(offsets, reverse)));
+			_mm_storeu_ps(forward + index, _mm_xor_ps(forwards, reverse));
+		}
+	}
+#else
+	for (size_t index = 0; index < count; index++) {
+		const auto offset = forward[index] * length;
+		const auto target = position[index] + offset;
+		const auto sign = (target - size[index] < 0 || target + size[index] > bound) ? -1.0f : 1.0f;
+
+		previous[index] = position[index];
+		position[index] = position[index] + offset * sign;
+		forward[index] = forward[index] * sign;
+	}
+#endif
+}
+
+ParticleSystem::ParticleSystem(const size_t capacity) :
+	mCapacity(capacity)
+{
+	const auto padded = paddedCount(mCapacity);
+
+	mPositionX.resize(padded, 0.0f);
+	mPositionY.resize(padded, 0.0f);
+	mPreviousX.resize(padded, 0.0f);
+	mPreviousY.resize(padded, 0.0f);
+	mForwardX.resize(padded, 0.0f);
+	mForwardY.resize(padded, 0.0f);
+	mSizeX.resize(padded, 0.0f);
+	mSizeY.resize(padded, 0.0f);
+	mLife.resize(padded, 0.0f);
+
+	mExpiredBlocks.resize(padded / paddingCount, 0);
+}
+
+auto ParticleSystem::spawn(const Particle& particle, const float life) -> bool
+{
+	if (mCount == mCapacity) return false;
+
+	const auto index = mCount++;
+
+	mPositionX[index] = mPreviousX[index] = particle.Position.x;
+	mPositionY[index] = mPreviousY[index] = particle.Position.y;
+	mForwardX[index] = particle.Forward.x;
+	mForwardY[index] = particle.Forward.y;
+	mSizeX[index] = particle.Size.x;
+	mSizeY[index] = particle.Size.y;
+	mLife[index] = life;
+
+	return true;
+}
+
+void ParticleSystem::kill(const size_t index)
+{
+	CODE_RED_DEBUG_THROW_IF(
+		index >= mCount,
+		CodeRed::InvalidException<size_t>({ "index" })
+	);
+
+	const auto last = --mCount;
+
+	mPositionX[index] = mPositionX[last];
+	mPositionY[index] = mPositionY[last];
+	mPreviousX[index] = mPreviousX[last];
+	mPreviousY[index] = mPreviousY[last];
+	mForwardX[index] = mForwardX[last];
+	mForwardY[index] = mForwardY[last];
+	mSizeX[index] = mSizeX[last];
+	mSizeY[index] = mSizeY[last];
+	mLife[index] = mLife[last];
+}
+
+void ParticleSystem::killExpired()
+{
+	CODE_RED_PROFILE_ZONE("ParticleSystem::killExpired");
+
+	//walk backward, so the particle moved to the hole is already checked
+	//kill() only moves the particles into the block we are checking, so the unmarked blocks are still alive
+	for (auto block = blocks(); block > 0; block--) {
+		if (!mExpiredBlocks[block - 1]) continue;
+
+		for (auto index = std::min(block * paddingCount, mCount); index > (block - 1) * paddingCount; index--) {
+			if (mLife[index - 1] <= 0.0f) kill(index - 1);
+		}
+	}
+}
+
+auto ParticleSystem::particle(const size_t index) const -> Particle
+{
+	return Particle(
+		glm::vec2(mPositionX[index], mPositionY[index]),
+		glm::vec2(mForwardX[index], mForwardY[index]),
+		glm::vec2(mSizeX[index], mSizeY[index]));
+}
+
+auto ParticleSystem::streams() noexcept -> ParticleStreams
+{
+	ParticleStreams streams;
+
+	streams.PositionX = mPositionX.data();
+	streams.PositionY = mPositionY.data();
+	streams.ForwardX = mForwardX.data();
+	streams.ForwardY = mForwardY.data();
+	streams.SizeX = mSizeX.data();
+	streams.SizeY = mSizeY.data();
+
+	return streams;
+}
+
+void ParticleSystem::update(const float length, const float elapsed, const float width, const float height)
+{
+	update(0, blocks(), length, elapsed, width, height);
+}
+
+void ParticleSystem::update(
+	const size_t beginBlock,
+	const size_t endBlock,
+	const float length,
+	const float elapsed,
+	const float width,
+	const float height)
+{
+	CODE_RED_PROFILE_ZONE("ParticleSystem::update");
+
+	const auto begin = beginBlock * paddingCount;
+	const auto count = (endBlock - beginBlock) * paddingCount;
+
+	updateComponent(mPositionX.data() + begin, mPreviousX.data() + begin, mForwardX.data() + begin,
+		mSizeX.data() + begin, length, width, count);
+	updateComponent(mPositionY.data() + begin, mPreviousY.data() + begin, mForwardY.data() + begin,
+		mSizeY.data() + begin, length, height, count);
+
+	//the loop has no dependency, so the compiler vectorizes it
+	//the blocks are marked if they have expired particles, so killExpired() does not scan all particles on one thread
+	const auto life = mLife.data() + begin;
+
+	for (auto block = beginBlock; block < endBlock; block++) {
+		const auto blockLife = life + (block - beginBlock) * paddingCount;
+
+		bool expired = false;
+
+		for (size_t index = 0; index < paddingCount; index++) {
+			blockLife[index] = blockLife[index] - elapsed;
+
+			expired = expired | (blockLife[index] <= 0.0f);
+		}
+
+		mExpiredBlocks[block] = expired;
+	}
+}
+
+void ParticleSystem::hold()
+{
+	hold(0, blocks());
+}
+
+void ParticleSystem::hold(const size_t beginBlock, const size_t endBlock)
+{
+	const auto begin = beginBlock * paddingCount;
+	const auto end = endBlock * paddingCount;
+
+	std::copy(mPositionX.begin() + begin, mPositionX.begin() + end, mPreviousX.begin() + begin);
+	std::copy(mPositionY.begin() + begin, mPositionY.begin() + end, mPreviousY.begin() + begin);
+}
+
+void ParticleSystem::writeInstances(ParticleInstance* instances, const float factor) const
+{
+	writeInstances(instances, factor, 0, blocks());
+}
+
+void ParticleSystem::writeInstances(
+	ParticleInstance* instances,
+	const float factor,
+	const size_t beginBlock,
+	const size_t endBlock) const
+{
+	CODE_RED_PROFILE_ZONE("ParticleSystem::writeInstances");
+
+	static_assert(sizeof(ParticleInstance) == sizeof(float) * 4, "the instance should be four floats.");
+
+	const auto end = std::min(endBlock * paddingCount, mCount);
+
+	auto index = beginBlock * paddingCount;
+
+#ifdef __PARTICLE__SSE__
+	//interpolate four particles, then transpose the streams to four instances
+	const auto factors = _mm_set1_ps(factor);
+	const auto memory = reinterpret_cast<float*>(instances);
+
+	for (; index + 4 <= end; index += 4) {
+		const auto previousX = _mm_loadu_ps(mPreviousX.data() + index);
+		const auto previousY = _mm_loadu_ps(mPreviousY.data() + index);
+
+		auto x = _mm_add_ps(previousX, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mPositionX.data() + index), previousX), factors));
+		auto y = _mm_add_ps(previousY, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mPositionY.data() + index), previousY), factors));
+		auto sizeX = _mm_loadu_ps(mSizeX.data() + index);
+		auto sizeY = _mm_loadu_ps(mSizeY.data() + index);
+
+		_MM_TRANSPOSE4_PS(x, y, sizeX, sizeY);
+
+		_mm_storeu_ps(memory + index * 4 + 0, x);
+		_mm_storeu_ps(memory + index * 4 + 4, y);
+		_mm_storeu_ps(memory + index * 4 + 8, sizeX);
+		_mm_storeu_ps(memory + index * 4 + 12, sizeY);
+	}
+#endif
+
+	for (; index < end; index++) {
+		instances[index] = ParticleInstance(
+			glm::vec2(
+				mPreviousX[index] + (mPositionX[index] - mPreviousX[index]) * factor,
+				mPreviousY[index] + (mPositionY[index] - mPreviousY[index]) * factor),
+			glm::vec2(mSizeX[index], mSizeY[index]));
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <limits>
+
+struct Particle {
+	glm::vec2 Position = glm::vec2(0);
+	glm::vec2 Forward = glm::vec2(0);
+	glm::vec2 Size = glm::vec2(1);
+
+	Particle() = default;
+
+	Particle(
+		const glm::vec2 &position,
+		const glm::vec2 &forward,
+		const glm::vec2 &size) :
+		Position(position), Forward(forward), Size(size) {}
+};
+
+//the record of particle we upload for rendering, the vertex shader expands it
+struct ParticleInstance {
+	glm::vec2 Position = glm::vec2(0);
+	glm::vec2 Size = glm::vec2(1);
+
+	ParticleInstance() = default;
+
+	ParticleInstance(
+		const glm::vec2 &position,
+		const glm::vec2 &size) :
+		Position(position), Size(size) {}
+};
+
+//the streams of particles, the collision reads the states and moves the particles
+struct ParticleStreams {
+	float* PositionX = nullptr;
+	float* PositionY = nullptr;
+	float* ForwardX = nullptr;
+	float* ForwardY = nullptr;
+
+	const float* SizeX = nullptr;
+	const float* SizeY = nullptr;
+
+	ParticleStreams() = default;
+};
+
+/*
+ * the particles are stored as streams of components(structure of arrays)
+ * so the update loads the same component of laneCount particles with one instruction
+ * the streams are padded to the multiple of paddingCount, the kernel updates the slots after the live
+ * particles in the last block too(zero padding or the stale copies left by kill()), they are never drawn
+ * or collided, so the kernel does not need a scalar tail
+ * the particles are split into blocks of paddingCount particles, the update of a particle only reads itself
+ * so the blocks can be updated on different threads, the collisions between particles are resolved
+ * after the update by ParticleGrid
+ * the streams have fixed capacity and the live particles are [0, size()), spawn() appends a particle
+ * and kill() moves the last particle to the hole, so the live particles are always dense
+ */
+class ParticleSystem final {
+public:
+	explicit ParticleSystem(const size_t capacity);
+
+	//add a particle after the live particles, return false if the pool is full
+	//the particle with infinite life never dies
+	auto spawn(const Particle& particle, const float life = std::numeric_limits<float>::infinity()) -> bool;
+
+	//remove the particle, the last live particle is moved to its index
+	void kill(const size_t index);
+
+	//kill the particles whose life is over, it only checks the blocks that update() found expired particles in
+	void killExpired();
+
+	auto particle(const size_t index) const -> Particle;
+
+	//move the particles by forward * length, the particles bounce when they are out of [0, width] x [0, height]
+	//the life of particles is reduced by elapsed, the positions before the update are kept, so we can interpolate them
+	void update(
+		const float length,
+		const float elapsed,
+		const float width,
+		const float height);
+
+	//update the particles in blocks [beginBlock, endBlock)
+	void update(
+		const size_t beginBlock,
+		const size_t endBlock,
+		const float length,
+		const float elapsed,
+		const float width,
+		const float height);
+
+	//keep the particles still, the previous positions are the same as current positions
+	void hold();
+
+	void hold(const size_t beginBlock, const size_t endBlock);
+
+	//write the instances of interpolated particles, instances[index] is the instance of particle index
+	void writeInstances(ParticleInstance* instances, const float factor) const;
+
+	//write the instances of particles in blocks [beginBlock, endBlock), the padded particles are skipped
+	void writeInstances(
+		ParticleInstance* instances,
+		const float factor,
+		const size_t beginBlock,
+		const size_t endBlock) const;
+
+	auto streams() noexcept -> ParticleStreams;
+
+	auto size() const noexcept -> size_t { return mCount; }
+
+	auto capacity() const noexcept -> size_t { return mCapacity; }
+
+	//the blocks that have live particles
+	auto blocks() const noexcept -> size_t { return (mCount + paddingCount - 1) / paddingCount; }
+public:
+#if defined(__AVX__)
+	static constexpr size_t laneCount = 8;
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	static constexpr size_t laneCount = 4;
+#else
+	static constexpr size_t laneCount = 1;
+#endif
+	static constexpr size_t paddingCount = 16;
+private:
+	size_t mCapacity = 0;
+	size_t mCount = 0;
+
+	std::vector<float> mPositionX;
+	std::vector<float> mPositionY;
+	std::vector<float> mPreviousX;
+	std::vector<float> mPreviousY;
+	std::vector<float> mForwardX;
+	std::vector<float> mForwardY;
+	std::vector<float> mSizeX;
+	std::vector<float> mSizeY;
+
+	//the remaining seconds of particles
+	std::vector<float> mLife;
+
+	//the blocks that have expired particles after the last update, a block is only written by the job that updates it
+	//it is not std::vector<bool>, the bits of neighbor blocks are in the same byte and the jobs would write it together
+	std::vector<unsigned char> mExpiredBlocks;
+};
@@ -1,5 +1,7 @@
 #include "ParticleTextureGenerator.hpp"
 
+#include <Profiling/Profiler.hpp>
+
 ParticleTextureGenerator::ParticleTextureGenerator(
 	const std::shared_ptr<CodeRed::GpuLogicalDevice>& device,
 	const std::shared_ptr<CodeRed::GpuCommandAllocator>& allocator,
@@ -18,6 +20,8 @@ ParticleTextureGenerator::ParticleTextureGenerator(
 
 void ParticleTextureGenerator::run() const
 {
+	CODE_RED_PROFILE_ZONE("ParticleTextureGenerator::run");
+
 	//the color we used to clear the render target
 	//because we want to build a particle texture
 	//the pixel not in the circle is (0, 0, 0, 0)
@@ -4,7 +4,10 @@
 #include <Resources/FrameResources.hpp>
 #include <Pipelines/PipelineInfo.hpp>
 
+//directx 12 is only on windows, the other platforms use vulkan
+#ifdef _WIN32
 #define __DIRECTX12__MODE__
+#endif
 #define __VULKAN__MODE__
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -1,23 +1,40 @@
 #include "ParticlesDemoApp.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <cstring>
 #include <random>
 
-void Particle::reverseIfOut(glm::vec2& offset, const size_t width, const size_t height)
+//the keys of frame resources, the names are interned once when the program starts
+static const CodeRed::FrameResourceKey<CodeRed::GpuFrameBuffer> FrameBufferKey("FrameBuffer");
+static const CodeRed::FrameResourceKey<CodeRed::GpuDescriptorHeap> DescriptorHeapKey("DescriptorHeap");
+static const CodeRed::FrameResourceKey<CodeRed::GpuBuffer> InstanceKey("Instance");
+
+auto ParticlesDemoInfo::fromCommandLine(int argc, char** argv) -> ParticlesDemoInfo
 {
-	const auto target = Position + offset;
+	ParticlesDemoInfo info;
 
-	if (target.x - Size.x < 0 || target.x + Size.x > width) {
-		offset.x = -offset.x;
-		Forward.x = -Forward.x;
-	}
+	for (auto index = 1; index + 1 < argc; index++) {
+		if (std::strcmp(argv[index], "--particles") == 0)
+			info.Particles = static_cast<size_t>(std::stoull(argv[index + 1]));
+
+		if (std::strcmp(argv[index], "--threads") == 0)
+			info.Threads = static_cast<size_t>(std::stoull(argv[index + 1]));
 
-	if (target.y - Size.y < 0 || target.y + Size.y > height) {
-		offset.y = -offset.y;
-		Forward.y = -Forward.y;
+		if (std::strcmp(argv[index], "--emitters") == 0)
+			info.Emitters = static_cast<size_t>(std::stoull(argv[index + 1]));
+
+		if (std::strcmp(argv[index], "--emit-rate") == 0)
+			info.EmitRate = std::stof(argv[index + 1]);
+
+		if (std::strcmp(argv[index], "--collision") == 0) {
+			if (std::strcmp(argv[index + 1], "none") == 0) info.Collision = ParticleCollision::None;
+			if (std::strcmp(argv[index + 1], "brute-force") == 0) info.Collision = ParticleCollision::BruteForce;
+			if (std::strcmp(argv[index + 1], "grid") == 0) info.Collision = ParticleCollision::Grid;
+		}
 	}
 
-	Position = Position + offset;
+	return info;
 }
 
 ParticlesDemoUIComponent::ParticlesDemoUIComponent()
@@ -27,6 +44,8 @@ ParticlesDemoUIComponent::ParticlesDemoUIComponent()
 			ImGui::Text("DemoApp average %.3f ms/frame (%.1f FPS)",
 				1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 		
+			ImGui::Text("Particles %zu / %zu", LiveParticles, MaxParticles);
+
 			const auto* text = Pause == true ? "Continue" : "Pause";
 
 			if (ImGui::Button(text)) Pause ^= true;
@@ -34,15 +53,13 @@ ParticlesDemoUIComponent::ParticlesDemoUIComponent()
 
 	mParticlesView = std::make_shared<CodeRed::ImGuiView>([&]
 		{
-			if (Particles.has_value() == false) return;
-
 			ImGui::BeginChild("Particle Positions");
 
-			for (size_t index = 0; index < Particles.value()->size(); index++) {
-				const auto& particle = (*Particles.value())[index];
+			for (size_t index = 0; index < Instances.size(); index++) {
+				const auto& instance = Instances[index];
 
-				ImGui::Text("Particle %u : (%.3f, %.3f)", index,
-					particle.Position.x, particle.Position.y);
+				ImGui::Text("Particle %zu : (%.3f, %.3f)", index,
+					instance.Position.x, instance.Position.y);
 			}
 
 			ImGui::EndChild();
@@ -52,7 +69,8 @@ ParticlesDemoUIComponent::ParticlesDemoUIComponent()
 ParticlesDemoApp::ParticlesDemoApp(
 	const std::string& name,
 	const size_t width,
-	const size_t height) :
+	const size_t height,
+	const ParticlesDemoInfo& info) :
 #ifdef __DIRECTX12__MODE__
 	DemoApp(name + "[DirectX12]", width, height)
 #else
@@ -61,8 +79,16 @@ ParticlesDemoApp::ParticlesDemoApp(
 #else
 	DemoApp(name, width, height)
 #endif
-#endif	
+#endif
+	, mInfo(info)
 {
+	//the particles move with fixed time step, so they move the same on every machine
+	setFixedStep(Demo::FixedStepInfo(simulationStep, 4));
+
+#ifdef __PIPELINED__MODE__
+	setPipelined(true);
+#endif
+
 	initialize();
 }
 
@@ -73,74 +99,183 @@ ParticlesDemoApp::~ParticlesDemoApp()
 	mCommandQueue->waitIdle();
 }
 
-void ParticlesDemoApp::update(float delta)
+void ParticlesDemoApp::simulate(float step)
 {
 	const auto speed = 100.0f;
-	const auto length = speed * delta;
-	
-	for (size_t index = 0; index < mParticles.size(); index++) {
-		//if we pause the program state, we do not update the positions
-		if (mUIComponent->Pause) break;
-		
-		auto& particle = mParticles[index];
-		auto& transform = mTransform[index];
-		auto offset = particle.Forward * length;
+	const auto length = speed * step;
+	const auto width = static_cast<float>(this->width());
+	const auto height = static_cast<float>(this->height());
+
+	//if we pause the program state, we do not update the positions
+	const bool pause = mPause;
+
+#ifdef __PARALLEL__UPDATE__MODE__
+	//the particles do not interact, so the workers update their blocks without synchronization
+	mJobSystem->parallelFor(mParticleSystem->blocks(), minBlocksPerJob, [&](const CodeRed::JobRange& range)
+		{
+			if (pause) { mParticleSystem->hold(range.Begin, range.End); return; }
+
+			mParticleSystem->update(range.Begin, range.End, length, step, width, height);
+		});
+
+	if (pause) return;
+#else
+	if (pause) { mParticleSystem->hold(); return; }
+
+	mParticleSystem->update(length, step, width, height);
+#endif
+
+	//the pool is changed on this thread after the workers finish, the new particles start at the emitters
+	mParticleSystem->killExpired();
 
-		particle.reverseIfOut(offset, width(), height());
+	for (auto& emitter : mEmitters) emitter.emit(*mParticleSystem, step);
 
-		transform = glm::translate(glm::mat4x4(1), glm::vec3(offset, 0.0f)) * transform;
+	collideParticles();
+}
+
+void ParticlesDemoApp::collideParticles()
+{
+	if (mInfo.Collision == ParticleCollision::None) return;
+
+	const auto streams = mParticleSystem->streams();
+
+	//the grid is a sorted copy of the particles, the collision reads it and writes the particles
+	//every particle only writes itself, so the cells are resolved in parallel without synchronization
+	//the jobs are split by the sorted particles, so the crowded rows do not make a job slower than others
+#ifdef __PARALLEL__UPDATE__MODE__
+	mParticleGrid->build(streams, mParticleSystem->size(), *mJobSystem, minParticlesPerJob);
+
+	mJobSystem->parallelFor(mParticleGrid->size(), minParticlesPerJob, [&](const CodeRed::JobRange& range)
+		{
+			if (mInfo.Collision == ParticleCollision::BruteForce) {
+				mParticleGrid->collideBruteForce(streams, range.Begin, range.End); return;
+			}
+
+			mParticleGrid->collide(streams, range.Begin, range.End);
+		});
+#else
+	mParticleGrid->build(streams, mParticleSystem->size());
+
+	if (mInfo.Collision == ParticleCollision::BruteForce) {
+		mParticleGrid->collideBruteForce(streams, 0, mParticleGrid->size()); return;
 	}
 
-	const auto buffer = mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuBuffer>("Transform");
+	mParticleGrid->collide(streams, 0, mParticleGrid->size());
+#endif
+}
+
+#ifdef __PIPELINED__MODE__
+void ParticlesDemoApp::publish(size_t slot)
+{
+	auto& published = mFrameSlots[slot];
+
+	writeInstances(published.Instances.data());
+
+	published.Count = mParticleSystem->size();
+}
+#endif
+
+void ParticlesDemoApp::waitFrame()
+{
+	//wait for the frame that used this slot, so we can write the frame resources of it
+	mCurrentFrameIndex = mFramePacer->beginFrame();
+}
+
+void ParticlesDemoApp::update(float delta)
+{
+	const auto buffer = mFrameResources[mCurrentFrameIndex].get(InstanceKey);
+	const auto memory = static_cast<ParticleInstance*>(buffer->mapMemory());
+
+#ifdef __PIPELINED__MODE__
+	//the ui shows the particles of this frame, the simulation may be writing the next frame
+	const auto& published = mFrameSlots[frameSlot()];
+
+	mInstanceCount = published.Count;
+
+	//the capacity of ui instances is reserved, so the resize does not allocate memory
+	mUIComponent->Instances.resize(std::min(maxListedParticles, mInstanceCount));
+
+	std::memcpy(memory, published.Instances.data(), mInstanceCount * sizeof(ParticleInstance));
+	std::copy(published.Instances.begin(), published.Instances.begin() + mUIComponent->Instances.size(),
+		mUIComponent->Instances.begin());
+#else
+	//the simulation runs on this thread, so we write the instances into the mapped buffer directly
+	//the buffer is upload memory, so we write the instances of ui again instead of reading the buffer
+	mInstanceCount = mParticleSystem->size();
+
+	//the capacity of ui instances is reserved, so the resize does not allocate memory
+	mUIComponent->Instances.resize(std::min(maxListedParticles, mInstanceCount));
+
+	writeInstances(memory);
+
+	mParticleSystem->writeInstances(mUIComponent->Instances.data(), interpolationFactor(),
+		0, maxListedParticles / ParticleSystem::paddingCount);
+#endif
 
-	const auto memory = buffer->mapMemory();
-	std::memcpy(memory, mTransform.data(), buffer->size());
 	buffer->unmapMemory();
 
+	mUIComponent->LiveParticles = mInstanceCount;
+
 	mImGuiWindows->update();
+
+	mPause = mUIComponent->Pause;
 }
 
+void ParticlesDemoApp::writeInstances(ParticleInstance* instances) const
+{
+	const auto factor = interpolationFactor();
+
+#ifdef __PARALLEL__UPDATE__MODE__
+	//every worker writes the instances of its blocks, the slices do not overlap
+	mJobSystem->parallelFor(mParticleSystem->blocks(), minBlocksPerJob, [&](const CodeRed::JobRange& range)
+		{
+			mParticleSystem->writeInstances(instances, factor, range.Begin, range.End);
+		});
+#else
+	mParticleSystem->writeInstances(instances, factor);
+#endif
+}
 
 void ParticlesDemoApp::render(float delta)
 {
 	const auto frameBuffer = 
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuFrameBuffer>("FrameBuffer");
+		mFrameResources[mCurrentFrameIndex].get(FrameBufferKey);
 	const auto descriptorHeap =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuDescriptorHeap>("DescriptorHeap");
+		mFrameResources[mCurrentFrameIndex].get(DescriptorHeapKey);
 
-	mCommandQueue->waitIdle();
-	mCommandAllocator->reset();
+	auto commandList = mFramePacer->commandList();
 	
-	mCommandList->beginRecording();
+	commandList->beginRecording();
 
-	mCommandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
-	mCommandList->setResourceLayout(mPipelineInfo->resourceLayout());
+	commandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
+	commandList->setResourceLayout(mPipelineInfo->resourceLayout());
 
-	mCommandList->setViewPort(frameBuffer->fullViewPort());
-	mCommandList->setScissorRect(frameBuffer->fullScissorRect());
+	commandList->setViewPort(frameBuffer->fullViewPort());
+	commandList->setScissorRect(frameBuffer->fullScissorRect());
 
-	mCommandList->setVertexBuffer(mVertexBuffer);
-	mCommandList->setIndexBuffer(mIndexBuffer);
+	commandList->setVertexBuffer(mVertexBuffer);
+	commandList->setIndexBuffer(mIndexBuffer);
 
-	mCommandList->setDescriptorHeap(descriptorHeap);
+	commandList->setDescriptorHeap(descriptorHeap);
 	
-	mCommandList->beginRenderPass(
+	commandList->beginRenderPass(
 		mPipelineInfo->renderPass(),
 		frameBuffer);
 	
-	mCommandList->drawIndexed(6, particleCount);
+	//we only draw the live particles, the pool is dense so they are the first instances
+	commandList->drawIndexed(6, mInstanceCount);
 
-	mImGuiWindows->draw(mCommandList);
+	mImGuiWindows->draw(commandList);
 	
-	mCommandList->endRenderPass();
+	commandList->endRenderPass();
 		
-	mCommandList->endRecording();
+	commandList->endRecording();
 
-	mCommandQueue->execute({ mCommandList });
+	mCommandQueue->execute(mFramePacer->commandLists());
 
-	mSwapChain->present();
+	mPresentTargets->present();
 
-	mCurrentFrameIndex = (mCurrentFrameIndex + 1) % maxFrameResources;
+	mFramePacer->endFrame();
 }
 
 void ParticlesDemoApp::initialize()
@@ -162,6 +297,13 @@ void ParticlesDemoApp::initialize()
 		std::make_shared<CodeRed::VulkanLogicalDevice>(adapters[0])
 		);
 #endif
+#endif
+
+	//the pipeline cache is only valid for the adapter we created the device on
+	loadPipelineCache(adapters[0], mDevice);
+
+#ifdef __PARALLEL__UPDATE__MODE__
+	mJobSystem = std::make_shared<CodeRed::JobSystem>(mInfo.Threads);
 #endif
 	
 	initializeParticles();
@@ -186,24 +328,64 @@ void ParticlesDemoApp::initializeParticles()
 	const std::uniform_real_distribution<float> forwardRange(-1.0f, 1.0f);
 	const std::uniform_real_distribution<float> sizeRange(10.0f, static_cast<float>(maxParticleSize));
 
-	for (size_t index = 0; index < mParticles.size(); index++) {
-		auto& particle = mParticles[index];
-		auto& transform = mTransform[index];
-		
-		particle.Position = glm::vec2(xRange(random), yRange(random));
-		particle.Forward = glm::normalize(glm::vec2(forwardRange(random), forwardRange(random)));
-		particle.Size = glm::vec2(sizeRange(random));
+	//the emitters are placed on the horizontal center line
+	for (size_t index = 0; index < mInfo.Emitters; index++) {
+		const auto x = static_cast<float>(width()) * static_cast<float>(index + 1) / static_cast<float>(mInfo.Emitters + 1);
+		const auto y = static_cast<float>(height()) * 0.5f;
 
-		transform = glm::translate(glm::mat4x4(1), glm::vec3(particle.Position, 0.0f));
-		transform = glm::scale(transform, glm::vec3(particle.Size, 1.0f));
+		mEmitters.push_back(ParticleEmitter(glm::vec2(x, y), mInfo.EmitRate, mInfo.EmitLife,
+			static_cast<float>(maxEmittedSize), static_cast<unsigned>(index)));
 	}
+
+	//the pool holds all particles, so we never allocate memory when we spawn particles
+	auto capacity = mInfo.Particles;
+
+	for (const auto& emitter : mEmitters) capacity = capacity + emitter.capacity(simulationStep);
+
+	mParticleSystem = std::make_shared<ParticleSystem>(capacity);
+
+	//the size of particles is the diameter, so the particles in collision are in the neighbor cells
+	//the emitted particles are not larger than the initial particles, so maxParticleSize is the cell size of all particles
+	CODE_RED_DEBUG_THROW_IF(
+		maxEmittedSize > maxParticleSize,
+		CodeRed::InvalidException<size_t>({ "maxEmittedSize" })
+	);
+
+	mParticleGrid = std::make_shared<ParticleGrid>(
+		static_cast<float>(maxParticleSize),
+		static_cast<float>(width()),
+		static_cast<float>(height()),
+		capacity);
+
+	for (size_t index = 0; index < mInfo.Particles; index++) {
+		const auto position = glm::vec2(xRange(random), yRange(random));
+		const auto forward = glm::normalize(glm::vec2(forwardRange(random), forwardRange(random)));
+		const auto size = glm::vec2(sizeRange(random));
+
+		mParticleSystem->spawn(Particle(position, forward, size));
+	}
+
+#ifdef __PIPELINED__MODE__
+	for (auto& published : mFrameSlots) {
+		published.Instances.resize(mParticleSystem->capacity());
+		published.Count = mParticleSystem->size();
+
+		mParticleSystem->writeInstances(published.Instances.data(), 1.0f);
+	}
+#endif
 }
 
 void ParticlesDemoApp::initializeCommands()
 {
 	mCommandAllocator = mDevice->createCommandAllocator();
 	mCommandQueue = mDevice->createCommandQueue();
-	mCommandList = mDevice->createGraphicsCommandList(mCommandAllocator);
+
+	//every frame in flight has its own command allocator and command list
+	//we only wait for the frame that used the same slot before
+	mFramePacer = std::make_shared<CodeRed::FramePacer>(
+		mDevice,
+		std::make_shared<CodeRed::QueueFrameFence>(mDevice, mCommandQueue),
+		maxFrameResources);
 }
 
 void ParticlesDemoApp::initializeBuffers()
@@ -234,13 +416,13 @@ void ParticlesDemoApp::initializeBuffers()
 	for (auto& frameResource : mFrameResources) {
 		auto buffer = mDevice->createBuffer(
 			CodeRed::ResourceInfo::GroupBuffer(
-				sizeof(glm::mat4x4),
-				particleCount
+				sizeof(ParticleInstance),
+				mParticleSystem->capacity()
 			)
 		);
 		
 		frameResource.set(
-			"Transform",
+			InstanceKey,
 			buffer
 		);
 	}
@@ -299,18 +481,26 @@ void ParticlesDemoApp::initializeSwapChain()
 	//create the swap chain
 	//if we want to write the back buffer(to window)
 	//we need use the queue that create the swap chain to submit the draw commands
-	mSwapChain = mDevice->createSwapChain(
-		mCommandQueue,
-		{ width(), height(), handle() },
-		CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
-		maxFrameResources
-	);
+	//in headless mode, there is no window, so we render to offscreen textures
+	mPresentTargets = isHeadless() ?
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice,
+			width(), height(),
+			CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+			maxFrameResources) :
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice->createSwapChain(
+				mCommandQueue,
+				{ width(), height(), handle() },
+				CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+				maxFrameResources
+			));
 
 	for (size_t index = 0; index < maxFrameResources; index++) {
 		mFrameResources[index].set(
-			"FrameBuffer",
+			FrameBufferKey,
 			mDevice->createFrameBuffer(
-				{ mSwapChain->buffer(index)->reference() },
+				{ mPresentTargets->buffer(index)->reference() },
 				nullptr
 			)
 		);
@@ -411,7 +601,7 @@ void ParticlesDemoApp::initializePipeline()
 
 	mPipelineInfo->setRenderPass(
 		mDevice->createRenderPass(
-			{ CodeRed::Attachment::RenderTarget(mSwapChain->format()) }
+			{ CodeRed::Attachment::RenderTarget(mPresentTargets->format()) }
 		)
 	);
 	
@@ -421,7 +611,8 @@ void ParticlesDemoApp::initializePipeline()
 void ParticlesDemoApp::initializeImGuiWindows()
 {
 	mUIComponent = std::make_shared<ParticlesDemoUIComponent>();
-	mUIComponent->Particles = &mParticles;
+	mUIComponent->Instances.reserve(maxListedParticles);
+	mUIComponent->MaxParticles = mParticleSystem->capacity();
 	mUIComponent->Pause = false;
 
 	//for high dpi display device, you need change the scale.
@@ -436,6 +627,7 @@ void ParticlesDemoApp::initializeImGuiWindows()
 
 	//add the ui component to windows
 	mImGuiWindows->add("Tool", "Program State", mUIComponent->programStateView());
+	mImGuiWindows->add("Tool", "Profiler", CodeRed::ProfilerView::create());
 	mImGuiWindows->add("Tool", "Particles", mUIComponent->particlesView());
 }
 
@@ -446,14 +638,14 @@ void ParticlesDemoApp::initializeDescriptorHeaps()
 			mPipelineInfo->resourceLayout()
 		);
 
-		auto buffer = frameResource.get<CodeRed::GpuBuffer>("Transform");
+		auto buffer = frameResource.get(InstanceKey);
 
 		descriptorHeap->bindBuffer(mViewBuffer, 0);
 		descriptorHeap->bindBuffer(buffer, 1);
 		descriptorHeap->bindTexture(mParticleTextureGenerator->texture(), 2);
 
 		frameResource.set(
-			"DescriptorHeap",
+			DescriptorHeapKey,
 			descriptorHeap
 		);
 	}
@@ -1,32 +1,63 @@
 #pragma once
 #include "ParticleTextureGenerator.hpp"
+#include "ParticleEmitter.hpp"
+#include "ParticleSystem.hpp"
+#include "ParticleGrid.hpp"
 
 #include <Resources/ResourceHelper.hpp>
+#include <Resources/FramePacer.hpp>
+#include <Resources/PresentTargets.hpp>
+#include <Threads/JobSystem.hpp>
 #include <DemoApp.hpp>
 
 #include <Extensions/ImGui/ImGuiWindows.hpp>
+#include <Profiling/ProfilerView.hpp>
 
-struct Particle {
-	glm::vec2 Position = glm::vec2(0);
-	glm::vec2 Forward = glm::vec2(0);
-	glm::vec2 Size = glm::vec2(1);
+#include <atomic>
 
-	Particle() = default;
+//simulate the particles of next frame on another thread while we render current frame
+//the instances are written to the frame slot and copied to the buffer, so it is disabled
+//without it, the instances are written into the mapped buffer directly
+//#define __PIPELINED__MODE__
 
-	Particle(
-		const glm::vec2 &position,
-		const glm::vec2 &forward,
-		const glm::vec2 &size) :
-		Position(position), Forward(forward), Size(size) {}
+//update the particles and write the instances on the threads of job system
+#define __PARALLEL__UPDATE__MODE__
 
-	void reverseIfOut(
-		glm::vec2& offset,
-		const size_t width,
-		const size_t height);
+enum class ParticleCollision : unsigned {
+	None = 0,
+	BruteForce = 1,
+	Grid = 2
+};
+
+struct ParticlesDemoInfo {
+	//the particles that never die
+	size_t Particles = 2000;
+
+	//the emitters spawn EmitRate particles per second, the particles live for EmitLife seconds
+	size_t Emitters = 4;
+
+	float EmitRate = 1000.0f;
+	float EmitLife = 4.0f;
+
+	//the brute force tests all pairs of particles, it is only used to benchmark the grid
+	ParticleCollision Collision = ParticleCollision::Grid;
+
+	//the worker threads of job system, the thread that dispatches the jobs works too
+	size_t Threads = CodeRed::JobSystem::defaultThreads();
+
+	ParticlesDemoInfo() = default;
+
+	//[--particles count] [--threads count] [--emitters count] [--emit-rate particles]
+	//[--collision none|brute-force|grid]
+	static auto fromCommandLine(int argc, char** argv) -> ParticlesDemoInfo;
 };
 
 struct ParticlesDemoUIComponent {
-	std::optional<std::vector<Particle>*> Particles;
+	//the instances of the first particles, we do not list all particles
+	std::vector<ParticleInstance> Instances;
+
+	size_t LiveParticles = 0;
+	size_t MaxParticles = 0;
 	
 	bool Pause = false;
 
@@ -40,20 +71,43 @@ private:
 	std::shared_ptr<CodeRed::ImGuiView> mParticlesView;
 };
 
+#ifdef __PIPELINED__MODE__
+//the state that the simulation publishes for update and render
+struct ParticlesFrameSlot {
+	std::vector<ParticleInstance> Instances;
+
+	//the live particles when the slot is published
+	size_t Count = 0;
+
+	ParticlesFrameSlot() = default;
+};
+#endif
+
 class ParticlesDemoApp final : public Demo::DemoApp {
 public:
 	ParticlesDemoApp(
 		const std::string& name,
 		const size_t width,
-		const size_t height);
+		const size_t height,
+		const ParticlesDemoInfo& info = ParticlesDemoInfo());
 
 	~ParticlesDemoApp();
 private:
+	void simulate(float step) override;
+#ifdef __PIPELINED__MODE__
+	void publish(size_t slot) override;
+#endif
+	void waitFrame() override;
 	void update(float delta) override;
 	void render(float delta) override;
 	void initialize();
+
+	//write the interpolated instances, the workers write the slices of their blocks
+	void writeInstances(ParticleInstance* instances) const;
 	
 	void initializeParticles();
+
+	void collideParticles();
 	
 	void initializeCommands();
 
@@ -75,17 +129,30 @@ private:
 private:
 	const size_t maxFrameResources = 2;
 	const size_t maxParticleSize = 20;
-	const size_t particleCount = 2000;
+	const size_t maxEmittedSize = 10;
+	const size_t maxListedParticles = 128;
+	const float simulationStep = 1.0f / 60.0f;
+	const size_t minBlocksPerJob = 64;
+	const size_t minParticlesPerJob = 4096;
+
+	ParticlesDemoInfo mInfo;
 	
 	size_t mCurrentFrameIndex = 0;
 	
 	std::shared_ptr<CodeRed::GpuLogicalDevice> mDevice;
-	std::shared_ptr<CodeRed::GpuSwapChain> mSwapChain;
+	std::shared_ptr<CodeRed::PresentTargets> mPresentTargets;
 
+	//the command allocator is only used to upload resources when we initialize
+	//the frames use the command allocators and command lists of frame pacer
 	std::shared_ptr<CodeRed::GpuCommandAllocator> mCommandAllocator;
-	std::shared_ptr<CodeRed::GpuGraphicsCommandList> mCommandList;
 	std::shared_ptr<CodeRed::GpuCommandQueue> mCommandQueue;
 
+	std::shared_ptr<CodeRed::FramePacer> mFramePacer;
+
+#ifdef __PARALLEL__UPDATE__MODE__
+	std::shared_ptr<CodeRed::JobSystem> mJobSystem;
+#endif
+
 	std::vector<CodeRed::FrameResources> mFrameResources = 
 		std::vector<CodeRed::FrameResources>(maxFrameResources);
 
@@ -106,6 +173,20 @@ private:
 	std::vector<CodeRed::Byte> mVertexShaderCode;
 	std::vector<CodeRed::Byte> mPixelShaderCode;
 
-	std::vector<Particle> mParticles = std::vector<Particle>(particleCount);
-	std::vector<glm::mat4x4> mTransform = std::vector<glm::mat4x4>(particleCount);
+	//the simulation state, we render the interpolation of the positions before and after the last step
+	std::shared_ptr<ParticleSystem> mParticleSystem;
+
+	std::vector<ParticleEmitter> mEmitters;
+
+	std::shared_ptr<ParticleGrid> mParticleGrid;
+
+	//the instances in the buffer of current frame, the pool may be changed after we write them
+	size_t mInstanceCount = 0;
+
+#ifdef __PIPELINED__MODE__
+	std::vector<ParticlesFrameSlot> mFrameSlots = std::vector<ParticlesFrameSlot>(maxFrameSlots);
+#endif
+
+	//the pause state of ui, it is written by update and read by simulate
+	std::atomic<bool> mPause = false;
 };
@@ -0,0 +1,64 @@
+import os
+import subprocess
+import sys
+
+# benchmark the particles with 0 to (cores - 1) worker threads and print the speedup of simulate and update
+# simulate moves the particles and update writes the instances, both of them are split across the workers
+# the thread that dispatches jobs is a worker too, so "--threads 0" is one core
+# usage: py ParticlesScaling.py [particles] [Configuration] [Platform], the default is 1000000 Release x64
+# extra arguments after them are passed to the demo, for example "--collision none"
+
+particles = sys.argv[1] if len(sys.argv) > 1 else "1000000"
+configuration = sys.argv[2] if len(sys.argv) > 2 else "Release"
+platform = sys.argv[3] if len(sys.argv) > 3 else "x64"
+extraArguments = sys.argv[4:]
+
+frames = "600"
+
+demoDir = os.path.dirname(os.path.abspath(__file__))
+binDir = os.path.join(demoDir, "Bin", platform, configuration)
+executable = os.path.join(binDir, "ParticlesDemo" + (".exe" if os.name == "nt" else ""))
+
+if not os.path.isfile(executable):
+    print(executable + " is not built")
+    sys.exit(1)
+
+def ReadReport(fileName):
+    metrics = {}
+
+    with open(fileName, "r") as reportFile:
+        for line in reportFile.readlines()[1:]:
+            name, value = line.strip().split(",", 1)
+            metrics[name] = value
+        pass
+
+    return metrics
+
+cores = os.cpu_count() or 1
+
+print("particles " + particles + ", " + str(cores) + " cores")
+print("workers, simulate.p50(ms), update.p50(ms), frame.p50(ms), speedup")
+
+baseline = None
+
+for threads in range(0, cores):
+    reportName = os.path.join(binDir, "ParticlesScaling" + str(threads) + ".csv")
+
+    result = subprocess.run(
+        [executable, "--benchmark", reportName, "--frames", frames,
+         "--particles", particles, "--threads", str(threads)] + extraArguments,
+        cwd = binDir, stdout = subprocess.PIPE, stderr = subprocess.STDOUT, universal_newlines = True)
+
+    if result.returncode != 0:
+        print(result.stdout)
+        sys.exit(1)
+
+    metrics = ReadReport(reportName)
+
+    time = float(metrics["simulate.p50"]) + float(metrics["update.p50"])
+
+    if baseline is None: baseline = time
+
+    print(str(threads + 1) + ", " + metrics["simulate.p50"] + ", " + metrics["update.p50"] + ", " +
+          metrics["frame.p50"] + ", " + "{:.2f}".format(baseline / time if time > 0 else 0))
+pass
@@ -1,8 +1,9 @@
 #pragma pack_matrix(row_major)
 
-struct Transform
+struct Instance
 {
-    matrix world;
+    float2 position;
+    float2 size;
 };
 
 struct Output
@@ -18,7 +19,7 @@ struct View
 };
 
 ConstantBuffer<View> view : register(b0);
-StructuredBuffer<Transform> transforms : register(t1);
+StructuredBuffer<Instance> instances : register(t1);
 
 Output main(
     float2 position : POSITION,
@@ -27,7 +28,9 @@ Output main(
 {
     Output res;
 
-    res.position = mul(float4(position, 0.0f, 1.0f), transforms[identity].world);
+    Instance instance = instances[identity];
+
+    res.position = float4(position * instance.size + instance.position, 0.0f, 1.0f);
     res.position = mul(res.position, view.view);
     res.texcoord = texcoord;
     res.identity = identity;
@@ -6,10 +6,16 @@ layout (set = 0, binding = 0) uniform View
     mat4 view;
 } view;
 
-layout (set = 0, binding = 1) buffer Transform
+struct Instance
 {
-    mat4 world[];
-} transforms;
+    vec2 position;
+    vec2 size;
+};
+
+layout (set = 0, binding = 1) buffer Instances
+{
+    Instance instance[];
+} instances;
 
 layout (location = 0) in vec4 position;
 layout (location = 1) in vec2 texcoord;
@@ -18,7 +24,9 @@ layout (location = 0) out vec2 outTexcoord;
 
 void main()
 {
-    gl_Position = position * transpose(transforms.world[gl_InstanceIndex]);
+    Instance instance = instances.instance[gl_InstanceIndex];
+
+    gl_Position = vec4(position.xy * instance.size + instance.position, 0.0f, 1.0f);
     gl_Position = gl_Position * transpose(view.view);
 
     outTexcoord = texcoord;
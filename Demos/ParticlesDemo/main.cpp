@@ -1,8 +1,19 @@
 #include "ParticlesDemoApp.hpp"
 
-int main() {
-	auto app = ParticlesDemoApp("ParticlesDemoApp", 1280, 720);
+int main(int argc, char** argv) {
+	//run without window with "--headless [--frames count] [--timestep seconds] [--trace fileName]"
+	//benchmark with "--benchmark fileName [--baseline fileName] [--tolerance value]", it fails if it regresses
+	//check the steady state with "--max-allocations 0 [--warmup frames]", it fails if a frame allocates
+	//scale the simulation with "[--particles count] [--threads count]", benchmark with different threads to see the scaling
+	//ParticlesScaling.py runs the benchmark from one core to all cores and prints the speedup
+	//change the emitters with "[--emitters count] [--emit-rate particles]", the rate is the particles per second of one emitter
+	//compare the collision with "--collision brute-force" and "--collision grid" in benchmark, "--collision none" disables it
+	Demo::DemoApp::setHeadless(Demo::HeadlessInfo::fromCommandLine(argc, argv));
+
+	auto app = ParticlesDemoApp("ParticlesDemoApp", 1280, 720, ParticlesDemoInfo::fromCommandLine(argc, argv));
 	
 	app.show();
 	app.runLoop();
+
+	return app.exitCode();
 }
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "TriangleDemoApp.hpp"
 
+//the keys of frame resources, the names are interned once when the program starts
+static const CodeRed::FrameResourceKey<CodeRed::GpuFrameBuffer> FrameBufferKey("FrameBuffer");
+static const CodeRed::FrameResourceKey<CodeRed::GpuDescriptorHeap> DescriptorHeapKey("DescriptorHeap");
+static const CodeRed::FrameResourceKey<CodeRed::GpuBuffer> VertexBufferKey("VertexBuffer");
+
 TriangleDemoUIComponent::TriangleDemoUIComponent()
 {
 	mProgramStateView = std::make_shared<CodeRed::ImGuiView>([&]
@@ -51,86 +56,160 @@ TriangleDemoApp::~TriangleDemoApp()
 	mCommandQueue->waitIdle();
 }
 
+void TriangleDemoApp::waitFrame()
+{
+	//wait for the frame that used this slot, so we can write the frame resources of it
+	mCurrentFrameIndex = mFramePacer->beginFrame();
+}
+
 void TriangleDemoApp::update(float delta)
 {
 	mImGuiWindows->update();
 
 	CodeRed::ResourceHelper::updateBuffer(
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuBuffer>("VertexBuffer"),
+		mFrameResources[mCurrentFrameIndex].get(VertexBufferKey),
 		mUIComponent->TrianglePositions, 
 		sizeof(mUIComponent->TrianglePositions));	
 }
 
 void TriangleDemoApp::render(float delta)
 {
-	const auto frameBuffer =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuFrameBuffer>("FrameBuffer");
-	const auto descriptorHeap =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuDescriptorHeap>("DescriptorHeap");
-	const auto vertexBuffer =
-		mFrameResources[mCurrentFrameIndex].get<CodeRed::GpuBuffer>("VertexBuffer");
+	auto commandList = mFramePacer->commandList();
 
-	mCommandQueue->waitIdle();
-	mCommandAllocator->reset();
+	//the msaa pipeline is created asynchronously, before it is ready we render without msaa
+	mMSAAPipelineInfo->updatePendingState();
 
-	mCommandList->beginRecording();
+	const auto enableMSAA = mUIComponent->EnableMSAA && mMSAAPipelineInfo->graphicsPipeline() != nullptr;
 
-	if (mUIComponent->EnableMSAA) {
-		mCommandList->setGraphicsPipeline(mMSAAPipelineInfo->graphicsPipeline());
-		mCommandList->setResourceLayout(mMSAAPipelineInfo->resourceLayout());
+	//the passes only change when we switch msaa, so we build the graph again only in that case
+	if (mRenderGraphMSAA != enableMSAA) buildRenderGraph(enableMSAA);
 
-		mCommandList->setViewPort(mMSAAFrameBuffer->fullViewPort());
-		mCommandList->setScissorRect(mMSAAFrameBuffer->fullScissorRect());
-	}
-	else {
-		mCommandList->setGraphicsPipeline(mPipelineInfo->graphicsPipeline());
-		mCommandList->setResourceLayout(mPipelineInfo->resourceLayout());
+	mRenderGraph->setImportedTexture(mBackBuffer, mPresentTargets->buffer(mCurrentFrameIndex));
 
-		mCommandList->setViewPort(frameBuffer->fullViewPort());
-		mCommandList->setScissorRect(frameBuffer->fullScissorRect());
-	}
+	commandList->beginRecording();
 
-	mCommandList->setVertexBuffer(vertexBuffer);
+	mRenderGraph->execute(commandList);
 
-	mCommandList->setDescriptorHeap(descriptorHeap);
+	commandList->endRecording();
 
-	mCommandList->beginRenderPass(
-		mUIComponent->EnableMSAA ? mMSAAPipelineInfo->renderPass() : mPipelineInfo->renderPass(),
-		mUIComponent->EnableMSAA ? mMSAAFrameBuffer : frameBuffer);
+	mCommandQueue->execute(mFramePacer->commandLists());
 
-	mCommandList->setConstant32Bits({
-		mUIComponent->Color.r,
-		mUIComponent->Color.g,
-		mUIComponent->Color.b,
-		mUIComponent->Color.a
-		});
+	mPresentTargets->present();
 
-	mCommandList->draw(3);
+	mFramePacer->endFrame();
+}
 
-	if (!mUIComponent->EnableMSAA) mImGuiWindows->draw(mCommandList);
-	
-	mCommandList->endRenderPass();
+void TriangleDemoApp::drawTriangle(
+	const std::shared_ptr<CodeRed::GpuGraphicsCommandList>& commandList,
+	const std::shared_ptr<CodeRed::PipelineInfo>& pipelineInfo,
+	const std::shared_ptr<CodeRed::GpuFrameBuffer>& frameBuffer,
+	const bool drawUI)
+{
+	const auto descriptorHeap =
+		mFrameResources[mCurrentFrameIndex].get(DescriptorHeapKey);
+	const auto vertexBuffer =
+		mFrameResources[mCurrentFrameIndex].get(VertexBufferKey);
 
-	if (mUIComponent->EnableMSAA) {
-		mCommandList->resolveTexture(
-			CodeRed::TextureResolveInfo(mMSAABuffer, 0),
-			CodeRed::TextureResolveInfo(mSwapChain->buffer(mCurrentFrameIndex), 0)
-		);
-		
-		mCommandList->beginRenderPass(mMSAAUIRenderPass, frameBuffer);
+	commandList->setGraphicsPipeline(pipelineInfo->graphicsPipeline());
+	commandList->setResourceLayout(pipelineInfo->resourceLayout());
 
-		mImGuiWindows->draw(mCommandList);
+	commandList->setViewPort(frameBuffer->fullViewPort());
+	commandList->setScissorRect(frameBuffer->fullScissorRect());
 
-		mCommandList->endRenderPass();
-	}
+	commandList->setVertexBuffer(vertexBuffer);
+
+	commandList->setDescriptorHeap(descriptorHeap);
+
+	commandList->beginRenderPass(pipelineInfo->renderPass(), frameBuffer);
 
-	mCommandList->endRecording();
+	//the vector keeps its capacity, so we do not allocate it in every frame
+	mColorConstants.clear();
+	mColorConstants.push_back(mUIComponent->Color.r);
+	mColorConstants.push_back(mUIComponent->Color.g);
+	mColorConstants.push_back(mUIComponent->Color.b);
+	mColorConstants.push_back(mUIComponent->Color.a);
 
-	mCommandQueue->execute({ mCommandList });
+	commandList->setConstant32Bits(mColorConstants);
 
-	mSwapChain->present();
+	commandList->draw(3);
 
-	mCurrentFrameIndex = (mCurrentFrameIndex + 1) % maxFrameResources;
+	if (drawUI) mImGuiWindows->draw(commandList);
+
+	commandList->endRenderPass();
+}
+
+void TriangleDemoApp::buildRenderGraph(const bool enableMSAA)
+{
+	//the passes read the resources of current frame when they are executed
+	//so the graph does not keep the resources of a frame
+	mRenderGraph->reset();
+	mRenderGraphMSAA = enableMSAA;
+
+	mBackBuffer = mRenderGraph->importTexture(
+		"BackBuffer",
+		mPresentTargets->buffer(0),
+		CodeRed::ResourceLayout::Present,
+		CodeRed::ResourceLayout::Present);
+
+	const auto backBuffer = mBackBuffer;
+
+	if (enableMSAA) {
+		const auto msaaBuffer = mRenderGraph->createTexture(
+			"MSAABuffer",
+			CodeRed::RenderGraphTextureInfo(
+				mPresentTargets->width(), mPresentTargets->height(),
+				mPresentTargets->format(),
+				CodeRed::MultiSample::Count4,
+				CodeRed::ClearValue(1, 1, 1, 1)));
+
+		mRenderGraph->addPass("Scene",
+			{ CodeRed::RenderGraphAccess::write(msaaBuffer, CodeRed::ResourceLayout::RenderTarget, CodeRed::ResourceLayout::GeneralRead) },
+			[this, msaaBuffer](const auto& list, const CodeRed::RenderGraphTextures& textures)
+			{
+				//the frame buffer is created again only when the graph gives us a new texture
+				if (mMSAABuffer != textures.texture(msaaBuffer)) {
+					mMSAABuffer = textures.texture(msaaBuffer);
+					mMSAAFrameBuffer = mDevice->createFrameBuffer({ mMSAABuffer->reference() });
+				}
+
+				drawTriangle(list, mMSAAPipelineInfo, mMSAAFrameBuffer, false);
+			});
+
+		//resolve texture transitions the textures itself and restores their layouts
+		mRenderGraph->addPass("Resolve",
+			{
+				CodeRed::RenderGraphAccess::read(msaaBuffer, CodeRed::ResourceLayout::GeneralRead),
+				CodeRed::RenderGraphAccess::write(backBuffer, CodeRed::ResourceLayout::Present, CodeRed::ResourceLayout::Present)
+			},
+			[msaaBuffer, backBuffer](const auto& list, const CodeRed::RenderGraphTextures& textures)
+			{
+				list->resolveTexture(
+					CodeRed::TextureResolveInfo(textures.texture(msaaBuffer), 0),
+					CodeRed::TextureResolveInfo(textures.texture(backBuffer), 0)
+				);
+			});
+
+		mRenderGraph->addPass("UI",
+			{ CodeRed::RenderGraphAccess::write(backBuffer, CodeRed::ResourceLayout::RenderTarget, CodeRed::ResourceLayout::Present) },
+			[this](const auto& list, const CodeRed::RenderGraphTextures& textures)
+			{
+				list->beginRenderPass(mMSAAUIRenderPass, mFrameResources[mCurrentFrameIndex].get(FrameBufferKey));
+
+				mImGuiWindows->draw(list);
+
+				list->endRenderPass();
+			});
+	}
+	else {
+		mRenderGraph->addPass("Scene",
+			{ CodeRed::RenderGraphAccess::write(backBuffer, CodeRed::ResourceLayout::RenderTarget, CodeRed::ResourceLayout::Present) },
+			[this](const auto& list, const CodeRed::RenderGraphTextures& textures)
+			{
+				drawTriangle(list, mPipelineInfo, mFrameResources[mCurrentFrameIndex].get(FrameBufferKey), true);
+			});
+	}
+
+	mRenderGraph->compile();
 }
 
 void TriangleDemoApp::initialize()
@@ -153,6 +232,9 @@ void TriangleDemoApp::initialize()
 #endif
 #endif
 
+	//the pipeline cache is only valid for the adapter we created the device on
+	loadPipelineCache(adapters[0], mDevice);
+
 	initializeCommands();
 	initializeSwapChain();
 	initializeBuffers();
@@ -168,7 +250,13 @@ void TriangleDemoApp::initializeCommands()
 {
 	mCommandAllocator = mDevice->createCommandAllocator();
 	mCommandQueue = mDevice->createCommandQueue();
-	mCommandList = mDevice->createGraphicsCommandList(mCommandAllocator);
+
+	//every frame in flight has its own command allocator and command list
+	//we only wait for the frame that used the same slot before
+	mFramePacer = std::make_shared<CodeRed::FramePacer>(
+		mDevice,
+		std::make_shared<CodeRed::QueueFrameFence>(mDevice, mCommandQueue),
+		maxFrameResources);
 }
 
 void TriangleDemoApp::initializeSwapChain()
@@ -176,18 +264,26 @@ void TriangleDemoApp::initializeSwapChain()
 	//create the swap chain
 	//if we want to write the back buffer(to window)
 	//we need use the queue that create the swap chain to submit the draw commands
-	mSwapChain = mDevice->createSwapChain(
-		mCommandQueue,
-		{ width(), height(), handle() },
-		CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
-		maxFrameResources
-	);
+	//in headless mode, there is no window, so we render to offscreen textures
+	mPresentTargets = isHeadless() ?
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice,
+			width(), height(),
+			CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+			maxFrameResources) :
+		std::make_shared<CodeRed::PresentTargets>(
+			mDevice->createSwapChain(
+				mCommandQueue,
+				{ width(), height(), handle() },
+				CodeRed::PixelFormat::BlueGreenRedAlpha8BitUnknown,
+				maxFrameResources
+			));
 
 	for (size_t index = 0; index < maxFrameResources; index++) {
 		mFrameResources[index].set(
-			"FrameBuffer",
+			FrameBufferKey,
 			mDevice->createFrameBuffer(
-				{ mSwapChain->buffer(index)->reference() },
+				{ mPresentTargets->buffer(index)->reference() },
 				nullptr
 			)
 		);
@@ -210,7 +306,7 @@ void TriangleDemoApp::initializeBuffers()
 
 	for (auto& frameResource : mFrameResources) {
 		frameResource.set(
-			"VertexBuffer",
+			VertexBufferKey,
 			mDevice->createBuffer(
 				CodeRed::ResourceInfo::VertexBuffer(
 					sizeof(glm::vec3), 
@@ -246,26 +342,19 @@ void TriangleDemoApp::initializeSamplers()
 
 void TriangleDemoApp::initializeTextures()
 {
-	mMSAABuffer = mDevice->createTexture(
-		CodeRed::ResourceInfo::RenderTargetMultiSample(
-			mSwapChain->width(), mSwapChain->height(),
-			mSwapChain->format(),
-			CodeRed::MultiSample::Count4,
-			CodeRed::ClearValue(1, 1, 1, 1)
-		)
-	);
-
-	mMSAAFrameBuffer = mDevice->createFrameBuffer(
-		{
-			mMSAABuffer->reference()
-		}
-	);
+	//the msaa buffer is a transient texture of render graph
+	//it is created when the graph executes the msaa pass first time
+	mRenderGraph = std::make_shared<CodeRed::RenderGraph>(mDevice);
 }
 
 void TriangleDemoApp::initializePipeline()
 {
 	mPipelineInfo = std::make_shared<CodeRed::PipelineInfo>(mDevice);
 	mMSAAPipelineInfo = std::make_shared<CodeRed::PipelineInfo>(mDevice);
+
+	//if the pipelines are replaced, the old ones are released after the frames used them
+	mPipelineInfo->setFramePacer(mFramePacer);
+	mMSAAPipelineInfo->setFramePacer(mFramePacer);
 	
 	mPipelineFactory = mDevice->createPipelineFactory();
 
@@ -343,7 +432,7 @@ void TriangleDemoApp::initializePipeline()
 
 	mPipelineInfo->setRenderPass(
 		mDevice->createRenderPass(
-			{ CodeRed::Attachment::RenderTarget(mSwapChain->format(),
+			{ CodeRed::Attachment::RenderTarget(mPresentTargets->format(),
 				CodeRed::ResourceLayout::RenderTarget,
 				CodeRed::ResourceLayout::Present) }
 		)
@@ -353,8 +442,8 @@ void TriangleDemoApp::initializePipeline()
 		mDevice->createRenderPass(
 			{
 				CodeRed::Attachment::RenderTargetMultiSample(
-					mMSAABuffer->format(), 
-					mMSAABuffer->sample(),
+					mPresentTargets->format(),
+					CodeRed::MultiSample::Count4,
 					CodeRed::ResourceLayout::RenderTarget,
 					CodeRed::ResourceLayout::GeneralRead)
 			}
@@ -363,7 +452,7 @@ void TriangleDemoApp::initializePipeline()
 
 	mMSAAUIRenderPass = mDevice->createRenderPass(
 		{
-			CodeRed::Attachment::RenderTarget(mSwapChain->format(),
+			CodeRed::Attachment::RenderTarget(mPresentTargets->format(),
 			CodeRed::ResourceLayout::RenderTarget,
 			CodeRed::ResourceLayout::Present,
 			CodeRed::AttachmentLoad::Load,
@@ -373,8 +462,10 @@ void TriangleDemoApp::initializePipeline()
 
 	mMSAAPipelineInfo->renderPass()->setClear(CodeRed::ClearValue(1, 1, 1, 1));
 	
+	//the msaa pipeline is not used before we enable msaa
+	//so we create it on worker thread and do not wait it
 	mPipelineInfo->updateState();
-	mMSAAPipelineInfo->updateState();
+	mMSAAPipelineInfo->updateStateAsync();
 }
 
 void TriangleDemoApp::initializeImGuiWindows()
@@ -399,6 +490,7 @@ void TriangleDemoApp::initializeImGuiWindows()
 
 	//add the ui component to windows
 	mImGuiWindows->add("Tool", "Program State", mUIComponent->programStateView());
+	mImGuiWindows->add("Tool", "Profiler", CodeRed::ProfilerView::create());
 	mImGuiWindows->add("Tool", "Triangle Property", mUIComponent->triangleView());
 }
 
@@ -412,7 +504,7 @@ void TriangleDemoApp::initializeDescriptorHeaps()
 		descriptorHeap->bindBuffer(mViewBuffer, 0);
 
 		frameResource.set(
-			"DescriptorHeap",
+			DescriptorHeapKey,
 			descriptorHeap
 		);
 	}
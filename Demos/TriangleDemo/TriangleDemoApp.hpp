@@ -2,11 +2,15 @@
 
 #include <Shaders/ShaderCompiler.hpp>
 #include <Resources/FrameResources.hpp>
+#include <Resources/FramePacer.hpp>
+#include <Resources/PresentTargets.hpp>
 #include <Resources/ResourceHelper.hpp>
 #include <Pipelines/PipelineInfo.hpp>
+#include <Graphs/RenderGraph.hpp>
 #include <DemoApp.hpp>
 
 #include <Extensions/ImGui/ImGuiWindows.hpp>
+#include <Profiling/ProfilerView.hpp>
 
 //#define __DIRECTX12__MODE__
 #define __VULKAN__MODE__
@@ -39,9 +43,18 @@ public:
 
 	~TriangleDemoApp();
 private:
+	void waitFrame() override;
 	void update(float delta) override;
 	void render(float delta) override;
 
+	void drawTriangle(
+		const std::shared_ptr<CodeRed::GpuGraphicsCommandList>& commandList,
+		const std::shared_ptr<CodeRed::PipelineInfo>& pipelineInfo,
+		const std::shared_ptr<CodeRed::GpuFrameBuffer>& frameBuffer,
+		const bool drawUI);
+
+	void buildRenderGraph(const bool enableMSAA);
+
 	void initialize();
 	
 	void initializeCommands();
@@ -69,16 +82,32 @@ private:
 	std::shared_ptr<TriangleDemoUIComponent> mUIComponent;
 	
 	std::shared_ptr<CodeRed::GpuLogicalDevice> mDevice;
-	std::shared_ptr<CodeRed::GpuSwapChain> mSwapChain;
+	std::shared_ptr<CodeRed::PresentTargets> mPresentTargets;
 
+	//the command allocator is only used to upload resources when we initialize
+	//the frames use the command allocators and command lists of frame pacer
 	std::shared_ptr<CodeRed::GpuCommandAllocator> mCommandAllocator;
-	std::shared_ptr<CodeRed::GpuGraphicsCommandList> mCommandList;
 	std::shared_ptr<CodeRed::GpuCommandQueue> mCommandQueue;
 
-	std::shared_ptr<CodeRed::GpuFrameBuffer> mMSAAFrameBuffer;
+	std::shared_ptr<CodeRed::FramePacer> mFramePacer;
+
 	std::shared_ptr<CodeRed::GpuRenderPass> mMSAAUIRenderPass;
 	std::shared_ptr<CodeRed::PipelineInfo> mMSAAPipelineInfo;
+
+	//the msaa buffer is owned by render graph, we only keep the texture
+	//that the msaa frame buffer is created with
+	std::shared_ptr<CodeRed::GpuFrameBuffer> mMSAAFrameBuffer;
 	std::shared_ptr<CodeRed::GpuTexture> mMSAABuffer;
+
+	std::shared_ptr<CodeRed::RenderGraph> mRenderGraph;
+
+	//the msaa setting that the render graph is built with, nullopt if it is not built
+	std::optional<bool> mRenderGraphMSAA;
+
+	//the resource of back buffer in render graph, we import the back buffer of current frame to it
+	size_t mBackBuffer = 0;
+
+	std::vector<CodeRed::Value32Bit> mColorConstants;
 	
 	std::vector<CodeRed::FrameResources> mFrameResources =
 		std::vector<CodeRed::FrameResources>(maxFrameResources);
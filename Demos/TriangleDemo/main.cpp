@@ -1,8 +1,15 @@
 #include "TriangleDemoApp.hpp"
 
-int main() {
+int main(int argc, char** argv) {
+	//run without window with "--headless [--frames count] [--timestep seconds] [--trace fileName]"
+	//benchmark with "--benchmark fileName [--baseline fileName] [--tolerance value]", it fails if it regresses
+	//check the steady state with "--max-allocations 0 [--warmup frames]", it fails if a frame allocates
+	Demo::DemoApp::setHeadless(Demo::HeadlessInfo::fromCommandLine(argc, argv));
+
 	auto app = TriangleDemoApp("TriangleDemoApp", 1280, 720);
 	
 	app.show();
 	app.runLoop();
+
+	return app.exitCode();
 }
\ No newline at end of file